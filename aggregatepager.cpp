@@ -0,0 +1,62 @@
+#include "aggregatepager.hpp"
+#include "aggregates.hpp"
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPushButton>
+
+AggregatePager::AggregatePager(QWidget* parent) : QWidget(parent)
+{
+    previousButton = new QPushButton("Previous", this);
+    nextButton = new QPushButton("Next", this);
+    position = new QLabel(this);
+    position->setAlignment(Qt::AlignCenter);
+    connect(previousButton, &QPushButton::clicked, this, [this]() { step(-1); });
+    connect(nextButton, &QPushButton::clicked, this, [this]() { step(1); });
+
+    QHBoxLayout* layout = new QHBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->addWidget(previousButton);
+    layout->addWidget(position, 1);
+    layout->addWidget(nextButton);
+
+    reset();
+}
+
+void AggregatePager::reset()
+{
+    page = 0;
+    total = 0;
+    update();
+}
+
+void AggregatePager::setTotal(qint64 rows)
+{
+    total = rows;
+    update();
+}
+
+qint64 AggregatePager::firstRow() const
+{
+    return qint64(page) * AggregationIndex::PAGE_ROWS;
+}
+
+void AggregatePager::step(int pages)
+{
+    const qint64 first = firstRow() + qint64(pages) * AggregationIndex::PAGE_ROWS;
+    if (first < 0 || first >= total) {
+        return;
+    }
+    page += pages;
+    update();
+    emit pageChanged();
+}
+
+void AggregatePager::update()
+{
+    setVisible(total > AggregationIndex::PAGE_ROWS);
+    const qint64 first = firstRow();
+    const qint64 last = qMin(first + AggregationIndex::PAGE_ROWS, total);
+    position->setText(QString("Rows %1 to %2 of %3").arg(total > 0 ? first + 1 : 0).arg(last).arg(total));
+    previousButton->setEnabled(page > 0);
+    nextButton->setEnabled(last < total);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <QWidget>
+
+class QLabel;
+class QPushButton;
+
+// Previous and next buttons over the rows an aggregation-mode page shows,
+// AggregationIndex::PAGE_ROWS at a time, so a page's model stays bounded
+// however many buckets match. Hidden while everything fits on one page.
+class AggregatePager : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit AggregatePager(QWidget* parent = nullptr);
+
+    // Go back to the first page and hide until setTotal() says there is more than one
+    void reset();
+
+    // Rows matching the page's filter, counted while the current page was filled
+    void setTotal(qint64 rows);
+
+    // First row of the current page, among the matching rows in bucket order
+    qint64 firstRow() const;
+
+signals:
+    void pageChanged();
+
+private:
+    void step(int pages);
+    void update();
+
+    QPushButton* previousButton;
+    QPushButton* nextButton;
+    QLabel* position;
+    qint64 total = 0;
+    int page = 0;
+};
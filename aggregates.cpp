@@ -0,0 +1,370 @@
+#include "aggregates.hpp"
+#include "categorymatcher.hpp"
+#include "csvscan.hpp"
+#include "decompression.hpp"
+#include "dataset.hpp"
+#include "tracing.hpp"
+#include <QFile>
+#include <QFileInfo>
+#include <QDebug>
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
+
+namespace {
+
+// Share of the table that may be filled before new buckets are refused
+const quint32 MAX_USED = AggregationIndex::MAX_BUCKETS / 10 * 9;
+
+quint32 bucketHash(const AggregateKey& key)
+{
+    quint64 h = key.site * 0x9E3779B97F4A7C15ull;
+    h ^= key.determinand * 0xC2B2AE3D27D4EB4Full + (h << 6) + (h >> 2);
+    h ^= key.month * 0x165667B19E3779F9ull;
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    return static_cast<quint32>(h);
+}
+
+bool isDigit(char ch)
+{
+    return ch >= '0' && ch <= '9';
+}
+
+// Month bucket for a "yyyy-MM-ddThh:mm:ss" timestamp
+quint32 monthKey(QByteArrayView date)
+{
+    if (date.size() < 7 || date[4] != '-' || !isDigit(date[5]) || !isDigit(date[6])) {
+        return 0;
+    }
+    int year = 0;
+    for (int i = 0; i < 4; ++i) {
+        if (!isDigit(date[i])) {
+            return 0;
+        }
+        year = year * 10 + (date[i] - '0');
+    }
+    int month = (date[5] - '0') * 10 + (date[6] - '0');
+    if (month < 1 || month > 12) {
+        return 0;
+    }
+    return static_cast<quint32>(year * 12 + month);
+}
+
+// Look up or assign the id of an interned value
+quint32 intern(QHash<QByteArray, quint32>& ids, const QByteArray& key, bool* added)
+{
+    auto it = ids.constFind(key);
+    if (it != ids.constEnd()) {
+        *added = false;
+        return it.value();
+    }
+    const quint32 id = static_cast<quint32>(ids.size());
+    ids.insert(QByteArray(key.constData(), key.size()), id); // Deep copy of the mapped bytes
+    *added = true;
+    return id;
+}
+
+}
+
+AggregationIndex::~AggregationIndex()
+{
+    clear();
+}
+
+bool AggregationIndex::build(const QString& filePath)
+{
+    TraceScope trace("AggregationIndex::build");
+
+    clear();
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Unable to open file:" << filePath;
+        return false;
+    }
+
+    // Untouched pages of a calloc stay unmapped, but buckets hash across the
+    // whole table, so only files of a few thousand buckets leave much of it
+    // untouched; the MAX_BUCKETS budget assumes all of it is resident
+    table = static_cast<Slot*>(std::calloc(MAX_BUCKETS, sizeof(Slot)));
+    if (!table) {
+        qWarning() << "Unable to allocate aggregation table";
+        return false;
+    }
+    path = filePath;
+    if (compressionOf(filePath) != Compression::None) {
+        compressedSize = file.size();
+    }
+
+    if (!fold(file, false)) {
+        qWarning() << "Unable to read file:" << filePath;
+        clear();
+        return false;
+    }
+
+    if (dropped > 0) {
+        qWarning() << "Aggregation table full;" << dropped << "rows were not summarised";
+    }
+    return true;
+}
+
+qint64 AggregationIndex::extend()
+{
+    TraceScope trace("AggregationIndex::extend");
+
+    // Compressed files cannot be resumed part way, so any change means a rebuild
+    if (compressedSize >= 0) {
+        return QFileInfo(path).size() == compressedSize ? 0 : -1;
+    }
+
+    QFile file(path);
+    if (!table || !file.open(QIODevice::ReadOnly) || file.size() < parsedEnd) {
+        return -1;
+    }
+
+    const qint64 before = rows;
+    const qint64 droppedBefore = dropped;
+    if (!fold(file, true)) {
+        qWarning() << "Unable to map file:" << path;
+        return -1;
+    }
+    if (dropped > droppedBefore) {
+        qWarning() << "Aggregation table full;" << dropped - droppedBefore << "appended rows were not summarised";
+    }
+    return rows - before;
+}
+
+bool AggregationIndex::fold(QFile& file, bool wholeLines)
+{
+    const QList<PollutantCategory> categories = allCategories();
+    // Site, month, determinand, definition, result, unit and compliance flag
+    const CsvProjection columns = CsvProjection::of({3, 4, 5, 6, 9, 11, 13});
+    CsvField fields[CSV_MAX_FIELDS];
+    bool isHeader = parsedEnd == 0;
+
+    auto visit = [&](QByteArrayView line, qint64 offset) {
+        if (isHeader) {
+            isHeader = false;
+            return;
+        }
+        rows++;
+
+        // Rows shorter than this are not shown by any page
+        const int columnCount = splitCsvLine(line, fields, CSV_MAX_FIELDS, columns);
+        if (columnCount < 12) {
+            return;
+        }
+
+        bool added = false;
+        const QByteArray siteBytes = fields[3].key();
+        const quint32 site = intern(siteIds, siteBytes, &added);
+        if (added) {
+            siteNames.append(QString::fromUtf8(siteBytes));
+        }
+
+        // A determinand here is a label with one definition, which decides
+        // its category membership, so that is worked out once per pair
+        const QByteArray labelBytes = fields[5].key();
+        determinandKey.resize(0);
+        determinandKey.append(labelBytes).append('\x1f').append(fields[6].key());
+        const quint32 determinand = intern(determinandIds, determinandKey, &added);
+        if (added) {
+            Determinand info;
+            info.label = QString::fromUtf8(labelBytes);
+            info.definition = fields[6].text();
+            info.unit = fields[11].text();
+            info.categories = CategoryMatcher::standard().match(labelBytes, fields[6].key());
+            determinands.append(info);
+        }
+
+        bool numeric = false;
+        double value = 0.0;
+        bool classified = false;
+        bool compliant = false;
+        bool exceedance = false;
+
+        Determinand& info = determinands[determinand];
+        if (const quint8 mask = rowCategories(info.categories, columnCount)) {
+            WaterRecord record;
+            record.determinand = info.label;
+            record.definition = info.definition;
+            record.result = fields[9].text();
+            record.unit = fields[11].text();
+            record.columnCount = columnCount;
+
+            for (PollutantCategory category : categories) {
+                if (!(mask & categoryBit(category))) {
+                    continue;
+                }
+                Classification classification = classifyRecord(category, record);
+                numeric = classification.numeric;
+                value = classification.value;
+                info.unit = classification.unit;
+                compliant = classification.status == "Compliant";
+                exceedance = isExceedance(classification.status);
+                classified = true;
+                break;
+            }
+        }
+
+        if (!classified) {
+            QByteArrayView result = fields[9].view();
+            if (result.startsWith('<')) {
+                result = result.sliced(1);
+            }
+            value = QByteArray::fromRawData(result.data(), result.size()).toDouble(&numeric);
+        }
+
+        const bool flagged = columnCount >= 14;
+        const bool flaggedTrue = flagged && fields[13].key().compare("true", Qt::CaseInsensitive) == 0;
+
+        // Totals are taken before the bucket, which a full table may refuse
+        if (classified) {
+            for (PollutantCategory category : categories) {
+                if (info.categories & categoryBit(category)) {
+                    categoryClassified[static_cast<int>(category)]++;
+                    categoryCompliant[static_cast<int>(category)] += compliant ? 1 : 0;
+                }
+            }
+        }
+        if (flagged) {
+            flaggedSamples++;
+            flaggedCompliant += flaggedTrue ? 1 : 0;
+        }
+
+        MonthlyAggregate* aggregate = bucket({site, determinand, monthKey(fields[4].view())});
+        if (!aggregate) {
+            dropped++;
+            return;
+        }
+        if (aggregate->count == 0) {
+            aggregate->sampleOffset = offset;
+        }
+        aggregate->count++;
+
+        if (classified) {
+            aggregate->classified++;
+            if (compliant) {
+                aggregate->compliant++;
+            } else if (exceedance) {
+                aggregate->exceedances++;
+            }
+        }
+
+        if (numeric) {
+            if (aggregate->valueCount == 0) {
+                aggregate->min = value;
+                aggregate->max = value;
+            } else {
+                aggregate->min = qMin(aggregate->min, value);
+                aggregate->max = qMax(aggregate->max, value);
+            }
+            aggregate->sum += value;
+            aggregate->valueCount++;
+        }
+
+        if (flagged) {
+            aggregate->flaggedSamples++;
+            aggregate->flaggedCompliant += flaggedTrue ? 1 : 0;
+        }
+    };
+
+    if (compressedSize >= 0) {
+        return forEachDecompressedLine(path, visit, &checkpoints);
+    }
+    return forEachMappedLine(file, parsedEnd, wholeLines, &parsedEnd, visit);
+}
+
+void AggregationIndex::clear()
+{
+    std::free(table);
+    table = nullptr;
+    used = 0;
+    usedSlots.clear();
+    rows = 0;
+    dropped = 0;
+    parsedEnd = 0;
+    compressedSize = -1;
+    checkpoints.clear();
+    std::fill(std::begin(categoryClassified), std::end(categoryClassified), 0);
+    std::fill(std::begin(categoryCompliant), std::end(categoryCompliant), 0);
+    flaggedSamples = 0;
+    flaggedCompliant = 0;
+    path.clear();
+    siteIds.clear();
+    siteNames.clear();
+    determinandIds.clear();
+    determinands.clear();
+}
+
+bool AggregationIndex::inCategory(quint32 determinand, PollutantCategory category) const
+{
+    return determinands.value(determinand).categories & (1u << static_cast<int>(category));
+}
+
+QString AggregationIndex::monthLabel(quint32 month)
+{
+    if (month == 0) {
+        return "Unknown";
+    }
+    return QString("%1-%2").arg((month - 1) / 12).arg((month - 1) % 12 + 1, 2, 10, QChar('0'));
+}
+
+void AggregationIndex::categoryCompliance(PollutantCategory category, qint64* compliant, qint64* total) const
+{
+    *compliant = categoryCompliant[static_cast<int>(category)];
+    *total = categoryClassified[static_cast<int>(category)];
+}
+
+void AggregationIndex::flagCompliance(qint64* compliant, qint64* total) const
+{
+    *compliant = flaggedCompliant;
+    *total = flaggedSamples;
+}
+
+QStringList AggregationIndex::rawRow(qint64 offset) const
+{
+    if (compressedSize >= 0) {
+        QByteArray line;
+        if (!readDecompressedLine(path, offset, line, checkpoints)) {
+            qWarning() << "Unable to read row at offset" << offset << "from" << path;
+            return QStringList();
+        }
+        return splitCsvColumns(line);
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly) || !file.seek(offset)) {
+        qWarning() << "Unable to read row at offset" << offset << "from" << path;
+        return QStringList();
+    }
+
+    QByteArray line = file.readLine();
+    while (line.endsWith('\n') || line.endsWith('\r')) {
+        line.chop(1);
+    }
+    return splitCsvColumns(line);
+}
+
+MonthlyAggregate* AggregationIndex::bucket(const AggregateKey& key)
+{
+    const quint32 mask = MAX_BUCKETS - 1;
+    for (quint32 i = bucketHash(key) & mask;; i = (i + 1) & mask) {
+        Slot& slot = table[i];
+        if (slot.value.count == 0) {
+            if (used >= MAX_USED) {
+                return nullptr;
+            }
+            slot.key = key;
+            used++;
+            usedSlots.append(i);
+            return &slot.value;
+        }
+        if (slot.key.site == key.site && slot.key.determinand == key.determinand
+            && slot.key.month == key.month) {
+            return &slot.value;
+        }
+    }
+}
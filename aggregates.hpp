@@ -0,0 +1,150 @@
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "categories.hpp"
+#include "decompression.hpp"
+#include "rowsort.hpp"
+
+// Identifies one (sampling point, determinand, month) bucket
+struct AggregateKey
+{
+    quint32 site = 0;
+    quint32 determinand = 0;
+    quint32 month = 0;  // year * 12 + month, 0 when the date is unreadable
+};
+
+// Summary of every row that fell into one bucket
+struct MonthlyAggregate
+{
+    quint32 count = 0;            // Rows seen; 0 marks an empty table slot
+    quint32 valueCount = 0;       // Rows with a numeric result
+    quint32 classified = 0;       // Rows classified by a category's rule
+    quint32 compliant = 0;        // ...of which compliant
+    quint32 exceedances = 0;      // ...of which over the category's threshold
+    quint32 flaggedSamples = 0;   // Rows carrying a compliance sample flag
+    quint32 flaggedCompliant = 0; // ...of which flagged compliant
+    double min = 0.0;
+    double max = 0.0;
+    double sum = 0.0;
+    qint64 sampleOffset = -1;     // Byte offset of the first row in the bucket
+
+    double mean() const { return valueCount > 0 ? sum / valueCount : 0.0; }
+
+    // Status shown by the category pages: any exceedance marks the month
+    QString categoryStatus() const
+    {
+        return exceedances > 0 ? "Non-Compliant" : compliant > 0 ? "Compliant" : "Unknown";
+    }
+};
+
+// Aggregation-only view of a CSV too large to materialise. The file is read
+// in one pass over memory-mapped windows, or decompressed as a stream for
+// .gz and .zst files, and folded into a fixed-size hash table, so peak
+// memory does not depend on the input size. Raw rows are
+// fetched back from the file by byte offset when a view needs them.
+class AggregationIndex
+{
+public:
+    // Upper bound on distinct buckets; rows that would need more are counted
+    // in droppedRows() instead of growing the table. The dashboard totals
+    // still include them.
+    //
+    // Sized for a 500 MB peak. Buckets hash across the whole table, so any
+    // national file makes all of it resident: 2M slots of 80 bytes are
+    // 160 MB, plus 8 MB of used-slot list. Pages show PAGE_ROWS rows at a
+    // time; a row costs about 0.8 KB in a RowTableModel with its chart row
+    // and dropdown entry, and about 1.5 KB as QStandardItems, so the POPs,
+    // Fluorinated and Compliance pages together hold at most about 80 MB.
+    // That leaves over 200 MB for the site and determinand dictionaries,
+    // mapped file windows and Qt itself.
+    static const quint32 MAX_BUCKETS = 1u << 21;
+
+    // Most rows an aggregation-mode page shows at once; see AggregatePager
+    static const int PAGE_ROWS = 20000;
+
+    AggregationIndex() = default;
+    ~AggregationIndex();
+    AggregationIndex(const AggregationIndex&) = delete;
+    AggregationIndex& operator=(const AggregationIndex&) = delete;
+
+    bool build(const QString& filePath);
+    void clear();
+
+    // Fold whole lines appended to the file since the last build or extend
+    // into the existing buckets. Returns the number of rows read, or -1 if
+    // the file shrank and has to be built again.
+    qint64 extend();
+
+    const QString& filePath() const { return path; }
+    qint64 rowCount() const { return rows; }
+    qint64 droppedRows() const { return dropped; }
+    quint32 bucketCount() const { return used; }
+
+    QString siteName(quint32 site) const { return siteNames.value(site); }
+    // Text-order rank of each site id, worked out on each call
+    QVector<quint32> siteRanks() const { return textRanks(siteNames); }
+    QString determinandLabel(quint32 determinand) const { return determinands.value(determinand).label; }
+    QString determinandDefinition(quint32 determinand) const { return determinands.value(determinand).definition; }
+    QString determinandUnit(quint32 determinand) const { return determinands.value(determinand).unit; }
+    bool inCategory(quint32 determinand, PollutantCategory category) const;
+    static QString monthLabel(quint32 month);
+
+    // Visit every non-empty bucket as (key, aggregate), in the order they were filled
+    template <typename Visit>
+    void forEachAggregate(Visit&& visit) const
+    {
+        for (quint32 slot : usedSlots) {
+            visit(table[slot].key, table[slot].value);
+        }
+    }
+
+    // Totals behind the dashboard cards
+    void categoryCompliance(PollutantCategory category, qint64* compliant, qint64* total) const;
+    void flagCompliance(qint64* compliant, qint64* total) const;
+
+    // Re-read the original row (or the header at offset 0) from the file
+    QStringList rawRow(qint64 offset) const;
+
+private:
+    struct Slot {
+        AggregateKey key;
+        MonthlyAggregate value;
+    };
+
+    struct Determinand {
+        QString label;
+        QString definition;
+        QString unit;        // Display unit after any category conversion
+        quint8 categories = 0; // Bit per PollutantCategory
+    };
+
+    bool fold(QFile& file, bool wholeLines);
+    MonthlyAggregate* bucket(const AggregateKey& key);
+
+    QString path;
+    Slot* table = nullptr;  // MAX_BUCKETS slots, zero-filled lazily by the OS
+    quint32 used = 0;
+    QVector<quint32> usedSlots; // Index of each filled slot, so visits skip the empty ones
+    qint64 rows = 0;
+    qint64 dropped = 0;
+    qint64 parsedEnd = 0;   // Offset just past the last line read
+    qint64 compressedSize = -1; // Size of a compressed file, read as a stream; -1 otherwise
+    DecompressionCheckpoints checkpoints; // Where reads of a compressed file's raw rows resume
+
+    // Dashboard totals, counted per row so dropped rows are not missed
+    qint64 categoryClassified[POLLUTANT_CATEGORY_COUNT] = {};
+    qint64 categoryCompliant[POLLUTANT_CATEGORY_COUNT] = {};
+    qint64 flaggedSamples = 0;
+    qint64 flaggedCompliant = 0;
+
+    QHash<QByteArray, quint32> siteIds;
+    QStringList siteNames;
+    QHash<QByteArray, quint32> determinandIds; // Label, unit separator and definition
+    QByteArray determinandKey;                 // Lookup buffer for determinandIds
+    QVector<Determinand> determinands;
+};
@@ -0,0 +1,110 @@
+#include "allocations.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef WATERTOOL_TRACK_ALLOCATIONS
+
+thread_local quint64 threadAllocationCalls = 0;
+thread_local quint64 threadAllocationBytes = 0;
+
+namespace {
+
+std::atomic<quint64> processAllocationCalls{0};
+std::atomic<quint64> processAllocationBytes{0};
+
+inline void countAllocation(std::size_t size)
+{
+    threadAllocationCalls++;
+    threadAllocationBytes += size;
+    processAllocationCalls.fetch_add(1, std::memory_order_relaxed);
+    processAllocationBytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+}
+
+#if defined(__GLIBC__)
+
+// On glibc the C allocator itself is interposed. That covers operator new,
+// which allocates through malloc, and Qt's QString, QByteArray and QList
+// buffers, which never go through operator new at all.
+extern "C" {
+
+void* __libc_malloc(std::size_t size);
+void* __libc_calloc(std::size_t count, std::size_t size);
+void* __libc_realloc(void* pointer, std::size_t size);
+
+void* malloc(std::size_t size)
+{
+    countAllocation(size);
+    return __libc_malloc(size);
+}
+
+void* calloc(std::size_t count, std::size_t size)
+{
+    countAllocation(count * size);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* pointer, std::size_t size)
+{
+    countAllocation(size);
+    return __libc_realloc(pointer, size);
+}
+
+}
+
+#else
+
+// Elsewhere only C++ allocations are counted; Qt's container buffers,
+// allocated with malloc, are missed
+void* operator new(std::size_t size)
+{
+    countAllocation(size);
+    if (void* pointer = std::malloc(size > 0 ? size : 1)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+#endif
+
+AllocationCount processAllocations()
+{
+    return {processAllocationCalls.load(std::memory_order_relaxed),
+            processAllocationBytes.load(std::memory_order_relaxed)};
+}
+
+#else
+
+AllocationCount processAllocations()
+{
+    return {};
+}
+
+#endif
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <QtGlobal>
+
+// Heap allocation counters for instrumented builds. Configure with
+// -DWATERTOOL_ALLOCATION_TRACKING=ON to define WATERTOOL_TRACK_ALLOCATIONS,
+// which replaces the global allocator with one that counts calls and bytes
+// per thread and for the whole process. Otherwise every count is zero and
+// nothing is replaced.
+struct AllocationCount
+{
+    quint64 allocations = 0;
+    quint64 bytes = 0;
+};
+
+#ifdef WATERTOOL_TRACK_ALLOCATIONS
+
+// Written only by their own thread, so reads on that thread need no atomics
+extern thread_local quint64 threadAllocationCalls;
+extern thread_local quint64 threadAllocationBytes;
+
+inline AllocationCount threadAllocations() { return {threadAllocationCalls, threadAllocationBytes}; }
+constexpr bool allocationTrackingEnabled() { return true; }
+
+#else
+
+inline AllocationCount threadAllocations() { return {}; }
+constexpr bool allocationTrackingEnabled() { return false; }
+
+#endif
+
+// Allocations by every thread since start-up
+AllocationCount processAllocations();
@@ -0,0 +1,390 @@
+#include <benchmark/benchmark.h>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRandomGenerator>
+#include <memory>
+#include "allocations.hpp"
+#include "categories.hpp"
+#include "csvscan.hpp"
+#include "dataset.hpp"
+#include "osgb.hpp"
+#include "synthetic.hpp"
+#include "taskscheduler.hpp"
+#include "tracing.hpp"
+
+// Data pipeline benchmarks on synthetic extracts of 10k to 10M rows.
+// Generated files are cached in $WATERTOOL_BENCH_DATA (or the temp
+// directory) and always use the same seed, so runs of
+//     watertool_bench --benchmark_out=results.json --benchmark_out_format=json
+// on different commits measure the same input.
+
+namespace {
+
+const quint64 SEED = 2024;
+
+QString dataPath(qint64 rows)
+{
+    QString directory = qEnvironmentVariable("WATERTOOL_BENCH_DATA");
+    if (directory.isEmpty()) {
+        directory = QDir::temp().filePath("watertool_bench");
+    }
+    QDir().mkpath(directory);
+
+    const QString name = QString("synthetic-v%1-%2-seed%3.csv").arg(SyntheticCsvGenerator::VERSION).arg(rows).arg(SEED);
+    const QString path = QDir(directory).filePath(name);
+    if (!QFileInfo::exists(path)) {
+        SyntheticOptions options;
+        options.seed = SEED;
+        writeSyntheticCsv(path, rows, options);
+    }
+    return path;
+}
+
+TaskScheduler& scheduler()
+{
+    static TaskScheduler pool;
+    return pool;
+}
+
+// The most recently loaded extract, with its indexes built. Only one size
+// is kept so the 10M row run fits in memory.
+struct LoadedData
+{
+    qint64 rows = -1;
+    WaterDataset dataset;
+    TrendCube trends;
+    QVector<SamplingPoint> sites;
+    SearchIndex search;
+    SiteDateIndex siteDates;
+};
+
+const LoadedData& loaded(qint64 rows)
+{
+    static std::unique_ptr<LoadedData> data;
+    if (!data || data->rows != rows) {
+        data.reset();
+        data = std::make_unique<LoadedData>();
+        data->rows = rows;
+        data->dataset.load(dataPath(rows), &scheduler());
+        const WaterDataset::IndexInput input = data->dataset.indexInput();
+        WaterDataset::buildSummaries(input, data->trends, data->sites);
+        WaterDataset::buildSearchIndex(input, data->search);
+        WaterDataset::buildSiteDateIndex(input, data->siteDates);
+    }
+    return *data;
+}
+
+// Allocations per item by every thread since before, as counters in the
+// benchmark output; only reported in allocation tracking builds
+void reportAllocations(benchmark::State& state, const AllocationCount& before, qint64 itemsPerIteration)
+{
+    if (!allocationTrackingEnabled() || state.iterations() == 0 || itemsPerIteration == 0) {
+        return;
+    }
+    const AllocationCount after = processAllocations();
+    const double items = double(state.iterations()) * itemsPerIteration;
+    state.counters["allocs_per_item"] = (after.allocations - before.allocations) / items;
+    state.counters["alloc_bytes_per_item"] = (after.bytes - before.bytes) / items;
+}
+
+void sizes(benchmark::internal::Benchmark* benchmark)
+{
+    for (qint64 rows : {10000LL, 100000LL, 1000000LL, 10000000LL}) {
+        benchmark->Arg(rows);
+    }
+    benchmark->Unit(benchmark::kMillisecond);
+}
+
+void BM_Tokenize(benchmark::State& state)
+{
+    QFile input(dataPath(state.range(0)));
+    if (!input.open(QIODevice::ReadOnly)) {
+        state.SkipWithError("Unable to open data");
+        return;
+    }
+
+    CsvField fields[CSV_MAX_FIELDS];
+    const AllocationCount before = processAllocations();
+    for (auto _ : state) {
+        qint64 fieldCount = 0;
+        forEachMappedLine(input, 0, [&](QByteArrayView line, qint64) {
+            fieldCount += splitCsvLine(line, fields, CSV_MAX_FIELDS);
+        });
+        benchmark::DoNotOptimize(fieldCount);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    reportAllocations(state, before, state.range(0));
+    state.SetBytesProcessed(state.iterations() * input.size());
+}
+BENCHMARK(BM_Tokenize)->Apply(sizes);
+
+void BM_Ingest(benchmark::State& state)
+{
+    const QString path = dataPath(state.range(0));
+    const AllocationCount before = processAllocations();
+    for (auto _ : state) {
+        WaterDataset dataset;
+        if (!dataset.load(path, &scheduler())) {
+            state.SkipWithError("Unable to load data");
+            return;
+        }
+        benchmark::DoNotOptimize(dataset.records().size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    reportAllocations(state, before, state.range(0));
+    state.SetBytesProcessed(state.iterations() * QFileInfo(path).size());
+}
+BENCHMARK(BM_Ingest)->Apply(sizes);
+
+void BM_Classify(benchmark::State& state)
+{
+    const WaterDataset& dataset = loaded(state.range(0)).dataset;
+    const QVector<WaterRecord>& records = dataset.records();
+    const QList<PollutantCategory> categories = allCategories();
+
+    const AllocationCount before = processAllocations();
+    for (auto _ : state) {
+        qint64 exceedances = 0;
+        for (const WaterRecord& record : records) {
+            const quint8 mask = rowCategories(record.categories, record.columnCount);
+            for (PollutantCategory category : categories) {
+                if ((mask & categoryBit(category))
+                    && isExceedance(classifyRecord(category, record).status)) {
+                    exceedances++;
+                }
+            }
+            if (complianceFlagStatus(record) == "Non-Compliant") {
+                exceedances++;
+            }
+        }
+        benchmark::DoNotOptimize(exceedances);
+    }
+    state.SetItemsProcessed(state.iterations() * records.size());
+    reportAllocations(state, before, records.size());
+}
+BENCHMARK(BM_Classify)->Apply(sizes);
+
+// Case-insensitive substring search over the columns the pages' search boxes cover
+void BM_FilterSearch(benchmark::State& state)
+{
+    const QVector<WaterRecord>& records = loaded(state.range(0)).dataset.records();
+    const QString text = "knostrop";
+
+    const AllocationCount before = processAllocations();
+    for (auto _ : state) {
+        qint64 matches = 0;
+        for (const WaterRecord& record : records) {
+            if (record.samplingPoint.contains(text, Qt::CaseInsensitive)
+                || record.date.contains(text, Qt::CaseInsensitive)
+                || record.determinand.contains(text, Qt::CaseInsensitive)
+                || record.result.contains(text, Qt::CaseInsensitive)
+                || record.unit.contains(text, Qt::CaseInsensitive)) {
+                matches++;
+            }
+        }
+        benchmark::DoNotOptimize(matches);
+    }
+    state.SetItemsProcessed(state.iterations() * records.size());
+    reportAllocations(state, before, records.size());
+}
+BENCHMARK(BM_FilterSearch)->Apply(sizes);
+
+// The same search answered by the search index, for the columns it covers
+void BM_IndexedSearch(benchmark::State& state)
+{
+    const LoadedData& data = loaded(state.range(0));
+    const QString text = "knostrop";
+    const QList<SearchIndex::Field> fields = {SearchIndex::Field::SamplingPoint, SearchIndex::Field::Date,
+                                              SearchIndex::Field::Determinand};
+
+    const AllocationCount before = processAllocations();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(data.search.matches(text, fields).count());
+    }
+    state.SetItemsProcessed(state.iterations() * data.search.size());
+    reportAllocations(state, before, data.search.size());
+}
+BENCHMARK(BM_IndexedSearch)->Apply(sizes);
+
+void BM_BuildSummaries(benchmark::State& state)
+{
+    const WaterDataset& dataset = loaded(state.range(0)).dataset;
+    const WaterDataset::IndexInput input = dataset.indexInput();
+
+    const AllocationCount before = processAllocations();
+    for (auto _ : state) {
+        TrendCube trends;
+        QVector<SamplingPoint> sites;
+        WaterDataset::buildSummaries(input, trends, sites);
+        benchmark::DoNotOptimize(trends.cellCount());
+    }
+    state.SetItemsProcessed(state.iterations() * input.records.size());
+    reportAllocations(state, before, input.records.size());
+}
+BENCHMARK(BM_BuildSummaries)->Apply(sizes);
+
+void BM_BuildSpatialIndex(benchmark::State& state)
+{
+    const QVector<SamplingPoint> located = loaded(state.range(0)).sites;
+
+    const AllocationCount before = processAllocations();
+    for (auto _ : state) {
+        QVector<SamplingPoint> sites = located;
+        SiteSpatialIndex index;
+        WaterDataset::buildSpatialIndex(sites, index);
+        benchmark::DoNotOptimize(index.isEmpty());
+    }
+    state.SetItemsProcessed(state.iterations() * located.size());
+    reportAllocations(state, before, located.size());
+    state.counters["sites"] = located.size();
+}
+BENCHMARK(BM_BuildSpatialIndex)->Apply(sizes);
+
+void BM_BuildSearchIndex(benchmark::State& state)
+{
+    const WaterDataset::IndexInput input = loaded(state.range(0)).dataset.indexInput();
+
+    const AllocationCount before = processAllocations();
+    for (auto _ : state) {
+        SearchIndex index;
+        WaterDataset::buildSearchIndex(input, index);
+        benchmark::DoNotOptimize(index.size());
+    }
+    state.SetItemsProcessed(state.iterations() * input.records.size());
+    reportAllocations(state, before, input.records.size());
+}
+BENCHMARK(BM_BuildSearchIndex)->Apply(sizes);
+
+void BM_BuildSiteDateIndex(benchmark::State& state)
+{
+    const WaterDataset::IndexInput input = loaded(state.range(0)).dataset.indexInput();
+
+    const AllocationCount before = processAllocations();
+    for (auto _ : state) {
+        SiteDateIndex index;
+        WaterDataset::buildSiteDateIndex(input, index);
+        benchmark::DoNotOptimize(index.size());
+    }
+    state.SetItemsProcessed(state.iterations() * input.records.size());
+    reportAllocations(state, before, input.records.size());
+}
+BENCHMARK(BM_BuildSiteDateIndex)->Apply(sizes);
+
+// Grid to WGS84 conversion alone, over one batch of points spread across
+// the National Grid, as buildSpatialIndex converts the located sites
+void BM_OsgbToWgs84(benchmark::State& state)
+{
+    const int count = int(state.range(0));
+    QVector<double> eastings(count), northings(count), latitudes(count), longitudes(count);
+    QRandomGenerator random(SEED);
+    for (int i = 0; i < count; ++i) {
+        eastings[i] = random.bounded(700000.0);
+        northings[i] = random.bounded(1250000.0);
+    }
+
+    const AllocationCount before = processAllocations();
+    for (auto _ : state) {
+        osgbToWgs84(eastings.constData(), northings.constData(), latitudes.data(), longitudes.data(), count);
+        benchmark::DoNotOptimize(latitudes.data());
+        benchmark::DoNotOptimize(longitudes.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+    reportAllocations(state, before, count);
+}
+BENCHMARK(BM_OsgbToWgs84)->Arg(1000)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMicrosecond);
+
+// Monthly trend series for every determinand, overall and at the busiest
+// site, as the trend charts request them
+void BM_ChartSeries(benchmark::State& state)
+{
+    const LoadedData& data = loaded(state.range(0));
+    const int determinands = data.dataset.determinands().size();
+
+    int busiest = 0;
+    for (int site = 0; site < data.sites.size(); ++site) {
+        if (data.sites[site].samples > data.sites[busiest].samples) {
+            busiest = site;
+        }
+    }
+
+    const AllocationCount before = processAllocations();
+    for (auto _ : state) {
+        qint64 buckets = 0;
+        for (int determinand = 0; determinand < determinands; ++determinand) {
+            buckets += data.trends.series(determinand, TrendCube::ALL_SITES, TimeGranularity::Month).size();
+            buckets += data.trends.series(determinand, busiest, TimeGranularity::Week).size();
+        }
+        benchmark::DoNotOptimize(buckets);
+    }
+    state.SetItemsProcessed(state.iterations() * determinands * 2);
+    reportAllocations(state, before, determinands * 2);
+}
+BENCHMARK(BM_ChartSeries)->Apply(sizes);
+
+// The POPs and Fluorinated chart path: scan rows for one sample's results
+void BM_SampleScan(benchmark::State& state)
+{
+    const QVector<WaterRecord>& records = loaded(state.range(0)).dataset.records();
+    const WaterRecord& sample = records[records.size() / 2];
+
+    const AllocationCount before = processAllocations();
+    for (auto _ : state) {
+        qint64 points = 0;
+        for (const WaterRecord& record : records) {
+            if (record.samplingPointId == sample.samplingPointId && record.date == sample.date) {
+                bool ok;
+                record.result.toDouble(&ok);
+                points += ok;
+            }
+        }
+        benchmark::DoNotOptimize(points);
+    }
+    state.SetItemsProcessed(state.iterations() * records.size());
+    reportAllocations(state, before, records.size());
+}
+BENCHMARK(BM_SampleScan)->Apply(sizes);
+
+// The same sample's rows found through the site and date index
+void BM_SampleLookup(benchmark::State& state)
+{
+    const LoadedData& data = loaded(state.range(0));
+    const QVector<WaterRecord>& records = data.dataset.records();
+    const WaterRecord& sample = records[records.size() / 2];
+
+    const AllocationCount before = processAllocations();
+    for (auto _ : state) {
+        qint64 points = 0;
+        for (int row : data.siteDates.rows(records, sample.samplingPointId, sample.date)) {
+            bool ok;
+            records[row].result.toDouble(&ok);
+            points += ok;
+        }
+        benchmark::DoNotOptimize(points);
+    }
+    state.SetItemsProcessed(state.iterations());
+    reportAllocations(state, before, 1);
+}
+BENCHMARK(BM_SampleLookup)->Apply(sizes);
+
+}
+
+int main(int argc, char** argv)
+{
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+
+    QCoreApplication app(argc, argv);
+
+    // Measure the pipeline itself, not the span bookkeeping
+    TraceRecorder::setEnabled(false);
+
+    benchmark::AddCustomContext("synthetic_seed", std::to_string(SEED));
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,142 @@
+#include "categories.hpp"
+#include "dataset.hpp"
+#include <QtGlobal>
+
+namespace {
+
+// Parse a result, ignoring a leading "<" (below detection limit) qualifier
+double parseResult(const QString& result, bool* ok)
+{
+    return result.startsWith("<") ? result.mid(1).toDouble(ok) : result.toDouble(ok);
+}
+
+// Three-band status used by the Pollutant Overview page
+QString thresholdStatus(double value, double threshold)
+{
+    if (value < threshold)
+        return "Compliant";
+    else if (qFuzzyCompare(value, threshold))
+        return "Caution";
+    else
+        return "Exceeds";
+}
+
+}
+
+QList<PollutantCategory> allCategories()
+{
+    return {PollutantCategory::PollutantOverview, PollutantCategory::POPs,
+            PollutantCategory::EnvironmentalLitter, PollutantCategory::Fluorinated};
+}
+
+QString categoryName(PollutantCategory category)
+{
+    switch (category) {
+    case PollutantCategory::PollutantOverview:
+        return "Pollutant Overview";
+    case PollutantCategory::POPs:
+        return "Persistent Organic Pollutants";
+    case PollutantCategory::EnvironmentalLitter:
+        return "Environmental Litter Indicators";
+    case PollutantCategory::Fluorinated:
+        return "Fluorinated Compounds";
+    }
+    return QString();
+}
+
+QList<CategoryPattern> defaultCategoryPatterns()
+{
+    const PollutantCategory overview = PollutantCategory::PollutantOverview;
+    const PollutantCategory pops = PollutantCategory::POPs;
+    const PollutantCategory litter = PollutantCategory::EnvironmentalLitter;
+    const PollutantCategory fluorinated = PollutantCategory::Fluorinated;
+
+    return {
+        {overview, PatternField::Label, "112TCEthan", true, true},
+        {overview, PatternField::Label, "Chloroform", true, true},
+        {overview, PatternField::Label, "Benzene", true, true},
+        {overview, PatternField::Label, "Toluene", true, true},
+        {pops, PatternField::Definition, "PCB"},
+        // "PCB : Total" is an aggregate of the individual congeners, so skip it
+        {pops, PatternField::Definition, "PCB : Total", true, false, true},
+        {litter, PatternField::Label, "BWP - O.L.", true, true},
+        {litter, PatternField::Label, "BWP - A.F.", true, true},
+        {fluorinated, PatternField::Definition, "fluoro"},
+    };
+}
+
+int minimumColumns(PollutantCategory category)
+{
+    return category == PollutantCategory::EnvironmentalLitter ? 13 : 12;
+}
+
+quint8 rowCategories(quint8 determinandCategories, int columnCount)
+{
+    quint8 mask = determinandCategories;
+    for (int index = 0; index < POLLUTANT_CATEGORY_COUNT; ++index) {
+        const PollutantCategory category = static_cast<PollutantCategory>(index);
+        if (columnCount < minimumColumns(category)) {
+            mask &= ~categoryBit(category);
+        }
+    }
+    return mask;
+}
+
+Classification classifyRecord(PollutantCategory category, const WaterRecord& record)
+{
+    Classification classification;
+    classification.unit = record.unit;
+
+    if (category == PollutantCategory::EnvironmentalLitter) {
+        // Litter counts are compared as-is against the EU limit
+        classification.value = record.result.toDouble(&classification.numeric);
+        classification.status = record.result.toDouble() < 0.05 ? "Compliant" : "Non-Compliant";
+        return classification;
+    }
+
+    classification.value = parseResult(record.result, &classification.numeric);
+    if (!classification.numeric) {
+        classification.status = "Unknown";
+        return classification;
+    }
+
+    // Convert mg/L to µg/L where the page reports in µg/L
+    if (category != PollutantCategory::POPs && classification.unit == "mg/l") {
+        classification.value *= 1000;
+        classification.unit = "ug/l";
+    }
+
+    const double value = classification.value;
+    switch (category) {
+    case PollutantCategory::PollutantOverview:
+        if (record.determinand == "112TCEthan" || record.determinand == "Chloroform")
+            classification.status = thresholdStatus(value, 0.1);
+        else if (record.determinand == "Benzene")
+            classification.status = thresholdStatus(value, 1.0);
+        else if (record.determinand == "Toluene")
+            classification.status = thresholdStatus(value, 4.0);
+        else
+            classification.status = "Unknown";
+        break;
+    case PollutantCategory::POPs:
+        classification.status = value <= 0.001 ? "Compliant" : "Non-Compliant";
+        break;
+    case PollutantCategory::Fluorinated:
+        classification.status = value <= 0.1 ? "Compliant" : "Non-Compliant";
+        break;
+    case PollutantCategory::EnvironmentalLitter:
+        break;
+    }
+
+    return classification;
+}
+
+QString complianceFlagStatus(const WaterRecord& record)
+{
+    return record.complianceFlag.toLower() == "true" ? "Compliant" : "Non-Compliant";
+}
+
+bool isExceedance(const QString& status)
+{
+    return status == "Non-Compliant" || status == "Exceeds";
+}
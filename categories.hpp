@@ -0,0 +1,74 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QList>
+
+struct WaterRecord;
+
+// Pollutant groups shown on the dashboard, each with its own selection and
+// compliance rules. Shared by the GUI pages and the headless report.
+enum class PollutantCategory {
+    PollutantOverview,
+    POPs,
+    EnvironmentalLitter,
+    Fluorinated
+};
+
+static const int POLLUTANT_CATEGORY_COUNT = 4;
+
+inline quint8 categoryBit(PollutantCategory category)
+{
+    return quint8(1u << static_cast<int>(category));
+}
+
+// Text of a determinand that a pattern is looked for in
+enum class PatternField {
+    Label,      // Column 5
+    Definition  // Column 6
+};
+
+// One rule placing determinands in a category. Pattern text is ASCII and
+// matches case-insensitively unless caseSensitive is set, anywhere in the
+// field or, with wholeField, only as all of it. A match of an excluding
+// pattern keeps the determinand out of the category whatever else matches.
+struct CategoryPattern
+{
+    PollutantCategory category;
+    PatternField field;
+    QByteArray text;
+    bool wholeField = false;
+    bool caseSensitive = false;
+    bool excludes = false;
+};
+
+// Outcome of applying a category's compliance rules to one record
+struct Classification
+{
+    bool numeric = false;   // Whether the result parsed as a number
+    double value = 0.0;     // Result converted to the category's display unit
+    QString unit;           // Unit after any conversion
+    QString status;         // "Compliant", "Non-Compliant", "Caution", "Exceeds" or "Unknown"
+};
+
+QList<PollutantCategory> allCategories();
+QString categoryName(PollutantCategory category);
+
+// Rules behind each page's selection, used by CategoryMatcher::standard()
+QList<CategoryPattern> defaultCategoryPatterns();
+
+// Fewest columns a row needs to be shown on the category's page
+int minimumColumns(PollutantCategory category);
+
+// Categories of a row, from those of its determinand (see
+// DeterminandDimension) and the row's width
+quint8 rowCategories(quint8 determinandCategories, int columnCount);
+
+// Apply the category's thresholds to a record that matches it
+Classification classifyRecord(PollutantCategory category, const WaterRecord& record);
+
+// Compliance Dashboard rule, based on the sample's compliance flag
+QString complianceFlagStatus(const WaterRecord& record);
+
+// Whether a status counts as an exceedance of the safety threshold
+bool isExceedance(const QString& status);
@@ -0,0 +1,106 @@
+#include "categorymatcher.hpp"
+#include <cstring>
+
+namespace {
+
+const int ALPHABET = 256;
+
+unsigned char fold(char ch)
+{
+    return ch >= 'A' && ch <= 'Z' ? ch - 'A' + 'a' : static_cast<unsigned char>(ch);
+}
+
+}
+
+CategoryMatcher::CategoryMatcher(const QList<CategoryPattern>& patterns) : patterns(patterns)
+{
+    build(labelAutomaton, PatternField::Label);
+    build(definitionAutomaton, PatternField::Definition);
+}
+
+const CategoryMatcher& CategoryMatcher::standard()
+{
+    static const CategoryMatcher matcher(defaultCategoryPatterns());
+    return matcher;
+}
+
+void CategoryMatcher::build(Automaton& automaton, PatternField field)
+{
+    // Trie of the field's patterns; -1 marks a missing edge until the links are filled in
+    automaton.transitions = QVector<int>(ALPHABET, -1);
+    automaton.outputs = QVector<QVector<int>>(1);
+
+    for (int index = 0; index < patterns.size(); ++index) {
+        const CategoryPattern& pattern = patterns[index];
+        if (pattern.field != field || pattern.text.isEmpty()) {
+            continue;
+        }
+        int state = 0;
+        for (char ch : pattern.text) {
+            const int edge = state * ALPHABET + fold(ch);
+            if (automaton.transitions[edge] < 0) {
+                automaton.transitions[edge] = automaton.outputs.size();
+                automaton.outputs.append(QVector<int>());
+                automaton.transitions.resize(automaton.transitions.size() + ALPHABET, -1);
+            }
+            state = automaton.transitions[edge];
+        }
+        automaton.outputs[state].append(index);
+    }
+
+    // Breadth-first, so each state's failure state is finished before it is used
+    QVector<int> failure(automaton.outputs.size(), 0);
+    QVector<int> queue;
+    for (int byte = 0; byte < ALPHABET; ++byte) {
+        int& next = automaton.transitions[byte];
+        if (next < 0) {
+            next = 0;
+        } else {
+            queue.append(next);
+        }
+    }
+    for (int head = 0; head < queue.size(); ++head) {
+        const int state = queue[head];
+        automaton.outputs[state] += automaton.outputs[failure[state]];
+        for (int byte = 0; byte < ALPHABET; ++byte) {
+            int& next = automaton.transitions[state * ALPHABET + byte];
+            const int fallback = automaton.transitions[failure[state] * ALPHABET + byte];
+            if (next < 0) {
+                next = fallback;
+            } else {
+                failure[next] = fallback;
+                queue.append(next);
+            }
+        }
+    }
+}
+
+void CategoryMatcher::scan(const Automaton& automaton, QByteArrayView text, quint8& included,
+                           quint8& excluded) const
+{
+    int state = 0;
+    for (qsizetype end = 1; end <= text.size(); ++end) {
+        state = automaton.transitions[state * ALPHABET + fold(text[end - 1])];
+        for (int index : automaton.outputs[state]) {
+            const CategoryPattern& pattern = patterns[index];
+            const qsizetype start = end - pattern.text.size();
+            if (pattern.wholeField && (start != 0 || end != text.size())) {
+                continue;
+            }
+            if (pattern.caseSensitive
+                && std::memcmp(text.data() + start, pattern.text.constData(), pattern.text.size()) != 0) {
+                continue;
+            }
+            (pattern.excludes ? excluded : included) |= categoryBit(pattern.category);
+        }
+    }
+}
+
+quint8 CategoryMatcher::match(QByteArrayView label, QByteArrayView definition) const
+{
+    quint8 included = 0;
+    quint8 excluded = 0;
+    scan(labelAutomaton, label, included, excluded);
+    scan(definitionAutomaton, definition, included, excluded);
+    return included & ~excluded;
+}
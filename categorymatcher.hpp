@@ -0,0 +1,37 @@
+#pragma once
+
+#include <QByteArrayView>
+#include <QList>
+#include <QVector>
+#include "categories.hpp"
+
+// Finds the categories of a determinand from its label and definition in
+// one pass over each, however many patterns there are. Each field has an
+// Aho-Corasick automaton over its case-folded patterns, compiled to a full
+// transition table so the scan is one lookup per byte. Hits are then
+// checked for whole-field and case-sensitive patterns.
+class CategoryMatcher
+{
+public:
+    explicit CategoryMatcher(const QList<CategoryPattern>& patterns);
+
+    // Matcher for defaultCategoryPatterns(), built on first use
+    static const CategoryMatcher& standard();
+
+    // Bits of the categories a determinand belongs to
+    quint8 match(QByteArrayView label, QByteArrayView definition) const;
+
+private:
+    struct Automaton
+    {
+        QVector<int> transitions;       // 256 next states per state
+        QVector<QVector<int>> outputs;  // Patterns ending at each state, suffixes included
+    };
+
+    void build(Automaton& automaton, PatternField field);
+    void scan(const Automaton& automaton, QByteArrayView text, quint8& included, quint8& excluded) const;
+
+    QList<CategoryPattern> patterns;
+    Automaton labelAutomaton;
+    Automaton definitionAutomaton;
+};
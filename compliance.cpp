@@ -1,8 +1,10 @@
 #include "compliance.hpp"
-#include <QFile>
-#include <QTextStream>
+#include "categories.hpp"
+#include "tracing.hpp"
 #include <QHeaderView>
 #include <QDebug>
+#include <algorithm>
+#include <cmath>
 
 ComplianceDashboardPage::ComplianceDashboardPage(QWidget* parent) : QWidget(parent)
 {
@@ -21,10 +23,12 @@ ComplianceDashboardPage::ComplianceDashboardPage(QWidget* parent) : QWidget(pare
 
     // Dropdown for filters
     filterTypeDropdown = new QComboBox(this);
+    filterTypeDropdown->setObjectName("filterTypeDropdown");
     filterTypeDropdown->addItems({"None", "Location", "Pollutant", "Compliance Status"});
     connect(filterTypeDropdown, &QComboBox::currentTextChanged, this, &ComplianceDashboardPage::updateFilterOptions);
 
     filterValueDropdown = new QComboBox(this);
+    filterValueDropdown->setObjectName("filterValueDropdown");
     filterValueDropdown->addItem("None");
     connect(filterValueDropdown, &QComboBox::currentTextChanged, this, &ComplianceDashboardPage::applyFilter);
 
@@ -45,11 +49,15 @@ ComplianceDashboardPage::ComplianceDashboardPage(QWidget* parent) : QWidget(pare
     infoPanel->setReadOnly(true); // Make it read-only to avoid user edits
     infoPanel->setPlaceholderText("Select a row to view detailed information about compliance.");
 
+    pager = new AggregatePager(this);
+    connect(pager, &AggregatePager::pageChanged, this, &ComplianceDashboardPage::showAggregatePage);
+
     // Add widgets to the layout
     mainLayout->addWidget(title);
     mainLayout->addWidget(filterTypeDropdown);
     mainLayout->addWidget(filterValueDropdown);
     mainLayout->addWidget(tableView);
+    mainLayout->addWidget(pager);
     mainLayout->addWidget(infoPanel);
     mainLayout->addWidget(backButton);
 
@@ -57,8 +65,10 @@ ComplianceDashboardPage::ComplianceDashboardPage(QWidget* parent) : QWidget(pare
     applyFilter("None");
 }
 
-void ComplianceDashboardPage::loadCsvFile(const QString& filePath)
+void ComplianceDashboardPage::loadDataset(const WaterDataset& source)
 {
+    TraceScope trace("ComplianceDashboardPage::loadDataset");
+
     // Clear existing data to prepare for new data
     dataModel->clear();
     dataModel->setHorizontalHeaderLabels({"Location", "Date", "Pollutant", "Result", "Units", "Compliance"});
@@ -66,9 +76,86 @@ void ComplianceDashboardPage::loadCsvFile(const QString& filePath)
     pollutants.clear();
     complianceStatuses.clear();
 
-    // Call loadData to populate the table with the new file
-    loadData(filePath);
+    dataset = &source;
+    aggregates = nullptr;
+    pager->reset();
+
+    // Call loadData to populate the table with the new dataset
+    loadData(source);
+    resetFilters();
+}
+
+void ComplianceDashboardPage::loadAggregates(const AggregationIndex& index)
+{
+    TraceScope trace("ComplianceDashboardPage::loadAggregates");
+
+    dataset = nullptr;
+    aggregates = &index;
+    pager->reset();
+    showAggregatePage();
+}
+
+void ComplianceDashboardPage::showAggregatePage()
+{
+    TraceScope trace("ComplianceDashboardPage::showAggregatePage");
+
+    const AggregationIndex& index = *aggregates;
+    dataModel->clear();
+    dataModel->setHorizontalHeaderLabels({"Location", "Month", "Pollutant", "Mean Result", "Units", "Compliance"});
+    locations.clear();
+    pollutants.clear();
+    complianceStatuses.clear();
 
+    // One row per location, pollutant and month of flagged samples; only
+    // the current page's rows become items
+    const qint64 first = pager->firstRow();
+    qint64 matching = 0;
+    index.forEachAggregate([&](const AggregateKey& key, const MonthlyAggregate& aggregate) {
+        if (aggregate.flaggedSamples == 0) {
+            return;
+        }
+        const qint64 row = matching++;
+        if (row < first || row >= first + AggregationIndex::PAGE_ROWS) {
+            return;
+        }
+
+        QString location = index.siteName(key.site);
+        QString pollutant = index.determinandLabel(key.determinand);
+        QString compliance = aggregate.flaggedCompliant == aggregate.flaggedSamples ? "Compliant" : "Non-Compliant";
+
+        QStandardItem* locationItem = new QStandardItem(location);
+        locationItem->setData(aggregate.sampleOffset, Qt::UserRole); // First raw row, fetched on selection
+
+        QStandardItem* resultItem = new QStandardItem(
+            aggregate.valueCount > 0 ? QString::number(aggregate.mean(), 'g', 6) : "N/A");
+        resultItem->setToolTip(QString("Samples: %1\nCompliant samples: %2\nMin: %3\nMax: %4")
+                                   .arg(aggregate.flaggedSamples)
+                                   .arg(aggregate.flaggedCompliant)
+                                   .arg(aggregate.min)
+                                   .arg(aggregate.max));
+
+        QList<QStandardItem*> row = {
+            locationItem,
+            new QStandardItem(AggregationIndex::monthLabel(key.month)),
+            new QStandardItem(pollutant),
+            resultItem,
+            new QStandardItem(index.determinandUnit(key.determinand)),
+            new QStandardItem(compliance)
+        };
+        dataModel->appendRow(row);
+
+        // Store values for filtering
+        locations.insert(location);
+        pollutants.insert(pollutant);
+        complianceStatuses.insert(compliance);
+    });
+
+    pager->setTotal(matching);
+    resetFilters();
+}
+
+void ComplianceDashboardPage::resetFilters()
+{
     // Reset dropdown filters
     filterTypeDropdown->setCurrentIndex(0);
     filterValueDropdown->clear();
@@ -78,35 +165,27 @@ void ComplianceDashboardPage::loadCsvFile(const QString& filePath)
     applyFilter("None");
 }
 
-void ComplianceDashboardPage::loadData(const QString& filePath)
+void ComplianceDashboardPage::loadData(const WaterDataset& source)
 {
-    QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        qWarning() << "Unable to open file:" << filePath;
-        return;
-    }
-
-    QTextStream in(&file);
-    bool isHeader = true;
-
-    while (!in.atEnd()) {
-        QString line = in.readLine();
-        if (isHeader) {
-            isHeader = false;
-            continue;
-        }
-
-        QStringList columns = parseCSVLine(line);
-        if (columns.size() >= 14) {
-            QString location = columns[3].trimmed();
-            QString date = columns[4].trimmed();
-            QString pollutant = columns[5].trimmed();
-            QString result = columns[9].trimmed();
-            QString units = columns[11].trimmed();
-            QString compliance = columns[13].trimmed().toLower() == "true" ? "Compliant" : "Non-Compliant";
+    TraceScope trace("ComplianceDashboardPage::loadData");
+
+    const QVector<WaterRecord>& records = source.records();
+    for (int i = 0; i < records.size(); ++i) {
+        const WaterRecord& record = records[i];
+        if (record.columnCount >= 14) {
+            QString location = record.samplingPoint;
+            QString date = record.date;
+            QString pollutant = record.determinand;
+            QString result = record.result;
+            QString units = record.unit;
+            QString compliance = complianceFlagStatus(record);
+
+            // Remember the record so its remaining columns can be read back on selection
+            QStandardItem* locationItem = new QStandardItem(location);
+            locationItem->setData(i, Qt::UserRole);
 
             QList<QStandardItem*> row = {
-                new QStandardItem(location),
+                locationItem,
                 new QStandardItem(date),
                 new QStandardItem(pollutant),
                 new QStandardItem(result),
@@ -121,36 +200,12 @@ void ComplianceDashboardPage::loadData(const QString& filePath)
             complianceStatuses.insert(compliance);
         }
     }
-
-    file.close();
-}
-
-QStringList ComplianceDashboardPage::parseCSVLine(const QString& line) const
-{
-    QStringList result;
-    QString currentField;
-    bool insideQuotes = false;
-
-    for (QChar ch : line) {
-        if (ch == '"') {
-            insideQuotes = !insideQuotes;
-        } else if (ch == ',' && !insideQuotes) {
-            result.append(currentField.trimmed());
-            currentField.clear();
-        } else {
-            currentField.append(ch);
-        }
-    }
-
-    if (!currentField.isEmpty()) {
-        result.append(currentField.trimmed());
-    }
-
-    return result;
 }
 
 void ComplianceDashboardPage::updateFilterOptions(const QString& filterType)
 {
+    TraceScope trace("ComplianceDashboardPage::updateFilterOptions");
+
     filterValueDropdown->clear();
     filterValueDropdown->addItem("None"); // Default option
 
@@ -170,6 +225,8 @@ void ComplianceDashboardPage::updateFilterOptions(const QString& filterType)
 
 void ComplianceDashboardPage::applyFilter(const QString& filterValue)
 {
+    TraceScope trace("ComplianceDashboardPage::applyFilter");
+
     QString filterType = filterTypeDropdown->currentText();
 
     if (filterType == "None" || filterValue == "None") {
@@ -195,6 +252,8 @@ void ComplianceDashboardPage::applyFilter(const QString& filterValue)
 
 void ComplianceDashboardPage::onRowSelected(const QModelIndex& index)
 {
+    TraceScope trace("ComplianceDashboardPage::onRowSelected");
+
     if (!index.isValid())
         return;
 
@@ -211,10 +270,90 @@ void ComplianceDashboardPage::onRowSelected(const QModelIndex& index)
                        "Historical Trend: Site has consistently exceeded safe levels.");
     }
 
+    if (dataset) {
+        // Only the displayed columns are kept in memory; fetch the rest from the file
+        int record = dataModel->item(index.row(), 0)->data(Qt::UserRole).toInt();
+        QStringList header = dataset->header();
+        QStringList fields = dataset->rawRow(record);
+
+        details.append("\n\nFull record:");
+        for (int i = 0; i < fields.size(); ++i) {
+            details.append(QString("\n%1: %2").arg(header.value(i, QString::number(i)), fields[i]));
+        }
+
+        if (record >= 0 && record < dataset->records().size()) {
+            details.append(nearbySitesText(dataset->records().at(record).samplingPointId));
+        }
+    } else if (aggregates) {
+        // Summary rows only keep the offset of their first sample; re-read it from the file
+        qint64 offset = dataModel->item(index.row(), 0)->data(Qt::UserRole).toLongLong();
+        QStringList header = aggregates->rawRow(0);
+        QStringList fields = aggregates->rawRow(offset);
+
+        details.append("\n\n" + dataModel->item(index.row(), 3)->toolTip());
+        details.append("\n\nFirst sample of the month:");
+        for (int i = 0; i < fields.size(); ++i) {
+            details.append(QString("\n%1: %2").arg(header.value(i, QString::number(i)), fields[i]));
+        }
+    }
+
     updateInfoPanel(details);
 }
 
 void ComplianceDashboardPage::updateInfoPanel(const QString& complianceInfo)
 {
     infoPanel->setText(complianceInfo);
+}
+
+QString ComplianceDashboardPage::nearbySitesText(int site) const
+{
+    const QVector<SamplingPoint>& sites = dataset->samplingPoints();
+    if (site < 0 || site >= sites.size() || !sites[site].hasLocation) {
+        return QString();
+    }
+
+    // Other sampling points around this one, nearest first, from the dataset's
+    // spatial index or, while that is still building, a scan of every site
+    const QPointF position(sites[site].easting, sites[site].northing);
+    const double radius = NEARBY_RADIUS_KM * 1000;
+    QVector<NearbySite> nearby;
+    if (dataset->hasSpatialIndex()) {
+        nearby = dataset->spatialIndex().sitesWithin(position, radius);
+    } else {
+        for (int other = 0; other < sites.size(); ++other) {
+            if (!sites[other].hasLocation) continue;
+            const double distance = std::hypot(sites[other].easting - position.x(), sites[other].northing - position.y());
+            if (distance <= radius) {
+                nearby.append({other, distance});
+            }
+        }
+        std::sort(nearby.begin(), nearby.end(), [](const NearbySite& a, const NearbySite& b) {
+            return a.distance < b.distance;
+        });
+    }
+
+    QString text = QString("\n\nSampling points within %1 km:").arg(NEARBY_RADIUS_KM);
+    int shown = 0;
+    for (const NearbySite& other : nearby) {
+        if (other.site == site) {
+            continue;
+        }
+        if (shown == MAX_NEARBY_SITES) {
+            text.append(QString("\n...and %1 more").arg(nearby.size() - 1 - shown));
+            break;
+        }
+
+        const SamplingPoint& point = sites[other.site];
+        text.append(QString("\n%1 (%2 km): %3 of %4 categorised samples exceed")
+                        .arg(point.label)
+                        .arg(other.distance / 1000, 0, 'f', 1)
+                        .arg(point.exceedances)
+                        .arg(point.classified));
+        shown++;
+    }
+
+    if (shown == 0) {
+        text.append("\nNone");
+    }
+    return text;
 }
\ No newline at end of file
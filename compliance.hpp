@@ -12,6 +12,9 @@
 #include <QSet>
 #include <QStringList>
 #include <QTextEdit>
+#include "dataset.hpp"
+#include "aggregates.hpp"
+#include "aggregatepager.hpp"
 
 class ComplianceDashboardPage : public QWidget
 {
@@ -21,8 +24,11 @@ public:
     // Constructor
     explicit ComplianceDashboardPage(QWidget* parent = nullptr);
 
-    // New public method to provide CSV file to loadData
-    void loadCsvFile(const QString& filePath);
+    // Materialise the page from the shared parsed dataset
+    void loadDataset(const WaterDataset& dataset);
+
+    // Show monthly summaries for files opened in aggregation mode
+    void loadAggregates(const AggregationIndex& aggregates);
 
 signals:
     // Signal to navigate back to the dashboard
@@ -37,23 +43,30 @@ private:
     QComboBox* filterValueDropdown;
     QPushButton* backButton;
     QTextEdit* infoPanel;
+    AggregatePager* pager;          // Pages through summary rows in aggregation mode
+    const WaterDataset* dataset = nullptr;         // Source of full rows for the info panel
+    const AggregationIndex* aggregates = nullptr; // Set in aggregation mode
 
     // Data containers for filtering
     QSet<QString> locations;
     QSet<QString> pollutants;
     QSet<QString> complianceStatuses;
 
+    // Radius and length of the nearby sampling points list in the info panel
+    static constexpr double NEARBY_RADIUS_KM = 5.0;
+    static const int MAX_NEARBY_SITES = 10;
+
     // Methods for functionality
-    void loadData(const QString& filePath);             
+    void loadData(const WaterDataset& dataset);             
+    void showAggregatePage();
+    void resetFilters();
     void updateFilterOptions(const QString& filterType); 
     void applyFilter(const QString& filterValue);       
 
     // Methods for dynamic info panel updates
     void onRowSelected(const QModelIndex& index); // Add declaration
     void updateInfoPanel(const QString& complianceInfo); // Add declaration
-
-    // Parse a CSV line to split fields, considering commas inside quotes
-    QStringList parseCSVLine(const QString& line) const; 
+    QString nearbySitesText(int site) const;
 
     // Delegate for coloring table rows based on compliance
     class ComplianceDelegate : public QStyledItemDelegate {
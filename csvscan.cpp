@@ -0,0 +1,141 @@
+#include "csvscan.hpp"
+
+namespace {
+
+bool isSpace(char ch)
+{
+    return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n' || ch == '\v' || ch == '\f';
+}
+
+QByteArrayView trimView(QByteArrayView view)
+{
+    qsizetype begin = 0;
+    qsizetype end = view.size();
+    while (begin < end && isSpace(view[begin])) {
+        begin++;
+    }
+    while (end > begin && isSpace(view[end - 1])) {
+        end--;
+    }
+    return view.sliced(begin, end - begin);
+}
+
+}
+
+QByteArrayView CsvField::view() const
+{
+    if (!hasQuotes) {
+        return trimView(raw);
+    }
+
+    // Quoted fields are normally wrapped as a whole: "value"
+    QByteArrayView trimmedRaw = trimView(raw);
+    const qsizetype size = trimmedRaw.size();
+    if (size >= 2 && trimmedRaw[0] == '"' && trimmedRaw[size - 1] == '"'
+        && trimmedRaw.sliced(1, size - 2).indexOf('"') < 0) {
+        return trimView(trimmedRaw.sliced(1, size - 2));
+    }
+    return QByteArrayView();
+}
+
+QByteArray CsvField::bytes() const
+{
+    QByteArrayView simple = view();
+    if (!hasQuotes || !simple.isNull()) {
+        return simple.toByteArray();
+    }
+
+    // Quotes embedded mid-field are dropped
+    QByteArray cleaned;
+    cleaned.reserve(raw.size());
+    for (char ch : raw) {
+        if (ch != '"') {
+            cleaned.append(ch);
+        }
+    }
+    return trimView(cleaned).toByteArray();
+}
+
+QByteArray CsvField::key() const
+{
+    QByteArrayView simple = view();
+    if (!hasQuotes || !simple.isNull()) {
+        return QByteArray::fromRawData(simple.data(), simple.size());
+    }
+    return bytes();
+}
+
+QString CsvField::text() const
+{
+    return QString::fromUtf8(bytes());
+}
+
+int splitCsvLine(QByteArrayView line, CsvField* fields, int maxFields, const CsvProjection& projection)
+{
+    if (line.isEmpty()) {
+        return 0;
+    }
+
+    const char* fieldStart = line.data();
+    const char* const end = fieldStart + line.size();
+    int count = 0;
+
+    for (;;) {
+        // A comma ends the field unless a quote before it opens a quoted section
+        const char* comma = static_cast<const char*>(std::memchr(fieldStart, ',', end - fieldStart));
+        const char* limit = comma ? comma : end;
+        const char* quote = static_cast<const char*>(std::memchr(fieldStart, '"', limit - fieldStart));
+        if (quote) {
+            // Quotes toggle; the field ends at the first comma outside them
+            bool insideQuotes = false;
+            const char* position = quote;
+            for (; position < end; ++position) {
+                if (*position == '"') {
+                    insideQuotes = !insideQuotes;
+                } else if (*position == ',' && !insideQuotes) {
+                    break;
+                }
+            }
+            comma = position < end ? position : nullptr;
+        }
+
+        if (!comma) {
+            // The final field only counts when it has content besides quotes
+            bool hasContent = false;
+            for (const char* position = fieldStart; position < end; ++position) {
+                if (*position != '"') {
+                    hasContent = true;
+                    break;
+                }
+            }
+            if (hasContent) {
+                if (count < maxFields && projection.wants(count)) {
+                    fields[count].raw = QByteArrayView(fieldStart, end - fieldStart);
+                    fields[count].hasQuotes = quote != nullptr;
+                }
+                count++;
+            }
+            return count;
+        }
+
+        if (count < maxFields && projection.wants(count)) {
+            fields[count].raw = QByteArrayView(fieldStart, comma - fieldStart);
+            fields[count].hasQuotes = quote != nullptr;
+        }
+        count++;
+        fieldStart = comma + 1;
+    }
+}
+
+QStringList splitCsvColumns(QByteArrayView line)
+{
+    CsvField fields[CSV_MAX_FIELDS];
+    const int count = qMin(splitCsvLine(line, fields, CSV_MAX_FIELDS), CSV_MAX_FIELDS);
+
+    QStringList columns;
+    columns.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        columns.append(fields[i].text());
+    }
+    return columns;
+}
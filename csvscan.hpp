@@ -0,0 +1,145 @@
+#pragma once
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <cstring>
+#include <initializer_list>
+#include <utility>
+
+// Byte-level CSV tokenizer used by the memory-mapped readers. Fields are
+// views into the mapped file and are only copied when a caller asks for
+// their text. Quotes toggle, commas inside quotes are kept, fields are
+// trimmed and a trailing empty field is dropped.
+struct CsvField
+{
+    QByteArrayView raw;      // Bytes between delimiters, quotes included
+    bool hasQuotes = false;  // Whether raw contains quote characters
+
+    // Field bytes without surrounding whitespace; quotes are stripped when present
+    QByteArrayView view() const;
+    QByteArray bytes() const;
+    // bytes() without the copy unless quotes must be removed; the result
+    // refers to the line and is only valid while the line is
+    QByteArray key() const;
+    QString text() const;
+};
+
+// Largest number of fields split out of a line; the EA export has 17
+static const int CSV_MAX_FIELDS = 32;
+
+// Columns a consumer reads, one bit per column below CSV_MAX_FIELDS. Each
+// reader declares its own so the tokenizer only records the fields it uses.
+class CsvProjection
+{
+public:
+    // Every column
+    CsvProjection() = default;
+
+    static CsvProjection of(std::initializer_list<int> columns)
+    {
+        CsvProjection projection;
+        projection.mask = 0;
+        for (int column : columns) {
+            projection.mask |= quint32(1) << column;
+        }
+        return projection;
+    }
+
+    bool wants(int column) const { return column < CSV_MAX_FIELDS && (mask >> column) & 1; }
+
+private:
+    quint32 mask = ~quint32(0);
+};
+
+// Split a line (without its newline) into fields. Returns the number of fields
+// on the line, which may exceed maxFields; only the first maxFields are filled,
+// and of those only the projected ones. Other entries keep their old contents.
+// Delimiters are found with memchr, and fields without quotes, nearly all of
+// them, are stepped over without looking at their bytes one by one.
+int splitCsvLine(QByteArrayView line, CsvField* fields, int maxFields,
+                 const CsvProjection& projection = CsvProjection());
+
+// Every column of a line (without its newline) as text, for the occasional
+// reader that wants a whole raw row rather than a few projected fields
+QStringList splitCsvColumns(QByteArrayView line);
+
+// Visit each complete line of a buffer as (line, byteOffset), where the
+// offset is baseOffset plus the line's position in the buffer. A trailing
+// line without a newline is only visited when final is set. Returns the
+// number of bytes consumed, so callers can carry a partial line over.
+template <typename Visit>
+qint64 forEachLine(const char* data, qint64 length, qint64 baseOffset, bool final, Visit&& visit)
+{
+    const char* end = data + length;
+    const char* lineStart = data;
+
+    while (lineStart < end) {
+        const char* newline = static_cast<const char*>(std::memchr(lineStart, '\n', end - lineStart));
+        if (!newline && !final) {
+            break;
+        }
+        const char* lineEnd = newline ? newline : end;
+        qsizetype lineLength = lineEnd - lineStart;
+        if (lineLength > 0 && lineStart[lineLength - 1] == '\r') {
+            lineLength--;
+        }
+        visit(QByteArrayView(lineStart, lineLength), baseOffset + (lineStart - data));
+        lineStart = newline ? newline + 1 : end;
+    }
+
+    return lineStart - data;
+}
+
+// Size of each window mapped while streaming a file
+static const qint64 CSV_MAP_WINDOW = 64 * 1024 * 1024;
+
+// Visit the lines of an open file from startOffset, mapping it a window at
+// a time so resident memory stays bounded for files larger than RAM. With
+// wholeLines set, a last line still missing its newline is left unvisited,
+// as when following a file that is being written. When end is given it
+// receives the offset just past the last line visited. Returns false when
+// the file cannot be mapped.
+template <typename Visit>
+bool forEachMappedLine(QFile& file, qint64 startOffset, bool wholeLines, qint64* end, Visit&& visit)
+{
+    const qint64 fileSize = file.size();
+    qint64 position = startOffset;
+    qint64 window = CSV_MAP_WINDOW;
+
+    while (position < fileSize) {
+        const qint64 length = qMin(window, fileSize - position);
+        uchar* mapped = file.map(position, length);
+        if (!mapped) {
+            return false;
+        }
+
+        const bool lastWindow = position + length >= fileSize;
+        const qint64 consumed = forEachLine(reinterpret_cast<const char*>(mapped), length, position,
+                                            lastWindow && !wholeLines, visit);
+        file.unmap(mapped);
+
+        if (consumed == 0) {
+            if (lastWindow) {
+                break; // Only an unfinished line is left
+            }
+            window *= 2; // A single line longer than the window
+        } else {
+            position += consumed;
+        }
+    }
+    if (end) {
+        *end = position;
+    }
+    return true;
+}
+
+// Visit every line of an open file from startOffset, including a last line
+// without a newline
+template <typename Visit>
+bool forEachMappedLine(QFile& file, qint64 startOffset, Visit&& visit)
+{
+    return forEachMappedLine(file, startOffset, false, nullptr, std::forward<Visit>(visit));
+}
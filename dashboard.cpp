@@ -59,6 +59,8 @@ Dashboard::Dashboard(QWidget* parent) : QWidget(parent)
          7331, 7349, [this]() { emit navigateToFluorinatedPage(); }},
         {tr("Compliance Dashboard"), tr("Provides a regulatory compliance summary across all pollutants, with filters to view non-compliant areas and trends."),
          18240, 148543, [this]() { emit navigateToComplianceDashboard(); }},
+        {tr("Sampling Point Map"), tr("Maps every sampling point, coloured by how often its samples exceed safety thresholds, to locate pollution hotspots."),
+         0, 0, [this]() { emit navigateToSamplingMap(); }},
     };
 
     // Create cards dynamically
@@ -89,7 +91,7 @@ Dashboard::Dashboard(QWidget* parent) : QWidget(parent)
 
 void Dashboard::loadCsvFile()
 {
-    QString filePath = QFileDialog::getOpenFileName(this, "Select CSV File", ".", "CSV Files (*.csv)");
+    QString filePath = QFileDialog::getOpenFileName(this, "Select CSV File", ".", "CSV Files (*.csv *.csv.gz *.csv.zst)");
     if (filePath.isEmpty()) {
         return;
     }
@@ -101,6 +103,22 @@ void Dashboard::loadCsvFile()
     emit csvFileLoaded(filePath);
 }
 
+void Dashboard::setComplianceCounts(const QList<QPair<qint64, qint64>>& counts)
+{
+    for (int i = 0; i < counts.size() && i < cardsData.size(); ++i) {
+        cardsData[i].compliant = counts[i].first;
+        cardsData[i].total = counts[i].second;
+    }
+    createCards();
+}
+
+void Dashboard::setSiteCounts(qint64 compliant, qint64 total)
+{
+    cardsData.last().compliant = compliant;
+    cardsData.last().total = total;
+    createCards();
+}
+
 QWidget* Dashboard::createCard(const QString& title,
                                const QString& summary,
                                const QString& complianceText,
@@ -12,6 +12,7 @@
 #include <QDebug>
 #include <QList> 
 #include <QString> 
+#include <QPair>
 
 class Dashboard : public QWidget
 {
@@ -21,6 +22,12 @@ public:
     // Constructor
     explicit Dashboard(QWidget* parent = nullptr);
 
+    // Replace the cards' compliant/total figures, in card order
+    void setComplianceCounts(const QList<QPair<qint64, qint64>>& counts);
+
+    // Replace the map card's sites-without-exceedances/total figures
+    void setSiteCounts(qint64 compliant, qint64 total);
+
 signals:
     // Signal to navigate to different pages
     void navigateToPollutantOverview();
@@ -28,6 +35,7 @@ signals:
     void navigateToEnvironmentalLitter();
     void navigateToFluorinatedPage();
     void navigateToComplianceDashboard();
+    void navigateToSamplingMap();
     
     // Signal to notify all pages when CSV file changes
     void csvFileLoaded(const QString& filePath);
@@ -52,8 +60,8 @@ private:
     struct CardData {
         QString title;
         QString summary;
-        int compliant;
-        int total;
+        qint64 compliant;
+        qint64 total;
         std::function<void()> onClick;
     };
     QList<CardData> cardsData;
@@ -0,0 +1,747 @@
+#include "dataset.hpp"
+#include "csvscan.hpp"
+#include "decompression.hpp"
+#include "categories.hpp"
+#include "osgb.hpp"
+#include "rowsort.hpp"
+#include "taskscheduler.hpp"
+#include "tracing.hpp"
+#include <QFileInfo>
+#include <QPointF>
+#include <QSet>
+#include <QDebug>
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+// Columns read into a WaterRecord, and those plus the grid reference
+const CsvProjection RECORD_COLUMNS = CsvProjection::of({3, 4, 5, 6, 9, 11, 12, 13});
+const CsvProjection LOCATED_RECORD_COLUMNS = CsvProjection::of({3, 4, 5, 6, 9, 11, 12, 13, 15, 16});
+
+// Build a record from the hot columns of a split line
+WaterRecord recordFromFields(const CsvField* fields, int count)
+{
+    auto column = [fields, count](int index) {
+        return index < count ? fields[index].text() : QString();
+    };
+
+    WaterRecord record;
+    record.samplingPoint = column(3);
+    record.date = column(4);
+    record.determinand = column(5);
+    record.definition = column(6);
+    record.result = column(9);
+    record.unit = column(11);
+    record.materialType = column(12);
+    record.complianceFlag = column(13);
+    record.columnCount = count;
+    return record;
+}
+
+// Rows parsed from one slice of the file by one task
+struct ParsedChunk
+{
+    QVector<WaterRecord> records;
+    QVector<qint64> offsets;
+    QHash<QString, QPointF> locations; // First grid reference in the slice for each site
+    DeterminandDimension determinands; // Slice-local ids, as held by the records until merged
+    RowBitmap categoryRows[POLLUTANT_CATEGORY_COUNT]; // Slice rows in each category
+};
+
+// Slices smaller than this are not worth another thread
+const qint64 MIN_CHUNK_BYTES = 4 * 1024 * 1024;
+
+// More slices than workers, so a worker stalled on a long slice is covered by the others
+const int CHUNKS_PER_WORKER = 4;
+
+// Offsets splitting [begin, end) into about chunks slices that each end on a line boundary
+QVector<qint64> chunkBounds(const char* data, qint64 begin, qint64 end, int chunks)
+{
+    QVector<qint64> bounds = {begin};
+    const qint64 step = (end - begin) / qMax(chunks, 1);
+    for (int i = 1; i < chunks; ++i) {
+        const qint64 target = qMax(begin + step * i, bounds.last());
+        const char* newline = static_cast<const char*>(std::memchr(data + target, '\n', end - target));
+        if (!newline) {
+            break;
+        }
+        const qint64 next = newline - data + 1;
+        if (next > bounds.last() && next < end) {
+            bounds.append(next);
+        }
+    }
+    bounds.append(end);
+    return bounds;
+}
+
+void parseChunk(const char* data, qint64 begin, qint64 end, qint64 baseOffset, ParsedChunk& chunk)
+{
+    TraceScope trace("WaterDataset::parseSlice");
+
+    CsvField fields[CSV_MAX_FIELDS];
+    QSet<QString> labels; // Shares repeated labels in the slice until they are interned
+
+    forEachLine(data + begin, end - begin, baseOffset + begin, true, [&](QByteArrayView line, qint64 offset) {
+        const int count = splitCsvLine(line, fields, CSV_MAX_FIELDS, LOCATED_RECORD_COLUMNS);
+
+        // Categories come from the determinand's raw bytes, classified once
+        // per distinct label and definition, before anything else on the row is decoded
+        quint8 categories = 0;
+        const int determinand = chunk.determinands.intern(count > 5 ? fields[5].key() : QByteArray(),
+                                                          count > 6 ? fields[6].key() : QByteArray(), &categories);
+        const int row = chunk.records.size();
+        if (const quint8 mask = rowCategories(categories, count)) {
+            for (int category = 0; category < POLLUTANT_CATEGORY_COUNT; ++category) {
+                if (mask & (1u << category)) {
+                    RowBitmap& rows = chunk.categoryRows[category];
+                    rows.resize(row + 1);
+                    rows.set(row);
+                }
+            }
+        }
+
+        WaterRecord record = recordFromFields(fields, count);
+        record.samplingPoint = *labels.insert(record.samplingPoint);
+        record.determinand = chunk.determinands.label(determinand);
+        record.determinandId = determinand;
+        record.categories = categories;
+
+        // Coordinates are only parsed until one row of the site provides them
+        if (count > 16 && !chunk.locations.contains(record.samplingPoint)) {
+            bool eastingOk, northingOk;
+            const double easting = fields[15].bytes().toDouble(&eastingOk);
+            const double northing = fields[16].bytes().toDouble(&northingOk);
+            if (eastingOk && northingOk) {
+                chunk.locations.insert(record.samplingPoint, QPointF(easting, northing));
+            }
+        }
+
+        chunk.records.append(record);
+        chunk.offsets.append(offset);
+    });
+
+    for (RowBitmap& rows : chunk.categoryRows) {
+        rows.resize(chunk.records.size());
+    }
+}
+
+// Day of a "yyyy-MM-ddThh:mm:ss" timestamp, read without building a QDateTime
+QDate sampleDay(const QString& timestamp)
+{
+    const QStringView view(timestamp);
+    if (view.size() < 10 || view[4] != '-' || view[7] != '-') {
+        return QDate();
+    }
+
+    bool yearOk, monthOk, dayOk;
+    const int year = view.mid(0, 4).toInt(&yearOk);
+    const int month = view.mid(5, 2).toInt(&monthOk);
+    const int day = view.mid(8, 2).toInt(&dayOk);
+    return yearOk && monthOk && dayOk ? QDate(year, month, day) : QDate();
+}
+
+// Fill in WGS84 positions for every located site
+void locateSites(QVector<SamplingPoint>& sites)
+{
+    // Convert every distinct site in one batch rather than per marker at render time
+    QVector<int> located;
+    QVector<double> eastings, northings;
+    for (int site = 0; site < sites.size(); ++site) {
+        if (sites[site].hasLocation) {
+            located.append(site);
+            eastings.append(sites[site].easting);
+            northings.append(sites[site].northing);
+        }
+    }
+
+    QVector<double> latitudes(located.size()), longitudes(located.size());
+    osgbToWgs84(eastings.constData(), northings.constData(), latitudes.data(), longitudes.data(), located.size());
+
+    for (int i = 0; i < located.size(); ++i) {
+        sites[located[i]].latitude = latitudes[i];
+        sites[located[i]].longitude = longitudes[i];
+    }
+}
+
+// Classify one record and add it to the cube and its site's counts
+void summariseRecord(const WaterRecord& record, TrendCube& cube, QVector<SamplingPoint>& sites)
+{
+    // Same minimum row width the pages require
+    if (record.columnCount < 12) {
+        return;
+    }
+
+    bool numeric = false;
+    double value = 0.0;
+    bool exceedance = false;
+    bool compliant = false;
+    bool classified = false;
+
+    static const QList<PollutantCategory> categories = allCategories();
+    if (const quint8 mask = rowCategories(record.categories, record.columnCount)) {
+        for (PollutantCategory category : categories) {
+            if (mask & categoryBit(category)) {
+                const Classification classification = classifyRecord(category, record);
+                numeric = classification.numeric;
+                value = classification.value;
+                exceedance = isExceedance(classification.status);
+                compliant = classification.status == "Compliant";
+                classified = true;
+                break;
+            }
+        }
+    }
+
+    SamplingPoint& point = sites[record.samplingPointId];
+    if (record.columnCount >= 14) {
+        point.flaggedSamples++;
+        point.flaggedCompliant += record.complianceFlag.compare("true", Qt::CaseInsensitive) == 0 ? 1 : 0;
+    }
+    if (classified) {
+        point.classified++;
+        point.exceedances += exceedance ? 1 : 0;
+        // The dashboard counts the row under every category of its determinand
+        for (PollutantCategory category : categories) {
+            if (record.categories & categoryBit(category)) {
+                point.categoryClassified[static_cast<int>(category)]++;
+                point.categoryCompliant[static_cast<int>(category)] += compliant ? 1 : 0;
+            }
+        }
+    } else {
+        value = record.result.startsWith("<") ? record.result.mid(1).toDouble(&numeric)
+                                              : record.result.toDouble(&numeric);
+    }
+
+    const QDate day = sampleDay(record.date);
+    if (day.isValid()) {
+        cube.add(record.determinandId, record.samplingPointId, day, numeric, value, exceedance);
+        cube.add(record.determinandId, TrendCube::ALL_SITES, day, numeric, value, exceedance);
+    }
+}
+
+}
+
+WaterDataset::WaterDataset() : categoryRowSets(POLLUTANT_CATEGORY_COUNT)
+{
+}
+
+WaterDataset::~WaterDataset()
+{
+    clear();
+}
+
+bool WaterDataset::load(const QString& filePath, TaskScheduler* scheduler)
+{
+    TraceScope trace("WaterDataset::load");
+
+    clear();
+    if (compressionOf(filePath) != Compression::None) {
+        return loadCompressed(filePath, scheduler);
+    }
+
+    file.setFileName(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Unable to open file:" << filePath;
+        return false;
+    }
+    if (!mapFile()) {
+        qWarning() << "Unable to map file:" << filePath;
+        clear();
+        return false;
+    }
+    path = filePath;
+
+    const char* data = reinterpret_cast<const char*>(mapped);
+    const char* headerEnd = mappedSize > 0 ? static_cast<const char*>(std::memchr(data, '\n', mappedSize)) : nullptr;
+    if (!headerEnd) {
+        return true; // No rows yet; appendNewRows() reads the header once it is complete
+    }
+
+    // A last line without its newline may still be being written; it is
+    // left past parsedEnd for appendNewRows() to read once it is complete
+    const qint64 begin = headerEnd - data + 1;
+    qint64 end = mappedSize;
+    while (end > begin && data[end - 1] != '\n') {
+        end--;
+    }
+    if (end == begin) {
+        parsedEnd = begin;
+        return true;
+    }
+    parseRows(data, begin, end, 0, scheduler);
+
+    // Trend and spatial indexes are left to IndexScheduler so the table can show first
+    return true;
+}
+
+bool WaterDataset::loadCompressed(const QString& filePath, TaskScheduler* scheduler)
+{
+    DecompressionStream stream(filePath);
+    if (!stream.start()) {
+        qWarning() << "Unable to open file:" << filePath;
+        return false;
+    }
+    path = filePath;
+    compressedSize = QFileInfo(filePath).size();
+
+    // Blocks hold whole lines, so each is parsed while the next is decompressed
+    DecompressedBlock block;
+    bool isHeader = true;
+    while (stream.next(block)) {
+        const char* data = block.bytes.constData();
+        qint64 begin = 0;
+        if (isHeader) {
+            const char* headerEnd = static_cast<const char*>(std::memchr(data, '\n', block.bytes.size()));
+            if (!headerEnd) {
+                continue;
+            }
+            begin = headerEnd - data + 1;
+            isHeader = false;
+        }
+        parseRows(data, begin, block.bytes.size(), block.offset, scheduler);
+    }
+
+    if (!stream.succeeded()) {
+        qWarning() << "Unable to decompress file:" << filePath;
+        clear();
+        return false;
+    }
+    checkpoints = stream.checkpoints();
+    return true;
+}
+
+int WaterDataset::appendNewRows(TaskScheduler* scheduler)
+{
+    TraceScope trace("WaterDataset::appendNewRows");
+
+    // Compressed files cannot be resumed part way, so any change means a reload
+    if (compressedSize >= 0) {
+        return QFileInfo(path).size() == compressedSize ? 0 : -1;
+    }
+    if (!file.isOpen()) {
+        return -1;
+    }
+    const qint64 size = file.size();
+    if (size < mappedSize) {
+        return -1; // Truncated or rewritten, so earlier rows may have changed
+    }
+    if (size == mappedSize) {
+        return 0;
+    }
+
+    if (mapped) {
+        file.unmap(mapped);
+        mapped = nullptr;
+    }
+    if (!mapFile()) {
+        qWarning() << "Unable to map file:" << path;
+        return -1;
+    }
+
+    // Only whole lines are parsed; a line still being written waits for the next call
+    const char* data = reinterpret_cast<const char*>(mapped);
+    qint64 begin = parsedEnd;
+    if (begin == 0) {
+        const char* headerEnd = static_cast<const char*>(std::memchr(data, '\n', mappedSize));
+        if (!headerEnd) {
+            return 0;
+        }
+        begin = headerEnd - data + 1;
+    }
+    qint64 end = mappedSize;
+    while (end > begin && data[end - 1] != '\n') {
+        end--;
+    }
+    if (end == begin) {
+        parsedEnd = begin;
+        return 0;
+    }
+
+    const int first = rows.size();
+    const qsizetype siteCount = sites.size();
+    const QVector<quint32> previousRanks = siteRanks;
+    auto locatedCount = [this]() {
+        return std::count_if(sites.cbegin(), sites.cend(), [](const SamplingPoint& site) {
+            return site.hasLocation;
+        });
+    };
+    const qsizetype located = locatedCount();
+
+    parseRows(data, begin, end, 0, scheduler);
+
+    // Existing sites keep their relative order, so each old rank maps to one new rank
+    rankMoves.resize(previousRanks.size());
+    for (int site = 0; site < previousRanks.size(); ++site) {
+        rankMoves[previousRanks[site]] = siteRanks[site];
+    }
+
+    if (summariesReady && searchReady && siteDateReady) {
+        // Fold only the new rows into the installed indexes; finalize sorts
+        // just the trend cells they added days to out of order
+        TraceScope extendTrace("WaterDataset::extendIndexes");
+        search.append(rows, first);
+        siteDates.append(rows, first);
+        for (int row = first; row < rows.size(); ++row) {
+            summariseRecord(rows[row], cube, sites);
+        }
+        cube.finalize();
+
+        // New or newly located sites need the spatial index built again,
+        // which the caller schedules in the background
+        if (sites.size() > siteCount || locatedCount() > located) {
+            spatialReady = false;
+        }
+    } else {
+        // A build still running covers only the earlier rows; drop it so the
+        // caller can start one over every row
+        loadGeneration++;
+        summariesReady = false;
+        spatialReady = false;
+        searchReady = false;
+        siteDateReady = false;
+    }
+
+    return rows.size() - first;
+}
+
+bool WaterDataset::mapFile()
+{
+    mappedSize = file.size();
+    if (mappedSize > 0) {
+        mapped = file.map(0, mappedSize);
+        if (!mapped) {
+            mappedSize = 0;
+            return false;
+        }
+    }
+    return true;
+}
+
+void WaterDataset::parseRows(const char* data, qint64 begin, qint64 end, qint64 baseOffset, TaskScheduler* scheduler)
+{
+    // Parse line-aligned slices of the rows in parallel, then intern them in
+    // file order so ids and locations match a sequential read
+    qint64 chunkCount = 1;
+    if (scheduler) {
+        chunkCount = qBound<qint64>(1, (end - begin) / MIN_CHUNK_BYTES,
+                                    scheduler->workerCount() * CHUNKS_PER_WORKER);
+    }
+    const QVector<qint64> bounds = chunkBounds(data, begin, end, int(chunkCount));
+    QVector<ParsedChunk> chunks(bounds.size() - 1);
+
+    auto parse = [&](int chunk) {
+        parseChunk(data, bounds[chunk], bounds[chunk + 1], baseOffset, chunks[chunk]);
+    };
+    if (scheduler) {
+        scheduler->parallelFor(TaskPriority::Ingest, chunks.size(), parse);
+    } else {
+        for (int chunk = 0; chunk < chunks.size(); ++chunk) {
+            parse(chunk);
+        }
+    }
+
+    TraceScope internTrace("WaterDataset::intern");
+    qsizetype total = rows.size();
+    for (const ParsedChunk& chunk : chunks) {
+        total += chunk.records.size();
+    }
+    rows.reserve(total);
+
+    for (ParsedChunk& chunk : chunks) {
+        QVector<int> determinandIds(chunk.determinands.size());
+        for (int id = 0; id < determinandIds.size(); ++id) {
+            determinandIds[id] = determinandTable.merge(chunk.determinands, id);
+        }
+
+        for (int i = 0; i < chunk.records.size(); ++i) {
+            WaterRecord& record = chunk.records[i];
+            record.determinandId = determinandIds[record.determinandId];
+            record.determinand = determinandTable.label(record.determinandId);
+            SamplingPoint& point = internRecord(record);
+
+            // Sites take the first grid reference found in file order
+            if (!point.hasLocation) {
+                auto location = chunk.locations.constFind(record.samplingPoint);
+                if (location != chunk.locations.constEnd()) {
+                    point.easting = location.value().x();
+                    point.northing = location.value().y();
+                    point.hasLocation = true;
+                }
+            }
+
+            rows.append(std::move(record));
+            offsets.append(chunk.offsets[i]);
+        }
+        for (int category = 0; category < POLLUTANT_CATEGORY_COUNT; ++category) {
+            categoryRowSets[category].append(chunk.categoryRows[category]);
+        }
+        chunk = ParsedChunk(); // Release the slice as soon as it is merged
+    }
+    parsedEnd = baseOffset + end;
+
+    QStringList siteLabels;
+    siteLabels.reserve(sites.size());
+    for (const SamplingPoint& site : sites) {
+        siteLabels.append(site.label);
+    }
+    siteRanks = textRanks(siteLabels);
+}
+
+bool WaterDataset::readRecords(const QString& filePath,
+                               const std::function<void(const WaterRecord&)>& visit)
+{
+    QFile input(filePath);
+    if (!input.open(QIODevice::ReadOnly)) {
+        qWarning() << "Unable to open file:" << filePath;
+        return false;
+    }
+
+    CsvField fields[CSV_MAX_FIELDS];
+    bool isHeader = true;
+
+    auto visitLine = [&](QByteArrayView line, qint64) {
+        if (isHeader) {
+            isHeader = false;
+            return;
+        }
+        const int count = splitCsvLine(line, fields, CSV_MAX_FIELDS, RECORD_COLUMNS);
+        visit(recordFromFields(fields, count));
+    };
+    if (compressionOf(filePath) != Compression::None) {
+        if (!forEachDecompressedLine(filePath, visitLine)) {
+            qWarning() << "Unable to decompress file:" << filePath;
+            return false;
+        }
+        return true;
+    }
+
+    bool ok = forEachMappedLine(input, 0, visitLine);
+
+    if (!ok) {
+        qWarning() << "Unable to map file:" << filePath;
+    }
+    return ok;
+}
+
+void WaterDataset::clear()
+{
+    loadGeneration++;
+    summariesReady = false;
+    spatialReady = false;
+    searchReady = false;
+    siteDateReady = false;
+    if (mapped) {
+        file.unmap(mapped);
+        mapped = nullptr;
+    }
+    file.close();
+    mappedSize = 0;
+    parsedEnd = 0;
+    compressedSize = -1;
+    checkpoints.clear();
+    path.clear();
+    rows.clear();
+    offsets.clear();
+    sites.clear();
+    samplingPointIds.clear();
+    siteRanks.clear();
+    rankMoves.clear();
+    determinandTable.clear();
+    for (RowBitmap& rows : categoryRowSets) {
+        rows.clear();
+    }
+    cube.clear();
+    siteIndex.clear();
+    search.clear();
+    siteDates.clear();
+}
+
+SamplingPoint& WaterDataset::internRecord(WaterRecord& record)
+{
+    // Share one string per distinct label instead of a copy per row
+    auto site = samplingPointIds.constFind(record.samplingPoint);
+    if (site == samplingPointIds.constEnd()) {
+        site = samplingPointIds.insert(record.samplingPoint, sites.size());
+        SamplingPoint point;
+        point.label = record.samplingPoint;
+        sites.append(point);
+    }
+    record.samplingPointId = site.value();
+
+    SamplingPoint& point = sites[record.samplingPointId];
+    record.samplingPoint = point.label;
+    point.samples++;
+    return point;
+}
+
+WaterDataset::IndexInput WaterDataset::indexInput() const
+{
+    IndexInput input;
+    input.generation = loadGeneration;
+    input.records = rows;
+    input.sites = sites;
+    return input;
+}
+
+void WaterDataset::buildSummaries(const IndexInput& input, TrendCube& trends, QVector<SamplingPoint>& sites)
+{
+    TraceScope trace("WaterDataset::buildSummaries");
+
+    trends.clear();
+    sites = input.sites;
+
+    // Sites taken after an earlier build was installed already hold its counts
+    for (SamplingPoint& point : sites) {
+        point.classified = 0;
+        point.exceedances = 0;
+        point.flaggedSamples = 0;
+        point.flaggedCompliant = 0;
+        std::fill(std::begin(point.categoryClassified), std::end(point.categoryClassified), 0);
+        std::fill(std::begin(point.categoryCompliant), std::end(point.categoryCompliant), 0);
+    }
+
+    for (const WaterRecord& record : input.records) {
+        summariseRecord(record, trends, sites);
+    }
+    trends.finalize();
+    trends.squeeze();
+}
+
+void WaterDataset::buildSpatialIndex(QVector<SamplingPoint>& sites, SiteSpatialIndex& index)
+{
+    TraceScope trace("WaterDataset::buildSpatialIndex");
+
+    locateSites(sites);
+    index.build(sites);
+}
+
+void WaterDataset::buildSearchIndex(const IndexInput& input, SearchIndex& index)
+{
+    TraceScope trace("WaterDataset::buildSearchIndex");
+
+    index.clear();
+    index.append(input.records);
+}
+
+void WaterDataset::buildSiteDateIndex(const IndexInput& input, SiteDateIndex& index)
+{
+    TraceScope trace("WaterDataset::buildSiteDateIndex");
+
+    index.clear();
+    index.append(input.records);
+}
+
+bool WaterDataset::installSummaries(int forGeneration, const TrendCube& trends,
+                                    const QVector<SamplingPoint>& summarised)
+{
+    if (forGeneration != loadGeneration) {
+        return false;
+    }
+    cube = trends;
+    sites = summarised;
+    summariesReady = true;
+    return true;
+}
+
+void WaterDataset::categoryCompliance(PollutantCategory category, qint64* compliant, qint64* total) const
+{
+    *compliant = 0;
+    *total = 0;
+    if (!summariesReady) {
+        return;
+    }
+    for (const SamplingPoint& site : sites) {
+        *compliant += site.categoryCompliant[static_cast<int>(category)];
+        *total += site.categoryClassified[static_cast<int>(category)];
+    }
+}
+
+void WaterDataset::flagCompliance(qint64* compliant, qint64* total) const
+{
+    *compliant = 0;
+    *total = 0;
+    if (!summariesReady) {
+        return;
+    }
+    for (const SamplingPoint& site : sites) {
+        *compliant += site.flaggedCompliant;
+        *total += site.flaggedSamples;
+    }
+}
+
+int WaterDataset::requestSpatialIndex()
+{
+    spatialReady = false;
+    return ++spatialRequests;
+}
+
+bool WaterDataset::installSpatialIndex(int forGeneration, int forRequest, const QVector<SamplingPoint>& located,
+                                       const SiteSpatialIndex& index)
+{
+    if (forGeneration != loadGeneration || forRequest != spatialRequests) {
+        return false;
+    }
+
+    // Only the positions are taken; appends since the build may have
+    // updated the sites' counts
+    for (int site = 0; site < located.size() && site < sites.size(); ++site) {
+        sites[site].latitude = located[site].latitude;
+        sites[site].longitude = located[site].longitude;
+    }
+    siteIndex = index;
+    spatialReady = true;
+    return true;
+}
+
+bool WaterDataset::installSearchIndex(int forGeneration, const SearchIndex& index)
+{
+    if (forGeneration != loadGeneration) {
+        return false;
+    }
+    search = index;
+    searchReady = true;
+    return true;
+}
+
+bool WaterDataset::installSiteDateIndex(int forGeneration, const SiteDateIndex& index)
+{
+    if (forGeneration != loadGeneration) {
+        return false;
+    }
+    siteDates = index;
+    siteDateReady = true;
+    return true;
+}
+
+QStringList WaterDataset::rawRow(int row) const
+{
+    return rawLine(offsets.offset(row));
+}
+
+QStringList WaterDataset::header() const
+{
+    return rawLine(0);
+}
+
+QStringList WaterDataset::rawLine(qint64 offset) const
+{
+    if (compressedSize >= 0) {
+        QByteArray line;
+        return readDecompressedLine(path, offset, line, checkpoints) ? splitCsvColumns(line) : QStringList();
+    }
+    if (!mapped || offset < 0 || offset >= mappedSize) {
+        return QStringList();
+    }
+
+    const char* start = reinterpret_cast<const char*>(mapped) + offset;
+    const qint64 remaining = mappedSize - offset;
+    const char* newline = static_cast<const char*>(std::memchr(start, '\n', remaining));
+    qsizetype length = newline ? newline - start : remaining;
+    if (length > 0 && start[length - 1] == '\r') {
+        length--;
+    }
+
+    // Re-split the whole line now that every column is wanted
+    return splitCsvColumns(QByteArrayView(start, length));
+}
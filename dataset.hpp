@@ -0,0 +1,192 @@
+#pragma once
+
+#include <QFile>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <functional>
+#include "decompression.hpp"
+#include "determinands.hpp"
+#include "rowbitmap.hpp"
+#include "rowindex.hpp"
+#include "trendcube.hpp"
+#include "samplingpoint.hpp"
+#include "searchindex.hpp"
+#include "sitedateindex.hpp"
+#include "spatialindex.hpp"
+
+class TaskScheduler;
+enum class PollutantCategory;
+
+// One row of the Environment Agency water quality CSV, reduced to the
+// columns the pages actually read
+struct WaterRecord
+{
+    QString samplingPoint;  // Column 3: sampling point label
+    QString date;           // Column 4: sample date and time
+    QString determinand;    // Column 5: determinand label
+    QString definition;     // Column 6: determinand definition
+    QString result;         // Column 9: measured result
+    QString unit;           // Column 11: unit label
+    QString materialType;   // Column 12: sampled material (water) type
+    QString complianceFlag; // Column 13: compliance sample flag
+    int columnCount = 0;    // Number of fields found on the line
+    int samplingPointId = -1; // Index into WaterDataset::samplingPoints()
+    int determinandId = -1;   // Index into WaterDataset::determinands()
+    quint8 categories = 0;    // Categories of its determinand and definition; see rowCategories
+};
+
+// Parsed CSV shared by every page. The file is read once per load and each
+// page materialises its own view from these records when it is first shown.
+// Only the columns above stay resident; the file stays memory-mapped and a
+// row's remaining columns are re-parsed from it through the offset index.
+// gzip and zstd files (.csv.gz, .csv.zst) are decompressed as a stream
+// instead; their offsets count decompressed bytes and a raw row is found by
+// decompressing from the last checkpoint recorded before it.
+class WaterDataset
+{
+public:
+    WaterDataset();
+    ~WaterDataset();
+    WaterDataset(const WaterDataset&) = delete;
+    WaterDataset& operator=(const WaterDataset&) = delete;
+
+    // Parse the file, replacing any previously loaded records. With a
+    // scheduler, slices of the file are split into records in parallel.
+    bool load(const QString& filePath, TaskScheduler* scheduler = nullptr);
+    void clear();
+
+    // Parse whole lines appended to the file since the last load or append,
+    // adding their records after the existing ones; ids, category rows and
+    // site ranks are extended in place. Installed summaries, search and
+    // site/date indexes take just the new rows; builds still running are
+    // dropped by advancing the generation, and hasSummaries() and the other
+    // has*() queries are then false until the caller starts them again.
+    // Rows that add or locate a site leave hasSpatialIndex() false for the
+    // caller to rebuild it. Returns the number of rows added, or -1 if the
+    // file shrank and has to be loaded again.
+    int appendNewRows(TaskScheduler* scheduler = nullptr);
+
+    const QVector<WaterRecord>& records() const { return rows; }
+    const QString& filePath() const { return path; }
+
+    // Every column of a record, or the header names, read back from the file
+    QStringList rawRow(int row) const;
+    QStringList header() const;
+    const RowOffsetIndex& rowOffsets() const { return offsets; }
+
+    // Distinct sampling points and determinand labels, indexed by the ids on each record
+    const QVector<SamplingPoint>& samplingPoints() const { return sites; }
+    const QStringList& determinands() const { return determinandTable.labels(); }
+    int samplingPointIndex(const QString& label) const { return samplingPointIds.value(label, -1); }
+    // Text-order rank of each sampling point id, for ordering rows by site with integer keys
+    const QVector<quint32>& samplingPointRanks() const { return siteRanks; }
+    // New rank of each rank held before the last append, as new sites shift them
+    const QVector<quint32>& samplingPointRankMoves() const { return rankMoves; }
+    int determinandIndex(const QString& label) const { return determinandTable.indexOf(label); }
+
+    // Categories of any definition of a determinand id; a row's own come
+    // from rowCategories(record.categories, record.columnCount)
+    quint8 determinandCategories(int id) const { return determinandTable.categories(id); }
+
+    // Rows matching each category's filter, marked while the file is parsed
+    // so pages visit their rows without testing every record
+    const RowBitmap& categoryRows(PollutantCategory category) const
+    {
+        return categoryRowSets[static_cast<int>(category)];
+    }
+
+    // Load counter, used to drop background index results for a replaced file
+    int generation() const { return loadGeneration; }
+
+    // Daily per-site statistics and per-site exceedance counts, for trend
+    // charts. Built in the background after load; empty until hasSummaries().
+    const TrendCube& trends() const { return cube; }
+    bool hasSummaries() const { return summariesReady; }
+
+    // Totals behind the dashboard cards, summed over the summarised sites;
+    // zero until hasSummaries()
+    void categoryCompliance(PollutantCategory category, qint64* compliant, qint64* total) const;
+    void flagCompliance(qint64* compliant, qint64* total) const;
+
+    // Located sampling points by grid position, for map and proximity
+    // queries. Built after the summaries; empty until hasSpatialIndex().
+    const SiteSpatialIndex& spatialIndex() const { return siteIndex; }
+    bool hasSpatialIndex() const { return spatialReady; }
+
+    // Distinct-value search over the record columns pages show unchanged,
+    // for the search boxes. Built after load; empty until hasSearchIndex().
+    const SearchIndex& searchIndex() const { return search; }
+    bool hasSearchIndex() const { return searchReady; }
+
+    // Rows of one sampling point's sample at a date, in file order, for the
+    // per-sample charts. Empty until hasSiteDateIndex().
+    QVector<int> sampleRows(int site, const QString& date) const { return siteDates.rows(rows, site, date); }
+    bool hasSiteDateIndex() const { return siteDateReady; }
+
+    // Everything the background builds read, taken on the GUI thread. The
+    // vectors are implicitly shared, so a later load cannot free them mid-build.
+    struct IndexInput
+    {
+        int generation = 0;
+        QVector<WaterRecord> records;
+        QVector<SamplingPoint> sites;
+    };
+    IndexInput indexInput() const;
+
+    // Builders run on worker threads; they touch nothing but their arguments
+    static void buildSummaries(const IndexInput& input, TrendCube& trends, QVector<SamplingPoint>& sites);
+    static void buildSpatialIndex(QVector<SamplingPoint>& sites, SiteSpatialIndex& index);
+    static void buildSearchIndex(const IndexInput& input, SearchIndex& index);
+    static void buildSiteDateIndex(const IndexInput& input, SiteDateIndex& index);
+
+    // Publish finished builds on the GUI thread; false if the file has since been replaced
+    bool installSummaries(int forGeneration, const TrendCube& trends, const QVector<SamplingPoint>& summarised);
+    bool installSpatialIndex(int forGeneration, int forRequest, const QVector<SamplingPoint>& located,
+                             const SiteSpatialIndex& index);
+    bool installSearchIndex(int forGeneration, const SearchIndex& index);
+    bool installSiteDateIndex(int forGeneration, const SiteDateIndex& index);
+
+    // Mark the spatial index out of date for a build about to start; only
+    // the build of the latest request is installed
+    int requestSpatialIndex();
+
+    // Stream the file's records one at a time without keeping them, so
+    // callers such as the headless report stay within bounded memory
+    static bool readRecords(const QString& filePath,
+                            const std::function<void(const WaterRecord&)>& visit);
+
+private:
+    QStringList rawLine(qint64 offset) const;
+    bool loadCompressed(const QString& filePath, TaskScheduler* scheduler);
+    bool mapFile();
+    void parseRows(const char* data, qint64 begin, qint64 end, qint64 baseOffset, TaskScheduler* scheduler);
+    SamplingPoint& internRecord(WaterRecord& record);
+
+    QString path;
+    QVector<WaterRecord> rows;
+    RowOffsetIndex offsets;   // Byte offset of each record's line
+    QVector<SamplingPoint> sites;
+    QHash<QString, int> samplingPointIds;
+    QVector<quint32> siteRanks;
+    QVector<quint32> rankMoves;
+    DeterminandDimension determinandTable;
+    QVector<RowBitmap> categoryRowSets;    // Indexed by PollutantCategory
+    TrendCube cube;
+    SiteSpatialIndex siteIndex;
+    SearchIndex search;
+    SiteDateIndex siteDates;
+    int loadGeneration = 0;
+    bool summariesReady = false;
+    bool spatialReady = false;
+    bool searchReady = false;
+    bool siteDateReady = false;
+    int spatialRequests = 0;  // Spatial builds started, so an overtaken one is dropped
+    QFile file;               // Kept open while mapped
+    uchar* mapped = nullptr;
+    qint64 mappedSize = 0;
+    qint64 parsedEnd = 0;     // Offset just past the last line parsed
+    qint64 compressedSize = -1; // Size of a compressed file, which is not mapped; -1 otherwise
+    DecompressionCheckpoints checkpoints; // Where reads of a compressed file's raw rows resume
+};
@@ -0,0 +1,377 @@
+#include "decompression.hpp"
+#include "tracing.hpp"
+#include <QDebug>
+#include <QThread>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <utility>
+
+#ifdef WATERTOOL_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef WATERTOOL_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+
+// Compressed bytes read from the file per call
+const qint64 INPUT_BYTES = 1024 * 1024;
+
+// Decompressor output, collected into a block and handed over a block of
+// whole lines at a time; the partial line after the last newline moves to
+// the front of the next block
+class BlockBuffer
+{
+public:
+    BlockBuffer(std::function<bool(QByteArray, qint64)> hand, qint64 offset)
+        : hand(std::move(hand)), block(DecompressionStream::BLOCK_BYTES, Qt::Uninitialized), offset(offset)
+    {
+    }
+
+    char* space() { return block.data() + filled; }
+    qint64 spaceSize() const { return block.size() - filled; }
+    void commit(qint64 bytes) { filled += bytes; }
+
+    // Hand over the block's whole lines once it is full; false once the reader has gone
+    bool flushIfFull()
+    {
+        if (filled < block.size()) {
+            return true;
+        }
+
+        qint64 cut = filled;
+        while (cut > 0 && block[cut - 1] != '\n') {
+            cut--;
+        }
+        if (cut == 0) {
+            block.resize(block.size() * 2); // A line longer than the block
+            return true;
+        }
+
+        QByteArray next(qMax(DecompressionStream::BLOCK_BYTES, block.size()), Qt::Uninitialized);
+        std::memcpy(next.data(), block.constData() + cut, filled - cut);
+        block.truncate(cut);
+        if (!hand(std::move(block), offset)) {
+            return false;
+        }
+        block = std::move(next);
+        offset += cut;
+        filled -= cut;
+        return true;
+    }
+
+    // Hand over whatever is left, including a last line without a newline
+    bool finish()
+    {
+        if (filled == 0) {
+            return true;
+        }
+        block.truncate(filled);
+        return hand(std::move(block), offset);
+    }
+
+private:
+    std::function<bool(QByteArray, qint64)> hand;
+    QByteArray block;
+    qint64 filled = 0;
+    qint64 offset = 0;  // Position of the block in the decompressed text
+};
+
+}
+
+Compression compressionOf(const QString& filePath)
+{
+    if (filePath.endsWith(".gz", Qt::CaseInsensitive)) {
+        return Compression::Gzip;
+    }
+    if (filePath.endsWith(".zst", Qt::CaseInsensitive)) {
+        return Compression::Zstd;
+    }
+    return Compression::None;
+}
+
+DecompressionStream::DecompressionStream(const QString& filePath, const DecompressionCheckpoint& from)
+    : path(filePath), compression(compressionOf(filePath)), from(from), file(filePath)
+{
+}
+
+DecompressionStream::~DecompressionStream()
+{
+    if (thread) {
+        {
+            QMutexLocker lock(&mutex);
+            stopping = true;
+            changed.wakeAll();
+        }
+        thread->wait();
+        delete thread;
+    }
+}
+
+bool DecompressionStream::start()
+{
+#ifndef WATERTOOL_HAVE_ZLIB
+    if (compression == Compression::Gzip) {
+        qWarning() << "gzip input is not supported by this build:" << path;
+        return false;
+    }
+#endif
+#ifndef WATERTOOL_HAVE_ZSTD
+    if (compression == Compression::Zstd) {
+        qWarning() << "zstd input is not supported by this build:" << path;
+        return false;
+    }
+#endif
+    if (compression == Compression::None || thread || !file.open(QIODevice::ReadOnly)
+        || !file.seek(from.compressedOffset)) {
+        return false;
+    }
+
+    thread = QThread::create([this]() { run(); });
+    thread->setObjectName("Decompression");
+    thread->start();
+    return true;
+}
+
+bool DecompressionStream::next(DecompressedBlock& block)
+{
+    QMutexLocker lock(&mutex);
+    while (queue.isEmpty() && !finished) {
+        changed.wait(&mutex);
+    }
+    if (queue.isEmpty()) {
+        return false;
+    }
+    block = queue.dequeue();
+    changed.wakeAll();
+    return true;
+}
+
+bool DecompressionStream::succeeded() const
+{
+    QMutexLocker lock(&mutex);
+    return finished && !failed;
+}
+
+DecompressionCheckpoints DecompressionStream::checkpoints() const
+{
+    QMutexLocker lock(&mutex);
+    return recorded;
+}
+
+void DecompressionStream::record(const DecompressionCheckpoint& checkpoint)
+{
+    QMutexLocker lock(&mutex);
+    recorded.append(checkpoint);
+}
+
+void DecompressionStream::run()
+{
+    TraceScope trace("DecompressionStream::run");
+
+    const bool ok = compression == Compression::Gzip ? inflateGzip() : decompressZstd();
+
+    QMutexLocker lock(&mutex);
+    finished = true;
+    failed = !ok;
+    changed.wakeAll();
+}
+
+bool DecompressionStream::hand(QByteArray bytes, qint64 offset)
+{
+    QMutexLocker lock(&mutex);
+    while (queue.size() >= QUEUE_BLOCKS && !stopping) {
+        changed.wait(&mutex);
+    }
+    if (stopping) {
+        return false;
+    }
+    queue.enqueue({std::move(bytes), offset});
+    changed.wakeAll();
+    return true;
+}
+
+bool DecompressionStream::inflateGzip()
+{
+#ifdef WATERTOOL_HAVE_ZLIB
+    z_stream stream = {};
+    if (from.state) {
+        // The copy points at the buffers of the stream it was taken from
+        if (inflateCopy(&stream, static_cast<z_stream*>(from.state.get())) != Z_OK) {
+            return false;
+        }
+        stream.next_in = nullptr;
+        stream.avail_in = 0;
+    } else if (inflateInit2(&stream, 15 + 32) != Z_OK) { // 32 added to the window bits accepts a gzip or zlib header
+        return false;
+    }
+
+    BlockBuffer output([this](QByteArray bytes, qint64 offset) { return hand(std::move(bytes), offset); }, from.offset);
+    QByteArray input(INPUT_BYTES, Qt::Uninitialized);
+    qint64 consumed = from.compressedOffset; // File bytes handed to zlib
+    qint64 produced = from.offset;
+    qint64 nextCheckpoint = from.offset + CHECKPOINT_BYTES;
+    int status = Z_OK;
+    bool outputFull = false;
+    bool ok = true;
+
+    for (;;) {
+        // Output left inside zlib is drained before more input is read
+        if (stream.avail_in == 0 && !outputFull) {
+            const qint64 read = file.read(input.data(), input.size());
+            if (read <= 0) {
+                ok = read == 0 && status == Z_STREAM_END;
+                break;
+            }
+            consumed += read;
+            stream.next_in = reinterpret_cast<Bytef*>(input.data());
+            stream.avail_in = uInt(read);
+            if (status == Z_STREAM_END) {
+                inflateReset(&stream); // Another gzip member follows
+            }
+        }
+
+        stream.next_out = reinterpret_cast<Bytef*>(output.space());
+        stream.avail_out = uInt(output.spaceSize());
+        status = inflate(&stream, Z_NO_FLUSH);
+        if (status != Z_OK && status != Z_STREAM_END && status != Z_BUF_ERROR) {
+            ok = false;
+            break;
+        }
+        const qint64 written = output.spaceSize() - stream.avail_out;
+        output.commit(written);
+        produced += written;
+        outputFull = stream.avail_out == 0;
+
+        // The whole inflate state is copied, including its window and any
+        // bits of input it holds, so a copy resumes exactly here
+        if (status == Z_OK && produced >= nextCheckpoint) {
+            std::shared_ptr<z_stream> state(new z_stream(), [](z_stream* copy) {
+                inflateEnd(copy);
+                delete copy;
+            });
+            if (inflateCopy(state.get(), &stream) == Z_OK) {
+                record({consumed - stream.avail_in, produced, state});
+            }
+            nextCheckpoint = produced + CHECKPOINT_BYTES;
+        }
+
+        if (status == Z_STREAM_END && stream.avail_in > 0) {
+            inflateReset(&stream);
+            status = Z_OK;
+        }
+        if (!output.flushIfFull()) {
+            break;
+        }
+    }
+
+    inflateEnd(&stream);
+    return ok && output.finish();
+#else
+    return false;
+#endif
+}
+
+bool DecompressionStream::decompressZstd()
+{
+#ifdef WATERTOOL_HAVE_ZSTD
+    ZSTD_DCtx* context = ZSTD_createDCtx();
+    if (!context) {
+        return false;
+    }
+
+    BlockBuffer output([this](QByteArray bytes, qint64 offset) { return hand(std::move(bytes), offset); }, from.offset);
+    QByteArray input(qint64(ZSTD_DStreamInSize()), Qt::Uninitialized);
+    size_t remaining = 0; // Non-zero while a frame is incomplete
+    qint64 consumed = from.compressedOffset; // File position of input[0]
+    qint64 produced = from.offset;
+    qint64 nextCheckpoint = from.offset + CHECKPOINT_BYTES;
+    bool ok = true;
+    bool stopped = false;
+
+    while (ok && !stopped) {
+        const qint64 read = file.read(input.data(), input.size());
+        if (read <= 0) {
+            ok = read == 0 && remaining == 0;
+            break;
+        }
+
+        // Output may still be held inside zstd once the input is used up
+        ZSTD_inBuffer in = {input.constData(), size_t(read), 0};
+        bool outputFull = false;
+        while (in.pos < in.size || outputFull) {
+            ZSTD_outBuffer out = {output.space(), size_t(output.spaceSize()), 0};
+            remaining = ZSTD_decompressStream(context, &out, &in);
+            if (ZSTD_isError(remaining)) {
+                ok = false;
+                break;
+            }
+            output.commit(qint64(out.pos));
+            produced += qint64(out.pos);
+            outputFull = out.pos == out.size;
+
+            // A frame decoded and flushed in full leaves the next frame's start to resume from
+            if (remaining == 0 && produced >= nextCheckpoint) {
+                record({consumed + qint64(in.pos), produced, nullptr});
+                nextCheckpoint = produced + CHECKPOINT_BYTES;
+            }
+
+            if (!output.flushIfFull()) {
+                stopped = true;
+                break;
+            }
+        }
+        consumed += read;
+    }
+
+    ZSTD_freeDCtx(context);
+    return ok && !stopped && output.finish();
+#else
+    return false;
+#endif
+}
+
+bool readDecompressedLine(const QString& filePath, qint64 offset, QByteArray& line,
+                          const DecompressionCheckpoints& checkpoints)
+{
+    if (offset < 0) {
+        return false;
+    }
+
+    DecompressionCheckpoint from;
+    auto after = std::upper_bound(checkpoints.cbegin(), checkpoints.cend(), offset,
+                                  [](qint64 offset, const DecompressionCheckpoint& checkpoint) {
+        return offset < checkpoint.offset;
+    });
+    if (after != checkpoints.cbegin()) {
+        from = *(after - 1);
+    }
+
+    DecompressionStream stream(filePath, from);
+    if (!stream.start()) {
+        return false;
+    }
+
+    // Blocks end on line boundaries, so the line lies within one block. A
+    // stream resumed from a checkpoint may start part way through a line,
+    // but never after the start of the line asked for.
+    DecompressedBlock block;
+    while (stream.next(block)) {
+        const qint64 position = offset - block.offset;
+        if (position < 0 || position >= block.bytes.size()) {
+            continue;
+        }
+
+        const char* start = block.bytes.constData() + position;
+        const char* newline = static_cast<const char*>(std::memchr(start, '\n', block.bytes.size() - position));
+        qsizetype length = newline ? newline - start : block.bytes.size() - position;
+        if (length > 0 && start[length - 1] == '\r') {
+            length--;
+        }
+        line = QByteArray(start, length);
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QMutex>
+#include <QQueue>
+#include <QString>
+#include <QVector>
+#include <QWaitCondition>
+#include <memory>
+#include "csvscan.hpp"
+
+class QThread;
+
+// Formats the loaders read besides plain CSV
+enum class Compression { None, Gzip, Zstd };
+
+// Compression of a file, by its extension (.gz or .zst)
+Compression compressionOf(const QString& filePath);
+
+// A run of decompressed text. Every block holds whole lines, except that
+// the last one may end in a line without a newline.
+struct DecompressedBlock
+{
+    QByteArray bytes;
+    qint64 offset = 0; // Position of the first byte in the decompressed text
+};
+
+// A point decompression can resume from part way through a file: a copy of
+// the inflate state for gzip, or the start of a frame for zstd
+struct DecompressionCheckpoint
+{
+    qint64 compressedOffset = 0; // Next byte of the file to read
+    qint64 offset = 0;           // Matching position in the decompressed text
+    std::shared_ptr<void> state; // Inflate state for gzip; null for zstd
+};
+
+// Checkpoints of one file, in increasing offset order
+using DecompressionCheckpoints = QVector<DecompressionCheckpoint>;
+
+// Decompresses a gzip or zstd file on its own thread into blocks of
+// BLOCK_BYTES, cut back to the last newline, and hands them over through a
+// queue of at most QUEUE_BLOCKS. The decompressor waits while the queue is
+// full, so parsing one block overlaps decompressing the next and memory
+// stays bounded whatever the file's size. gzip needs zlib and zstd needs
+// libzstd at build time; without them start() fails for that format.
+//
+// About every CHECKPOINT_BYTES of text a checkpoint is recorded, so a later
+// read of one line can resume near it rather than at the start. zstd can
+// only resume at a frame, so a file written as a single frame gets none.
+class DecompressionStream
+{
+public:
+    static const qint64 BLOCK_BYTES = 16 * 1024 * 1024;
+    static const int QUEUE_BLOCKS = 4;
+    static const qint64 CHECKPOINT_BYTES = 32 * 1024 * 1024;
+
+    // Decompress the file from its start, or from a checkpoint recorded by
+    // an earlier stream over the same file
+    explicit DecompressionStream(const QString& filePath,
+                                 const DecompressionCheckpoint& from = DecompressionCheckpoint());
+    ~DecompressionStream();
+    DecompressionStream(const DecompressionStream&) = delete;
+    DecompressionStream& operator=(const DecompressionStream&) = delete;
+
+    // Open the file and start decompressing; false if it cannot be opened
+    // or its format is not supported by this build
+    bool start();
+
+    // Wait for the next block; false once every block has been taken or
+    // decompression failed
+    bool next(DecompressedBlock& block);
+
+    // Whether the whole file decompressed cleanly, once next() has returned false
+    bool succeeded() const;
+
+    // Checkpoints recorded so far; all of them once next() has returned false
+    DecompressionCheckpoints checkpoints() const;
+
+private:
+    void run();
+    bool inflateGzip();
+    bool decompressZstd();
+    bool hand(QByteArray bytes, qint64 offset); // False once the reader has gone
+    void record(const DecompressionCheckpoint& checkpoint);
+
+    QString path;
+    Compression compression;
+    DecompressionCheckpoint from;
+    QFile file;
+    QThread* thread = nullptr;
+    mutable QMutex mutex;
+    QWaitCondition changed;         // Signalled on every push, pop and finish
+    QQueue<DecompressedBlock> queue;
+    bool finished = false;
+    bool failed = false;
+    bool stopping = false;          // Set when the reader stops early
+    DecompressionCheckpoints recorded;
+};
+
+// Visit every line of a compressed file as (line, offset in the decompressed
+// text), as forEachMappedLine does for plain files. Returns false if the file
+// could not be read to its end. checkpoints, when given, gets the file's
+// checkpoints for readDecompressedLine.
+template <typename Visit>
+bool forEachDecompressedLine(const QString& filePath, Visit&& visit,
+                             DecompressionCheckpoints* checkpoints = nullptr)
+{
+    DecompressionStream stream(filePath);
+    if (!stream.start()) {
+        return false;
+    }
+
+    DecompressedBlock block;
+    while (stream.next(block)) {
+        forEachLine(block.bytes.constData(), block.bytes.size(), block.offset, true, visit);
+    }
+    if (checkpoints) {
+        *checkpoints = stream.checkpoints();
+    }
+    return stream.succeeded();
+}
+
+// Read the line starting at offset in a compressed file's decompressed text,
+// without its line ending. Decompression resumes from the last of the
+// file's checkpoints before the line, or from the start without one.
+bool readDecompressedLine(const QString& filePath, qint64 offset, QByteArray& line,
+                          const DecompressionCheckpoints& checkpoints = DecompressionCheckpoints());
@@ -0,0 +1,66 @@
+#include "determinands.hpp"
+#include "dataset.hpp"
+
+DeterminandDimension::DeterminandDimension(const CategoryMatcher& matcher) : matcher(&matcher)
+{
+}
+
+void DeterminandDimension::clear()
+{
+    ids.clear();
+    pairs.clear();
+    names.clear();
+    masks.clear();
+}
+
+int DeterminandDimension::intern(QByteArrayView label, QByteArrayView definition, quint8* categories)
+{
+    pairKey.resize(0);
+    pairKey.append(label).append('\x1f').append(definition);
+    auto pair = pairs.constFind(pairKey);
+    if (pair == pairs.constEnd()) {
+        const quint8 mask = matcher->match(label, definition);
+
+        // Look up without copying; the key is only copied for a new label
+        auto found = ids.constFind(QByteArray::fromRawData(label.data(), label.size()));
+        int id;
+        if (found != ids.constEnd()) {
+            id = found.value();
+            masks[id] |= mask;
+        } else {
+            id = add(label.toByteArray(), QString::fromUtf8(label), mask);
+        }
+        pair = pairs.insert(pairKey, {id, mask});
+    }
+
+    if (categories) {
+        *categories = pair->categories;
+    }
+    return pair->id;
+}
+
+int DeterminandDimension::intern(const WaterRecord& record, quint8* categories)
+{
+    return intern(record.determinand.toUtf8(), record.definition.toUtf8(), categories);
+}
+
+int DeterminandDimension::merge(const DeterminandDimension& other, int id)
+{
+    const QString& name = other.label(id);
+    const QByteArray key = name.toUtf8();
+    auto found = ids.constFind(key);
+    if (found != ids.constEnd()) {
+        masks[found.value()] |= other.categories(id);
+        return found.value();
+    }
+    return add(key, name, other.categories(id));
+}
+
+int DeterminandDimension::add(const QByteArray& key, const QString& label, quint8 categories)
+{
+    const int id = names.size();
+    ids.insert(key, id);
+    names.append(label);
+    masks.append(categories);
+    return id;
+}
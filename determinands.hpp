@@ -0,0 +1,56 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+#include "categorymatcher.hpp"
+
+struct WaterRecord;
+
+// Distinct determinand labels, with categories worked out by the matcher
+// once per distinct (label, definition) pair rather than once per row.
+// Membership of POPs and Fluorinated is decided by the definition, and
+// one label can come with more than one, so a row's categories are
+// rowCategories() of the categories intern() gave for its own pair.
+class DeterminandDimension
+{
+public:
+    explicit DeterminandDimension(const CategoryMatcher& matcher = CategoryMatcher::standard());
+
+    void clear();
+
+    // Id of a label, adding it when new. categories, when given, gets the
+    // categories of the label with this definition.
+    int intern(QByteArrayView label, QByteArrayView definition, quint8* categories = nullptr);
+    int intern(const WaterRecord& record, quint8* categories = nullptr);
+
+    // Id here of entry id of another table, copied over when new; its categories are added to ours
+    int merge(const DeterminandDimension& other, int id);
+
+    int indexOf(const QString& label) const { return ids.value(label.toUtf8(), -1); }
+    int size() const { return names.size(); }
+
+    const QString& label(int id) const { return names.at(id); }
+    const QStringList& labels() const { return names; }
+
+    // Categories of any definition seen with the label
+    quint8 categories(int id) const { return masks.at(id); }
+    const QVector<quint8>& categoryMasks() const { return masks; }
+
+private:
+    struct Pair
+    {
+        int id;
+        quint8 categories;
+    };
+
+    int add(const QByteArray& key, const QString& label, quint8 categories);
+
+    const CategoryMatcher* matcher;
+    QHash<QByteArray, int> ids;  // UTF-8 label to id
+    QHash<QByteArray, Pair> pairs; // UTF-8 label, unit separator and definition to its id and categories
+    QByteArray pairKey;          // Lookup buffer, reused so a known pair costs no allocation
+    QStringList names;
+    QVector<quint8> masks;       // Categories of any definition of each id
+};
@@ -1,6 +1,6 @@
 #include "envlitter.hpp"
-#include <QFile>
-#include <QTextStream>
+#include "categories.hpp"
+#include "tracedchartview.hpp"
 #include <QHeaderView>
 #include <QDateTime>
 #include <QtCharts/QBarSeries>
@@ -27,6 +27,7 @@ EnvironmentalLitterIndicatorsPage::EnvironmentalLitterIndicatorsPage(QWidget* pa
     connect(backButton, &QPushButton::clicked, this, &EnvironmentalLitterIndicatorsPage::navigateToDashboard);
 
     searchBox = new QLineEdit(this);
+    searchBox->setObjectName("searchBox");
     searchBox->setPlaceholderText("Search for litter or water types...");
     connect(searchBox, &QLineEdit::textChanged, this, &EnvironmentalLitterIndicatorsPage::filterTableData);
 
@@ -38,12 +39,27 @@ EnvironmentalLitterIndicatorsPage::EnvironmentalLitterIndicatorsPage(QWidget* pa
     tableView->setItemDelegateForColumn(5, new ComplianceDelegate(this));
 
     litterDateDropdown = new QComboBox(this);
+    litterDateDropdown->setObjectName("litterDateDropdown");
     connect(litterDateDropdown, &QComboBox::currentTextChanged, this, &EnvironmentalLitterIndicatorsPage::displayTablesForSelection);
 
+    // Per-sample bars, or means rolled up from the selection's trend cube
+    granularityDropdown = new QComboBox(this);
+    granularityDropdown->setObjectName("granularityDropdown");
+    granularityDropdown->addItem("Each Sample");
+    granularityDropdown->addItem("Daily Mean", static_cast<int>(TimeGranularity::Day));
+    granularityDropdown->addItem("Weekly Mean", static_cast<int>(TimeGranularity::Week));
+    granularityDropdown->addItem("Monthly Mean", static_cast<int>(TimeGranularity::Month));
+    connect(granularityDropdown, &QComboBox::currentIndexChanged, this, [this]() {
+        if (litterDateDropdown->count() > 0) {
+            displayTablesForSelection(litterDateDropdown->currentText());
+        }
+    });
+
     topLayout->addWidget(title);
     topLayout->addWidget(searchBox);
     topLayout->addWidget(tableView);
     topLayout->addWidget(litterDateDropdown);
+    topLayout->addWidget(granularityDropdown);
     topLayout->addWidget(backButton);
 
     scrollArea = new QScrollArea(this);
@@ -59,95 +75,70 @@ EnvironmentalLitterIndicatorsPage::EnvironmentalLitterIndicatorsPage(QWidget* pa
 
 }
 
-void EnvironmentalLitterIndicatorsPage::loadCsvFile(const QString& filePath)
+void EnvironmentalLitterIndicatorsPage::loadDataset(const WaterDataset& source)
 {
+    TraceScope trace("EnvironmentalLitterIndicatorsPage::loadDataset");
+
     // Clear existing data and dropdowns
     dataModel->clear();
     dataModel->setHorizontalHeaderLabels({"Location", "Date", "Litter Type", "Water Type", "Result", "Compliance"});
     dropdownGroups.clear();
+    selectionSeries.clear();
 
     // Reload data using the existing loadData function
-    loadData(filePath);
+    loadData(source);
 
     // Repopulate the dropdown menu
     populateDropdown();
 }
 
-void EnvironmentalLitterIndicatorsPage::loadData(const QString& filePath)
+void EnvironmentalLitterIndicatorsPage::loadData(const WaterDataset& dataset)
 {
-    QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        qWarning() << "Unable to open file:" << filePath;
-        return;
-    }
-
-    QTextStream in(&file);
-    bool isHeader = true;
-
-    while (!in.atEnd()) {
-        QString line = in.readLine();
-        if (isHeader) {
-            isHeader = false;
-            continue;
-        }
-
-        QStringList columns = parseCSVLine(line);
-        if (columns.size() >= 13) {
-            QString litterType = columns[5].trimmed();
-            QString waterType = columns[12].trimmed();
-
-            // Only process specific litter types
-            if (litterType == "BWP - O.L." || litterType == "BWP - A.F.") {
-                QString location = columns[3].trimmed();
-                QString date = columns[4].trimmed();
-                QString result = columns[9].trimmed();
-                QString compliance = result.toDouble() < 0.05 ? "Compliant" : "Non-Compliant";
-
-                QList<QStandardItem*> row = {
-                    new QStandardItem(location),
-                    new QStandardItem(date),
-                    new QStandardItem(litterType),
-                    new QStandardItem(waterType),
-                    new QStandardItem(result),
-                    new QStandardItem(compliance)
-                };
-                dataModel->appendRow(row);
-
-                QString key = litterType + " | " + waterType;
-                dropdownGroups[key].append(date);
-            }
+    TraceScope trace("EnvironmentalLitterIndicatorsPage::loadData");
+
+    // Only the specific litter types, as marked during parsing
+    const QVector<WaterRecord>& records = dataset.records();
+    dataset.categoryRows(PollutantCategory::EnvironmentalLitter).forEachSet([&](int index) {
+        const WaterRecord& record = records[index];
+
+        QString compliance = classifyRecord(PollutantCategory::EnvironmentalLitter, record).status;
+
+        QList<QStandardItem*> row = {
+            new QStandardItem(record.samplingPoint),
+            new QStandardItem(record.date),
+            new QStandardItem(record.determinand),
+            new QStandardItem(record.materialType),
+            new QStandardItem(record.result),
+            new QStandardItem(compliance)
+        };
+        dataModel->appendRow(row);
+
+        QString key = record.determinand + " | " + record.materialType;
+        dropdownGroups[key].append(record.date);
+
+        SelectionSeries& series = selectionSeries[key];
+        series.determinand = record.determinandId;
+        series.sites.insert(record.samplingPoint, record.samplingPointId);
+        bool ok;
+        const double result = record.result.toDouble(&ok);
+        if (ok) {
+            series.samples[record.samplingPoint][record.date] = result;
         }
-    }
-
-    file.close();
-}
-
-QStringList EnvironmentalLitterIndicatorsPage::parseCSVLine(const QString& line) const
-{
-    QStringList result;
-    QString currentField;
-    bool insideQuotes = false;
-
-    for (QChar ch : line) {
-        if (ch == '"') {
-            insideQuotes = !insideQuotes;
-        } else if (ch == ',' && !insideQuotes) {
-            result.append(currentField.trimmed());
-            currentField.clear();
-        } else {
-            currentField.append(ch);
+        const QDateTime date = QDateTime::fromString(record.date, "yyyy-MM-ddThh:mm:ss");
+        if (date.isValid()) {
+            series.trends.add(record.determinandId, record.samplingPointId, date.date(), ok, result, false);
         }
-    }
+    });
 
-    if (!currentField.isEmpty()) {
-        result.append(currentField.trimmed());
+    for (SelectionSeries& series : selectionSeries) {
+        series.trends.finalize();
     }
-
-    return result;
 }
 
 void EnvironmentalLitterIndicatorsPage::populateDropdown()
 {
+    TraceScope trace("EnvironmentalLitterIndicatorsPage::populateDropdown");
+
     litterDateDropdown->clear();
     for (auto it = dropdownGroups.begin(); it != dropdownGroups.end(); ++it) {
         litterDateDropdown->addItem(it.key());
@@ -160,6 +151,8 @@ void EnvironmentalLitterIndicatorsPage::populateDropdown()
 
 void EnvironmentalLitterIndicatorsPage::displayTablesForSelection(const QString& selection)
 {
+    TraceScope trace("EnvironmentalLitterIndicatorsPage::displayTablesForSelection");
+
     if (!dropdownGroups.contains(selection)) {
         qWarning() << "Invalid selection: " << selection;
         return;
@@ -174,71 +167,97 @@ void EnvironmentalLitterIndicatorsPage::displayTablesForSelection(const QString&
         delete item;
     }
 
-    QMap<QString, QMap<QString, double>> locationDataMap;
-
-    // Group data by location and date for the selected pollutant-water source
-    for (int i = 0; i < dataModel->rowCount(); ++i) {
-        QString litterTypeWaterType = dataModel->item(i, 2)->text() + " | " + dataModel->item(i, 3)->text();
-        if (litterTypeWaterType == selection) {
-            QString location = dataModel->item(i, 0)->text();
-            QString dateStr = dataModel->item(i, 1)->text();
-            QString resultStr = dataModel->item(i, 4)->text();
-
-            bool ok;
-            double result = resultStr.toDouble(&ok);
-            if (ok) {
-                locationDataMap[location][dateStr] = result;
-            }
-        }
+    if (granularityDropdown->currentIndex() > 0) {
+        displayTrendsForSelection(selection, static_cast<TimeGranularity>(granularityDropdown->currentData().toInt()));
+        return;
     }
 
+    // Results were grouped by location and date for each selection at load
+    const QMap<QString, QMap<QString, double>> locationDataMap = selectionSeries.value(selection).samples;
+
     // Create a bar chart for each location and add it to the scrollable layout
     for (auto it = locationDataMap.begin(); it != locationDataMap.end(); ++it) {
-        QString location = it.key();
-        QMap<QString, double> dateToResultMap = it.value();
-
-        QChart* chart = new QChart();
-        QBarSeries* series = new QBarSeries();
-
-        QBarSet* barSet = new QBarSet("Results");
         QStringList categories;
+        QList<qreal> values;
 
-        for (auto dateIt = dateToResultMap.begin(); dateIt != dateToResultMap.end(); ++dateIt) {
+        for (auto dateIt = it.value().begin(); dateIt != it.value().end(); ++dateIt) {
             QDateTime date = QDateTime::fromString(dateIt.key(), "yyyy-MM-ddThh:mm:ss");
             categories.append(date.toString("MM:dd"));
-            barSet->append(dateIt.value());
+            values.append(dateIt.value());
         }
 
-        series->append(barSet);
-        chart->addSeries(series);
-
-        // Configure X-axis
-        QBarCategoryAxis* xAxis = new QBarCategoryAxis();
-        xAxis->append(categories);
-        xAxis->setTitleText("Date (MM:dd)");
-        chart->addAxis(xAxis, Qt::AlignBottom);
-        series->attachAxis(xAxis);
-
-        // Configure Y-axis
-        QValueAxis* yAxis = new QValueAxis();
-        yAxis->setTitleText("Result");
-        yAxis->setRange(0, 3.0);
-        chart->addAxis(yAxis, Qt::AlignLeft);
-        series->attachAxis(yAxis);
-
-        chart->setTitle("Location: " + location);
-
-        // Add chart to the scrollable area
-        QChartView* locationChartView = new QChartView(chart, this);
-        locationChartView->setRenderHint(QPainter::Antialiasing);
-        locationChartView->setMinimumSize(800, 600); 
-        scrollAreaLayout->addWidget(locationChartView);
+        addLocationChart(it.key(), categories, values, "Date (MM:dd)");
     }
 }
 
+void EnvironmentalLitterIndicatorsPage::displayTrendsForSelection(const QString& selection, TimeGranularity granularity)
+{
+    TraceScope trace("EnvironmentalLitterIndicatorsPage::displayTrendsForSelection");
+
+    // The selection's own cube holds just its water type's rows
+    const SelectionSeries series = selectionSeries.value(selection);
+
+    QString format = granularity == TimeGranularity::Month ? "yyyy-MM" : "MM:dd";
+    QString axisTitle = granularity == TimeGranularity::Day ? "Date (MM:dd)"
+                      : granularity == TimeGranularity::Week ? "Week Starting (MM:dd)"
+                                                             : "Month (yyyy-MM)";
+
+    for (auto it = series.sites.begin(); it != series.sites.end(); ++it) {
+        QStringList categories;
+        QList<qreal> values;
+
+        for (const TrendBucket& bucket : series.trends.series(series.determinand, it.value(), granularity)) {
+            if (bucket.valueCount == 0) continue;
+            categories.append(bucket.start.toString(format));
+            values.append(bucket.mean());
+        }
+
+        if (!values.isEmpty()) {
+            addLocationChart(it.key(), categories, values, axisTitle);
+        }
+    }
+}
+
+void EnvironmentalLitterIndicatorsPage::addLocationChart(const QString& location, const QStringList& categories,
+                                                         const QList<qreal>& values, const QString& axisTitle)
+{
+    QChart* chart = new QChart();
+    QBarSeries* series = new QBarSeries();
+
+    QBarSet* barSet = new QBarSet("Results");
+    barSet->append(values);
+
+    series->append(barSet);
+    chart->addSeries(series);
+
+    // Configure X-axis
+    QBarCategoryAxis* xAxis = new QBarCategoryAxis();
+    xAxis->append(categories);
+    xAxis->setTitleText(axisTitle);
+    chart->addAxis(xAxis, Qt::AlignBottom);
+    series->attachAxis(xAxis);
+
+    // Configure Y-axis
+    QValueAxis* yAxis = new QValueAxis();
+    yAxis->setTitleText("Result");
+    yAxis->setRange(0, 3.0);
+    chart->addAxis(yAxis, Qt::AlignLeft);
+    series->attachAxis(yAxis);
+
+    chart->setTitle("Location: " + location);
+
+    // Add chart to the scrollable area
+    QChartView* locationChartView = new TracedChartView(chart, this);
+    locationChartView->setRenderHint(QPainter::Antialiasing);
+    locationChartView->setMinimumSize(800, 600); 
+    scrollAreaLayout->addWidget(locationChartView);
+}
+
 
 void EnvironmentalLitterIndicatorsPage::updateChartForLocation(QStandardItemModel* locationModel)
 {
+    TraceScope trace("EnvironmentalLitterIndicatorsPage::updateChartForLocation");
+
     QChart* chart = new QChart();
     QLineSeries* series = new QLineSeries();
 
@@ -279,7 +298,7 @@ void EnvironmentalLitterIndicatorsPage::updateChartForLocation(QStandardItemMode
     chart->setTitle("Trend for Selected Location");
 
     // Dynamically add the chart to the scroll area
-    QChartView* dynamicChartView = new QChartView(chart, this);
+    QChartView* dynamicChartView = new TracedChartView(chart, this);
     dynamicChartView->setRenderHint(QPainter::Antialiasing);
     scrollAreaLayout->addWidget(dynamicChartView);
 }
@@ -298,6 +317,8 @@ void EnvironmentalLitterIndicatorsPage::clearLocationSpecificCharts()
 
 void EnvironmentalLitterIndicatorsPage::filterTableData(const QString& text)
 {
+    TraceScope trace("EnvironmentalLitterIndicatorsPage::filterTableData");
+
     for (int i = 0; i < dataModel->rowCount(); ++i) {
         bool matches = false;
         for (int j = 0; j < dataModel->columnCount(); ++j) {
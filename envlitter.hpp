@@ -19,6 +19,7 @@
 #include <QPainter>
 #include <QDateTime>
 #include <QMap>
+#include "dataset.hpp"
 
 // EnvironmentalLitterIndicatorsPage class definition
 class EnvironmentalLitterIndicatorsPage : public QWidget
@@ -29,8 +30,8 @@ public:
     // Constructor
     explicit EnvironmentalLitterIndicatorsPage(QWidget* parent = nullptr);
 
-    // New method to provide a CSV file to the page
-    void loadCsvFile(const QString& filePath);
+    // Materialise the page from the shared parsed dataset
+    void loadDataset(const WaterDataset& dataset);
 
 signals:
     // Signal to navigate back to the dashboard
@@ -48,16 +49,31 @@ private:
     QLineEdit* searchBox;                
     QStandardItemModel* dataModel;     
     QComboBox* litterDateDropdown;         
+    QComboBox* granularityDropdown;
 
     QMap<QString, QStringList> dropdownGroups; // Maps for dropdown data
 
+    // Chart data of each dropdown entry, gathered from its rows at load so
+    // a selection never rescans the table. The dataset's trend cube is
+    // keyed by determinand and site only and would mix water types, so each
+    // entry keeps its own cube, keyed by site.
+    struct SelectionSeries {
+        int determinand = -1;
+        QMap<QString, int> sites;                    // Sampling point ids by label
+        QMap<QString, QMap<QString, double>> samples; // Result by location, then sample time
+        TrendCube trends;
+    };
+    QMap<QString, SelectionSeries> selectionSeries;
+
     // Methods
-    void loadData(const QString& filePath);                       
+    void loadData(const WaterDataset& dataset);                       
     void populateDropdown();                                       
     void displayTablesForSelection(const QString& selection);     
+    void displayTrendsForSelection(const QString& selection, TimeGranularity granularity);
+    void addLocationChart(const QString& location, const QStringList& categories,
+                          const QList<qreal>& values, const QString& axisTitle);
     void updateChartForLocation(QStandardItemModel* locationModel); 
     void clearLocationSpecificCharts();                          
-    QStringList parseCSVLine(const QString& line) const;         
 
     // Inner class for compliance delegate
     class ComplianceDelegate : public QStyledItemDelegate {
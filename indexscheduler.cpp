@@ -0,0 +1,82 @@
+#include "indexscheduler.hpp"
+
+namespace {
+
+// Results carried from a worker back to the GUI thread
+struct SummaryBuild
+{
+    TrendCube trends;
+    QVector<SamplingPoint> sites;
+};
+
+struct SpatialBuild
+{
+    QVector<SamplingPoint> sites;
+    SiteSpatialIndex index;
+};
+
+}
+
+IndexScheduler::IndexScheduler(WaterDataset& dataset, TaskScheduler& scheduler, QObject* parent)
+    : QObject(parent), dataset(dataset), scheduler(scheduler)
+{
+}
+
+void IndexScheduler::start()
+{
+    const WaterDataset::IndexInput input = dataset.indexInput();
+    const int generation = input.generation;
+
+    scheduler.deliver(TaskPriority::Background, this, [input]() {
+        SummaryBuild build;
+        WaterDataset::buildSummaries(input, build.trends, build.sites);
+        return build;
+    }, [this, generation](const SummaryBuild& build) {
+        if (!dataset.installSummaries(generation, build.trends, build.sites)) {
+            return; // A newer file was loaded meanwhile
+        }
+        emit indexReady(Stage::Summaries);
+        startSpatial(generation, dataset.samplingPoints());
+    });
+
+    // Lookups that only need the records run alongside the summaries
+    scheduler.deliver(TaskPriority::Background, this, [input]() {
+        SiteDateIndex index;
+        WaterDataset::buildSiteDateIndex(input, index);
+        return index;
+    }, [this, generation](const SiteDateIndex& index) {
+        if (dataset.installSiteDateIndex(generation, index)) {
+            emit indexReady(Stage::SiteDate);
+        }
+    });
+
+    scheduler.deliver(TaskPriority::Background, this, [input]() {
+        SearchIndex index;
+        WaterDataset::buildSearchIndex(input, index);
+        return index;
+    }, [this, generation](const SearchIndex& index) {
+        if (dataset.installSearchIndex(generation, index)) {
+            emit indexReady(Stage::Search);
+        }
+    });
+}
+
+void IndexScheduler::updateSpatial()
+{
+    startSpatial(dataset.generation(), dataset.samplingPoints());
+}
+
+void IndexScheduler::startSpatial(int generation, const QVector<SamplingPoint>& summarised)
+{
+    const int request = dataset.requestSpatialIndex();
+    scheduler.deliver(TaskPriority::Background, this, [summarised]() {
+        SpatialBuild build;
+        build.sites = summarised;
+        WaterDataset::buildSpatialIndex(build.sites, build.index);
+        return build;
+    }, [this, generation, request](const SpatialBuild& build) {
+        if (dataset.installSpatialIndex(generation, request, build.sites, build.index)) {
+            emit indexReady(Stage::Spatial);
+        }
+    });
+}
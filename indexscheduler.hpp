@@ -0,0 +1,43 @@
+#pragma once
+
+#include <QObject>
+#include "dataset.hpp"
+#include "taskscheduler.hpp"
+
+// Builds a loaded dataset's derived indexes as background tasks on the
+// shared TaskScheduler, so the table can be shown as soon as the core
+// columns are parsed. Builds run in stages, each published on the GUI
+// thread with its own signal:
+//   Summaries - trend cube and per-site exceedance counts
+//   Spatial   - WGS84 positions and the sampling point spatial index,
+//               once the summaries have counted each site
+//   SiteDate  - rows of each (sampling point, date) sample
+//   Search    - distinct-value search over the shown record columns
+// Until a stage is ready, pages take their slower scan of the table.
+class IndexScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Stage { Summaries, Spatial, SiteDate, Search };
+    Q_ENUM(Stage)
+
+    IndexScheduler(WaterDataset& dataset, TaskScheduler& scheduler, QObject* parent = nullptr);
+
+    // Start building for the dataset's current load; results of any build
+    // still running for an earlier load are discarded when they arrive
+    void start();
+
+    // Build the spatial index again over the current sites, after an
+    // append added or located some; a build still running is overtaken
+    void updateSpatial();
+
+signals:
+    void indexReady(IndexScheduler::Stage stage);
+
+private:
+    void startSpatial(int generation, const QVector<SamplingPoint>& sites);
+
+    WaterDataset& dataset;
+    TaskScheduler& scheduler;
+};
@@ -0,0 +1,251 @@
+#include "interaction.hpp"
+#include "tracing.hpp"
+#include "window.hpp"
+#include <QComboBox>
+#include <QDebug>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLineEdit>
+#include <QSaveFile>
+#include <QTimer>
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+// Consecutive idle checks a step needs, so results queued by a task that
+// has just finished are drawn before the step counts as done
+const int IDLE_CHECKS = 2;
+
+QString describe(const InteractionStep& step)
+{
+    if (step.action == "load") {
+        return "load " + step.value;
+    }
+    if (step.action == "navigate") {
+        return "navigate " + step.page;
+    }
+    return QString("%1 %2.%3 = \"%4\"").arg(step.action, step.page, step.widget, step.value);
+}
+
+}
+
+bool saveInteractionScript(const QString& filePath, const QVector<InteractionStep>& steps)
+{
+    QJsonArray array;
+    for (const InteractionStep& step : steps) {
+        QJsonObject object;
+        object["action"] = step.action;
+        if (!step.page.isEmpty()) {
+            object["page"] = step.page;
+        }
+        if (!step.widget.isEmpty()) {
+            object["widget"] = step.widget;
+        }
+        object["value"] = step.value;
+        object["atMs"] = step.atMs;
+        array.append(object);
+    }
+
+    QSaveFile output(filePath);
+    if (!output.open(QIODevice::WriteOnly)) {
+        qWarning() << "Unable to write script:" << filePath;
+        return false;
+    }
+    output.write(QJsonDocument(QJsonObject{{"version", 1}, {"steps", array}}).toJson());
+    if (!output.commit()) {
+        qWarning() << "Unable to write script:" << filePath;
+        return false;
+    }
+    return true;
+}
+
+bool loadInteractionScript(const QString& filePath, QVector<InteractionStep>& steps)
+{
+    QFile input(filePath);
+    if (!input.open(QIODevice::ReadOnly)) {
+        qWarning() << "Unable to open script:" << filePath;
+        return false;
+    }
+
+    QJsonParseError error;
+    const QJsonDocument document = QJsonDocument::fromJson(input.readAll(), &error);
+    if (document.isNull()) {
+        qWarning() << "Invalid script:" << filePath << error.errorString();
+        return false;
+    }
+
+    steps.clear();
+    for (const QJsonValue& value : document.object().value("steps").toArray()) {
+        const QJsonObject object = value.toObject();
+        InteractionStep step;
+        step.action = object.value("action").toString();
+        step.page = object.value("page").toString();
+        step.widget = object.value("widget").toString();
+        step.value = object.value("value").toString();
+        step.atMs = object.value("atMs").toInteger();
+        steps.append(step);
+    }
+    return true;
+}
+
+InteractionRecorder::InteractionRecorder(QObject* parent) : QObject(parent)
+{
+    clock.start();
+}
+
+void InteractionRecorder::recordLoad(const QString& filePath)
+{
+    append({"load", QString(), QString(), filePath});
+}
+
+void InteractionRecorder::recordNavigate(const QString& page)
+{
+    append({"navigate", page, QString(), QString()});
+}
+
+void InteractionRecorder::watchPage(QWidget* page, const QString& pageKey)
+{
+    // textEdited and activated fire for user input only, not for the
+    // pages' own updates, so refreshes are not recorded as actions
+    for (QLineEdit* edit : page->findChildren<QLineEdit*>()) {
+        if (!edit->objectName().isEmpty()) {
+            connect(edit, &QLineEdit::textEdited, this, [this, pageKey, edit](const QString& text) {
+                append({"setText", pageKey, edit->objectName(), text});
+            });
+        }
+    }
+    for (QComboBox* combo : page->findChildren<QComboBox*>()) {
+        if (!combo->objectName().isEmpty()) {
+            connect(combo, &QComboBox::activated, this, [this, pageKey, combo](int index) {
+                append({"select", pageKey, combo->objectName(), combo->itemText(index)});
+            });
+        }
+    }
+}
+
+void InteractionRecorder::append(InteractionStep step)
+{
+    step.atMs = clock.elapsed();
+    recorded.append(step);
+}
+
+InteractionReplay::InteractionReplay(Window& window, const QVector<InteractionStep>& steps, const QString& dataset,
+                                     QObject* parent)
+    : QObject(parent), window(window), steps(steps), dataset(dataset)
+{
+}
+
+void InteractionReplay::start()
+{
+    current = 0;
+    latencies.clear();
+    QTimer::singleShot(0, this, &InteractionReplay::runStep);
+}
+
+void InteractionReplay::runStep()
+{
+    if (current >= steps.size()) {
+        finish(true);
+        return;
+    }
+
+    const InteractionStep& step = steps[current];
+
+    // Edits act on their page; reaching it is not part of the step's time
+    if ((step.action == "setText" || step.action == "select") && window.currentPageKey() != step.page
+        && !window.openPage(step.page)) {
+        qWarning() << "Unknown page in step" << current + 1 << ":" << step.page;
+        finish(false);
+        return;
+    }
+
+    stepStart = TraceRecorder::now();
+    if (!perform(step)) {
+        finish(false);
+        return;
+    }
+
+    idleChecks = 0;
+    QTimer::singleShot(0, this, &InteractionReplay::waitForIdle);
+}
+
+bool InteractionReplay::perform(const InteractionStep& step)
+{
+    TraceScope trace("InteractionReplay::step");
+
+    if (step.action == "load") {
+        window.openFile(dataset.isEmpty() ? step.value : dataset);
+        return true;
+    }
+    if (step.action == "navigate") {
+        if (!window.openPage(step.page)) {
+            qWarning() << "Unknown page in step" << current + 1 << ":" << step.page;
+            return false;
+        }
+        return true;
+    }
+
+    QWidget* page = window.currentPage();
+    if (step.action == "setText") {
+        QLineEdit* edit = page->findChild<QLineEdit*>(step.widget);
+        if (!edit) {
+            qWarning() << "No line edit" << step.widget << "on" << step.page;
+            return false;
+        }
+        edit->setText(step.value);
+        return true;
+    }
+    if (step.action == "select") {
+        QComboBox* combo = page->findChild<QComboBox*>(step.widget);
+        if (!combo) {
+            qWarning() << "No combo box" << step.widget << "on" << step.page;
+            return false;
+        }
+        // A different dataset may not offer the recorded item; keep going
+        const int index = combo->findText(step.value);
+        if (index < 0) {
+            qWarning() << "Step" << current + 1 << ": no item" << step.value << "in" << step.widget;
+        } else {
+            combo->setCurrentIndex(index);
+        }
+        return true;
+    }
+
+    qWarning() << "Unknown action in step" << current + 1 << ":" << step.action;
+    return false;
+}
+
+void InteractionReplay::waitForIdle()
+{
+    idleChecks = window.isBusy() ? 0 : idleChecks + 1;
+    if (idleChecks < IDLE_CHECKS) {
+        QTimer::singleShot(window.isBusy() ? 1 : 0, this, &InteractionReplay::waitForIdle);
+        return;
+    }
+
+    const double latency = (TraceRecorder::now() - stepStart) / 1e6;
+    latencies.append(latency);
+    std::printf("%4d  %10.2f ms  %s\n", current + 1, latency, qPrintable(describe(steps[current])));
+    std::fflush(stdout);
+
+    current++;
+    QTimer::singleShot(0, this, &InteractionReplay::runStep);
+}
+
+void InteractionReplay::finish(bool ok)
+{
+    if (!latencies.isEmpty()) {
+        QVector<double> sorted = latencies;
+        std::sort(sorted.begin(), sorted.end());
+        double total = 0.0;
+        for (double latency : sorted) {
+            total += latency;
+        }
+        std::printf("%d steps, total %.2f ms, median %.2f ms, max %.2f ms\n", int(sorted.size()), total,
+                    sorted[sorted.size() / 2], sorted.last());
+    }
+    emit finished(ok);
+}
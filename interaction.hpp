@@ -0,0 +1,77 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+class Window;
+
+// One user action, recorded by what it means rather than where the mouse was
+struct InteractionStep
+{
+    QString action;   // "load", "navigate", "setText" or "select"
+    QString page;     // Page key, e.g. "POPs"; empty for loads
+    QString widget;   // Object name of the line edit or combo box
+    QString value;    // File path, text typed or item chosen
+    qint64 atMs = 0;  // Time since recording started
+};
+
+bool saveInteractionScript(const QString& filePath, const QVector<InteractionStep>& steps);
+bool loadInteractionScript(const QString& filePath, QVector<InteractionStep>& steps);
+
+// Collects steps while the user works. Window reports loads and page
+// changes; edits come from the named line edits and combo boxes of each
+// watched page, through the signals that only user input emits.
+class InteractionRecorder : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit InteractionRecorder(QObject* parent = nullptr);
+
+    void recordLoad(const QString& filePath);
+    void recordNavigate(const QString& page);
+    void watchPage(QWidget* page, const QString& pageKey);
+
+    const QVector<InteractionStep>& steps() const { return recorded; }
+
+private:
+    void append(InteractionStep step);
+
+    QElapsedTimer clock;
+    QVector<InteractionStep> recorded;
+};
+
+// Plays a script against a window step by step. A step's latency runs from
+// performing it until the event loop and the task pool are both idle, so
+// chart jobs and index builds it starts are included. Results are printed
+// to standard output when the script ends.
+class InteractionReplay : public QObject
+{
+    Q_OBJECT
+
+public:
+    // A non-empty dataset replaces the file of every load step
+    InteractionReplay(Window& window, const QVector<InteractionStep>& steps, const QString& dataset,
+                      QObject* parent = nullptr);
+
+    void start();
+
+signals:
+    void finished(bool ok);
+
+private:
+    void runStep();
+    bool perform(const InteractionStep& step);
+    void waitForIdle();
+    void finish(bool ok);
+
+    Window& window;
+    QVector<InteractionStep> steps;
+    QString dataset;
+    int current = 0;
+    int idleChecks = 0;
+    qint64 stepStart = 0;
+    QVector<double> latencies;  // Milliseconds, one per finished step
+};
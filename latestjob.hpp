@@ -0,0 +1,88 @@
+#pragma once
+
+#include <QObject>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include "taskscheduler.hpp"
+
+// Rows a chart job scans between cancellation checks
+static const int CANCEL_CHECK_ROWS = 4096;
+
+// Handed to a running job so it can stop early once a newer request has
+// superseded it. Cheap to copy and safe to poll from any thread.
+class CancelToken
+{
+public:
+    CancelToken() = default;
+    CancelToken(std::shared_ptr<const std::atomic<quint64>> latest, quint64 generation)
+        : latest(std::move(latest)), generation(generation) {}
+
+    bool isCancelled() const { return latest && latest->load(std::memory_order_relaxed) != generation; }
+
+private:
+    std::shared_ptr<const std::atomic<quint64>> latest;
+    quint64 generation = 0;
+};
+
+// Runs a stream of requests where only the newest matters, such as charts
+// for a dropdown being scrolled with the keyboard. At most one job is on
+// the pool at a time: request() bumps the generation, which cancels the
+// running job, and once that job returns only the newest request is
+// started. apply() is called on the GUI thread for current results only.
+template <typename Request, typename Result>
+class LatestJob
+{
+public:
+    using Work = std::function<Result(const Request&, const CancelToken&)>;
+    using Apply = std::function<void(const Result&)>;
+
+    // receiver owns this object, so results are never delivered after it is gone
+    LatestJob(TaskScheduler* scheduler, QObject* receiver, Work work, Apply apply)
+        : scheduler(scheduler), receiver(receiver), work(std::move(work)), apply(std::move(apply)) {}
+
+    void request(const Request& next)
+    {
+        pending = next;
+        hasPending = true;
+        ++*latest;
+        if (!running) {
+            startPending();
+        }
+    }
+
+    // Drop the pending request and stop the running one, e.g. before a reload
+    void cancel()
+    {
+        hasPending = false;
+        ++*latest;
+    }
+
+private:
+    void startPending()
+    {
+        running = true;
+        hasPending = false;
+
+        const CancelToken token(latest, latest->load());
+        scheduler->deliver(TaskPriority::Interactive, receiver, [work = work, request = pending, token]() {
+            return work(request, token);
+        }, [this, token](const Result& result) {
+            running = false;
+            if (!token.isCancelled()) {
+                apply(result);
+            } else if (hasPending) {
+                startPending();
+            }
+        });
+    }
+
+    TaskScheduler* scheduler;
+    QObject* receiver;
+    Work work;
+    Apply apply;
+    std::shared_ptr<std::atomic<quint64>> latest = std::make_shared<std::atomic<quint64>>(0);
+    Request pending;
+    bool hasPending = false;
+    bool running = false;
+};
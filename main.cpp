@@ -1,10 +1,70 @@
 #include <QtWidgets>
+#include <cstring>
 #include "window.hpp"
+#include "report.hpp"
+#include "tracing.hpp"
+#include "interaction.hpp"
+
+// Headless batch mode: watertool --report in.csv --out report.json|csv
+static int runReport(const QCoreApplication& app)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Water quality compliance report");
+    parser.addHelpOption();
+    QCommandLineOption reportOption("report", "Input CSV file to summarise, optionally .gz or .zst.", "in.csv");
+    QCommandLineOption outOption("out", "Output file (.json or .csv).", "report.json");
+    parser.addOption(reportOption);
+    parser.addOption(outOption);
+    parser.process(app);
+
+    if (!parser.isSet(outOption)) {
+        qWarning() << "Missing --out <report.json|report.csv>";
+        return 1;
+    }
+
+    ComplianceReport report;
+    return report.generate(parser.value(reportOption), parser.value(outOption)) ? 0 : 1;
+}
 
 int main(int argc, char* argv[])
 {
+    // The report runs without a display, so decide before creating a GUI application
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--report") == 0 || std::strncmp(argv[i], "--report=", 9) == 0) {
+            QCoreApplication app(argc, argv);
+            return runReport(app);
+        }
+        // Replays run headless unless a platform was chosen explicitly
+        if ((std::strcmp(argv[i], "--replay") == 0 || std::strncmp(argv[i], "--replay=", 9) == 0)
+            && qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+            qputenv("QT_QPA_PLATFORM", "offscreen");
+        }
+    }
+
     QApplication app(argc, argv);
 
+    // watertool --trace out.json keeps every timed span for Perfetto;
+    // --record and --replay save and play back interaction scripts
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption traceOption("trace", "Write a Chrome trace of timed operations on exit.", "out.json");
+    QCommandLineOption recordOption("record", "Save the actions performed to a script on exit.", "script.json");
+    QCommandLineOption replayOption("replay", "Replay a script headlessly and report each step's latency.", "script.json");
+    QCommandLineOption datasetOption("dataset", "CSV file to load in place of the script's own.", "data.csv");
+    parser.addOptions({traceOption, recordOption, replayOption, datasetOption});
+    parser.process(app);
+
+    QVector<InteractionStep> script;
+    if (parser.isSet(replayOption) && !loadInteractionScript(parser.value(replayOption), script)) {
+        return 1;
+    }
+
+    const QString tracePath = parser.value(traceOption);
+    if (!tracePath.isEmpty()) {
+        QThread::currentThread()->setObjectName("GUI");
+        TraceRecorder::instance().startCapture();
+    }
+
     QTranslator translator;
 
     // Detect system locale
@@ -23,5 +83,24 @@ int main(int argc, char* argv[])
     Window window;
     window.show();
 
-    return app.exec();
+    InteractionReplay replay(window, script, parser.value(datasetOption));
+    if (parser.isSet(replayOption)) {
+        QObject::connect(&replay, &InteractionReplay::finished, &app, [](bool ok) {
+            QCoreApplication::exit(ok ? 0 : 1);
+        });
+        replay.start();
+    }
+    if (parser.isSet(recordOption)) {
+        window.startRecording();
+    }
+
+    const int status = app.exec();
+    if (!tracePath.isEmpty() && !TraceRecorder::instance().writeCapture(tracePath)) {
+        return 1;
+    }
+    if (parser.isSet(recordOption) && !saveInteractionScript(parser.value(recordOption),
+                                                             window.interactionRecorder()->steps())) {
+        return 1;
+    }
+    return status;
 }
\ No newline at end of file
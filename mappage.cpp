@@ -0,0 +1,74 @@
+#include "mappage.hpp"
+#include "markerlayer.hpp"
+#include "tracing.hpp"
+#include <QQmlContext>
+#include <QQmlEngine>
+#include <QDebug>
+
+MapPage::MapPage(QWidget* parent) : QWidget(parent)
+{
+    // The marker layer is a C++ item, registered once for every map page
+    static const int markerLayerType = qmlRegisterType<SiteMarkerLayer>("WaterTool", 1, 0, "SiteMarkerLayer");
+    Q_UNUSED(markerLayerType);
+
+    mainLayout = new QVBoxLayout(this);
+
+    // Title
+    QLabel* title = new QLabel("Sampling Point Map", this);
+    QFont titleFont = title->font();
+    titleFont.setPointSize(16);
+    title->setFont(titleFont);
+    title->setAlignment(Qt::AlignCenter);
+
+    summaryLabel = new QLabel("No file loaded", this);
+    summaryLabel->setAlignment(Qt::AlignCenter);
+
+    // Back to Dashboard Button
+    backButton = new QPushButton("Back to Dashboard", this);
+    connect(backButton, &QPushButton::clicked, this, &MapPage::navigateToDashboard);
+
+    // QML map; the model must be in the context before the source loads
+    siteModel = new SamplingPointModel(this);
+    mapView = new QQuickWidget(this);
+    mapView->setResizeMode(QQuickWidget::SizeRootObjectToView);
+    mapView->rootContext()->setContextProperty("siteModel", siteModel);
+    mapView->setSource(QUrl("qrc:/mappage.qml"));
+    if (mapView->status() == QQuickWidget::Error) {
+        for (const QQmlError& error : mapView->errors()) {
+            qWarning() << "Map page:" << error.toString();
+        }
+    }
+
+    mainLayout->addWidget(title);
+    mainLayout->addWidget(summaryLabel);
+    mainLayout->addWidget(mapView, 1);
+    mainLayout->addWidget(backButton);
+}
+
+void MapPage::loadDataset(const WaterDataset& dataset)
+{
+    TraceScope trace("MapPage::loadDataset");
+
+    siteModel->setSites(dataset.samplingPoints());
+
+    int flagged = 0;
+    for (const SamplingPoint& site : siteModel->sites()) {
+        if (site.exceedances > 0) {
+            flagged++;
+        }
+    }
+
+    if (!dataset.hasSummaries()) {
+        // Sites are placed from their grid references straight after load; colours follow
+        summaryLabel->setText(QString("%1 of %2 sampling points located; counting exceedances...")
+                                  .arg(siteModel->rowCount())
+                                  .arg(dataset.samplingPoints().size()));
+        return;
+    }
+
+    summaryLabel->setText(QString("%1 of %2 sampling points located; %3 with at least one exceedance. "
+                                  "Drag to pan, scroll to zoom, click a site for details.")
+                              .arg(siteModel->rowCount())
+                              .arg(dataset.samplingPoints().size())
+                              .arg(flagged));
+}
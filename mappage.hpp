@@ -0,0 +1,36 @@
+#pragma once
+
+#include <QWidget>
+#include <QVBoxLayout>
+#include <QLabel>
+#include <QPushButton>
+#include <QQuickWidget>
+#include "dataset.hpp"
+#include "sitemodel.hpp"
+
+// Map of every sampling point, coloured by the share of its categorised
+// samples that exceed their threshold
+class MapPage : public QWidget
+{
+    Q_OBJECT
+
+public:
+    // Constructor
+    explicit MapPage(QWidget* parent = nullptr);
+
+    // Materialise the page from the shared parsed dataset
+    void loadDataset(const WaterDataset& dataset);
+
+signals:
+    // Signal to navigate back to the dashboard
+    void navigateToDashboard();
+
+private:
+    // Widgets for the page
+    QVBoxLayout* mainLayout;
+    QLabel* summaryLabel;
+    QQuickWidget* mapView;
+    QPushButton* backButton;
+
+    SamplingPointModel* siteModel; // Sites shown by the QML marker layer
+};
@@ -0,0 +1,126 @@
+import QtQuick 2.15
+import QtQuick.Controls 2.15
+import WaterTool 1.0
+
+// Sampling point map drawn on a plain canvas in British National Grid
+// coordinates, so it needs no tile server or network access. Overlapping
+// sites are drawn as clusters that grow with their member count.
+Rectangle {
+    id: root
+    color: "#dfe9f3"
+    clip: true
+
+    property var selectedSite: null
+
+    SiteMarkerLayer {
+        id: markers
+        anchors.fill: parent
+        model: siteModel
+        markerSize: 7
+    }
+
+    DragHandler {
+        id: drag
+        target: null
+        property vector2d previous: Qt.vector2d(0, 0)
+        onActiveChanged: previous = Qt.vector2d(0, 0)
+        onTranslationChanged: {
+            markers.panBy(translation.x - previous.x, translation.y - previous.y)
+            previous = translation
+        }
+    }
+
+    WheelHandler {
+        target: null
+        onWheel: (event) => markers.zoomAt(point.position.x, point.position.y,
+                                           event.angleDelta.y > 0 ? 0.8 : 1.25)
+    }
+
+    TapHandler {
+        onTapped: (eventPoint) => {
+            const x = eventPoint.position.x
+            const y = eventPoint.position.y
+            const row = markers.siteAt(x, y)
+
+            // Clicking a cluster zooms in on it until its sites separate
+            if (row < 0 && markers.clusterSizeAt(x, y) > 1)
+                markers.zoomAt(x, y, 0.5)
+            root.selectedSite = row >= 0 ? markers.siteInfo(row) : null
+        }
+    }
+
+    // Details of the clicked site
+    Rectangle {
+        visible: root.selectedSite !== null
+        anchors { top: parent.top; right: parent.right; margins: 10 }
+        width: details.implicitWidth + 20
+        height: details.implicitHeight + 20
+        radius: 5
+        color: "#f8f9fa"
+        border.color: "#888"
+
+        Column {
+            id: details
+            anchors.centerIn: parent
+            spacing: 2
+
+            Text {
+                text: root.selectedSite ? root.selectedSite.label : ""
+                font.bold: true
+            }
+            Text {
+                text: root.selectedSite
+                      ? "Easting " + root.selectedSite.easting.toFixed(0)
+                        + ", Northing " + root.selectedSite.northing.toFixed(0)
+                      : ""
+            }
+            Text {
+                text: root.selectedSite
+                      ? root.selectedSite.latitude.toFixed(5) + "\u00b0, "
+                        + root.selectedSite.longitude.toFixed(5) + "\u00b0 (WGS84)"
+                      : ""
+            }
+            Text {
+                text: root.selectedSite ? "Samples: " + root.selectedSite.samples : ""
+            }
+            Text {
+                text: root.selectedSite
+                      ? "Exceedances: " + root.selectedSite.exceedances + " of "
+                        + root.selectedSite.classified + " ("
+                        + (root.selectedSite.exceedanceRate * 100).toFixed(1) + "%)"
+                      : ""
+            }
+        }
+    }
+
+    // Colour key and view controls
+    Row {
+        anchors { left: parent.left; bottom: parent.bottom; margins: 10 }
+        spacing: 10
+
+        Repeater {
+            model: [
+                { label: "No exceedances", colour: "#228b22" },
+                { label: "50% exceed", colour: "#ffa500" },
+                { label: "All exceed", colour: "#b22222" },
+                { label: "Not categorised", colour: "#a9a9a9" }
+            ]
+            Row {
+                spacing: 4
+                Rectangle { width: 12; height: 12; color: modelData.colour; anchors.verticalCenter: parent.verticalCenter }
+                Text { text: modelData.label }
+            }
+        }
+
+        Button {
+            text: "Fit All Sites"
+            onClicked: markers.fitToSites()
+        }
+    }
+
+    Text {
+        anchors { right: parent.right; bottom: parent.bottom; margins: 10 }
+        text: (markers.metresPerPixel * 100 / 1000).toFixed(1) + " km per 100 px"
+        color: "#555"
+    }
+}
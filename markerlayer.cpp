@@ -0,0 +1,305 @@
+#include "markerlayer.hpp"
+#include "tracing.hpp"
+#include <QColor>
+#include <QMatrix4x4>
+#include <QSGGeometryNode>
+#include <QSGTransformNode>
+#include <QSGVertexColorMaterial>
+#include <cmath>
+
+namespace {
+
+// Limits for zooming, in metres per pixel
+const qreal MIN_SCALE = 1.0;
+const qreal MAX_SCALE = 10000.0;
+
+// Green when no sample exceeded, through amber to red as the rate rises;
+// grey for sites with no categorised samples. Matches the pages' delegates.
+QColor rateColour(double rate, bool classified)
+{
+    if (!classified) {
+        return QColor(169, 169, 169);
+    }
+
+    const QColor green(34, 139, 34), amber(255, 165, 0), red(178, 34, 34);
+    const QColor& from = rate < 0.5 ? green : amber;
+    const QColor& to = rate < 0.5 ? amber : red;
+    const double t = rate < 0.5 ? rate * 2 : (qMin(rate, 1.0) - 0.5) * 2;
+    return QColor::fromRgbF(from.redF() + (to.redF() - from.redF()) * t,
+                            from.greenF() + (to.greenF() - from.greenF()) * t,
+                            from.blueF() + (to.blueF() - from.blueF()) * t);
+}
+
+}
+
+SiteMarkerLayer::SiteMarkerLayer(QQuickItem* parent) : QQuickItem(parent)
+{
+    setFlag(ItemHasContents, true);
+}
+
+void SiteMarkerLayer::setModel(QAbstractItemModel* model)
+{
+    if (siteModel == model) {
+        return;
+    }
+    if (siteModel) {
+        disconnect(siteModel, nullptr, this, nullptr);
+    }
+
+    siteModel = model;
+    if (siteModel) {
+        connect(siteModel, &QAbstractItemModel::modelReset, this, &SiteMarkerLayer::reloadMarkers);
+        connect(siteModel, &QAbstractItemModel::rowsInserted, this, &SiteMarkerLayer::reloadMarkers);
+        connect(siteModel, &QAbstractItemModel::rowsRemoved, this, &SiteMarkerLayer::reloadMarkers);
+        connect(siteModel, &QAbstractItemModel::dataChanged, this, &SiteMarkerLayer::reloadMarkers);
+    }
+
+    reloadMarkers();
+    emit modelChanged();
+}
+
+void SiteMarkerLayer::setMarkerSize(qreal pixels)
+{
+    if (qFuzzyCompare(size, pixels)) {
+        return;
+    }
+    size = pixels;
+    geometryDirty = true;
+    update();
+    emit markerSizeChanged();
+}
+
+void SiteMarkerLayer::reloadMarkers()
+{
+    TraceScope trace("SiteMarkerLayer::reloadMarkers");
+
+    sites.clear();
+
+    if (siteModel) {
+        const QHash<int, QByteArray> roles = siteModel->roleNames();
+        const int eastingRole = roles.key("easting", -1);
+        const int northingRole = roles.key("northing", -1);
+        const int classifiedRole = roles.key("classified", -1);
+        const int exceedancesRole = roles.key("exceedances", -1);
+
+        const int rows = siteModel->rowCount();
+        sites.reserve(rows);
+        for (int row = 0; row < rows; ++row) {
+            const QModelIndex index = siteModel->index(row, 0);
+            SamplingPoint site;
+            site.easting = siteModel->data(index, eastingRole).toDouble();
+            site.northing = siteModel->data(index, northingRole).toDouble();
+            site.hasLocation = true;
+            site.classified = siteModel->data(index, classifiedRole).toUInt();
+            site.exceedances = siteModel->data(index, exceedancesRole).toUInt();
+            sites.append(site);
+        }
+    }
+
+    index.build(sites);
+    fitToSites();
+}
+
+void SiteMarkerLayer::fitToSites()
+{
+    if (index.isEmpty()) {
+        origin = centre = QPointF();
+        geometryDirty = true;
+        update();
+        emit viewChanged();
+        return;
+    }
+
+    const QRectF bounds = index.bounds();
+    origin = centre = bounds.center();
+
+    // Leave a margin so edge markers are not clipped
+    const qreal fit = qMax(bounds.width() / qMax(width(), 1.0), bounds.height() / qMax(height(), 1.0)) * 1.1;
+    scale = qBound(MIN_SCALE, fit, MAX_SCALE);
+
+    geometryDirty = true;
+    update();
+    emit viewChanged();
+}
+
+void SiteMarkerLayer::panBy(qreal dx, qreal dy)
+{
+    // Grid northings increase upwards, item y downwards
+    centre += QPointF(-dx * scale, dy * scale);
+    update();
+    emit viewChanged();
+}
+
+void SiteMarkerLayer::zoomAt(qreal x, qreal y, qreal factor)
+{
+    // Keep the grid position under the cursor fixed
+    const QPointF anchor = toGrid(QPointF(x, y));
+    scale = qBound(MIN_SCALE, scale * factor, MAX_SCALE);
+    centre = anchor - QPointF((x - width() / 2) * scale, -(y - height() / 2) * scale);
+
+    geometryDirty = true;
+    update();
+    emit viewChanged();
+}
+
+int SiteMarkerLayer::siteAt(qreal x, qreal y) const
+{
+    if (clusterLevel() >= 0) {
+        // Only a cluster of one stands for a single site
+        const SiteCluster cluster = clusterAt(x, y);
+        return cluster.count == 1 ? cluster.representative : -1;
+    }
+
+    const QVector<NearbySite> nearby = index.sitesWithin(toGrid(QPointF(x, y)), (size / 2 + 2) * scale);
+    return nearby.isEmpty() ? -1 : nearby.first().site;
+}
+
+int SiteMarkerLayer::clusterSizeAt(qreal x, qreal y) const
+{
+    return clusterLevel() >= 0 ? clusterAt(x, y).count : 0;
+}
+
+int SiteMarkerLayer::clusterLevel() const
+{
+    // Cluster once markers closer than two marker widths could overlap
+    const qreal spacing = size * scale * 2;
+    if (index.isEmpty() || spacing <= SiteSpatialIndex::BASE_CELL) {
+        return -1;
+    }
+    return index.levelForSpacing(spacing);
+}
+
+SiteCluster SiteMarkerLayer::clusterAt(qreal x, qreal y) const
+{
+    const QPointF grid = toGrid(QPointF(x, y));
+    const qreal reach = (size * 3 / 2 + 2) * scale; // Largest cluster marker
+
+    SiteCluster nearest;
+    qreal nearestDistance = reach;
+    for (const SiteCluster& cluster : index.clustersInRect(clusterLevel(), QRectF(grid.x() - reach, grid.y() - reach,
+                                                                                   reach * 2, reach * 2))) {
+        const QPointF delta = cluster.centroid - grid;
+        const qreal distance = std::hypot(delta.x(), delta.y());
+        if (distance <= (clusterPixels(cluster.count) / 2 + 2) * scale && distance <= nearestDistance) {
+            nearest = cluster;
+            nearestDistance = distance;
+        }
+    }
+    return nearest;
+}
+
+qreal SiteMarkerLayer::clusterPixels(int count) const
+{
+    // Larger clusters draw larger, up to three marker widths
+    return size * qMin(3.0, 1.0 + std::log10(qMax(count, 1)));
+}
+
+QVariantMap SiteMarkerLayer::siteInfo(int row) const
+{
+    QVariantMap info;
+    if (!siteModel || row < 0 || row >= siteModel->rowCount()) {
+        return info;
+    }
+
+    const QModelIndex index = siteModel->index(row, 0);
+    const QHash<int, QByteArray> roles = siteModel->roleNames();
+    for (auto it = roles.begin(); it != roles.end(); ++it) {
+        info.insert(QString::fromUtf8(it.value()), siteModel->data(index, it.key()));
+    }
+    return info;
+}
+
+QPointF SiteMarkerLayer::toGrid(const QPointF& point) const
+{
+    return centre + QPointF((point.x() - width() / 2) * scale, -(point.y() - height() / 2) * scale);
+}
+
+void SiteMarkerLayer::geometryChange(const QRectF& newGeometry, const QRectF& oldGeometry)
+{
+    QQuickItem::geometryChange(newGeometry, oldGeometry);
+
+    // Fit once the item has a real size
+    if (oldGeometry.isEmpty() && !newGeometry.isEmpty()) {
+        fitToSites();
+    } else {
+        update();
+    }
+}
+
+QSGNode* SiteMarkerLayer::updatePaintNode(QSGNode* oldNode, UpdatePaintNodeData*)
+{
+    TraceScope trace("SiteMarkerLayer::updatePaintNode");
+
+    QSGTransformNode* root = static_cast<QSGTransformNode*>(oldNode);
+    QSGGeometryNode* node;
+
+    if (!root) {
+        root = new QSGTransformNode();
+        node = new QSGGeometryNode();
+
+        QSGGeometry* geometry = new QSGGeometry(QSGGeometry::defaultAttributes_ColoredPoint2D(), 0);
+        geometry->setDrawingMode(QSGGeometry::DrawTriangles);
+        node->setGeometry(geometry);
+        node->setFlag(QSGNode::OwnsGeometry);
+        node->setMaterial(new QSGVertexColorMaterial());
+        node->setFlag(QSGNode::OwnsMaterial);
+
+        root->appendChildNode(node);
+        geometryDirty = true;
+    } else {
+        node = static_cast<QSGGeometryNode*>(root->firstChild());
+    }
+
+    if (geometryDirty) {
+        // Either every site or the current level's clusters, two triangles each
+        const int level = clusterLevel();
+        const QVector<SiteCluster> single;
+        const QVector<SiteCluster>& clusters = level >= 0 ? index.clusters(level) : single;
+        const int count = level >= 0 ? clusters.size() : sites.size();
+
+        QSGGeometry* geometry = node->geometry();
+        geometry->allocate(count * 6);
+        QSGGeometry::ColoredPoint2D* vertex = geometry->vertexDataAsColoredPoint2D();
+
+        for (int i = 0; i < count; ++i) {
+            QPointF position;
+            QColor colour;
+            float half;
+            if (level >= 0) {
+                const SiteCluster& cluster = clusters[i];
+                position = cluster.centroid;
+                colour = rateColour(cluster.exceedanceRate(), cluster.classified > 0);
+                half = float(clusterPixels(cluster.count) * scale / 2);
+            } else {
+                const SamplingPoint& site = sites[i];
+                position = QPointF(site.easting, site.northing);
+                colour = rateColour(site.exceedanceRate(), site.classified > 0);
+                half = float(size * scale / 2);
+            }
+
+            const float x = float(position.x() - origin.x());
+            const float y = float(position.y() - origin.y());
+            const uchar red = uchar(colour.red()), green = uchar(colour.green()), blue = uchar(colour.blue());
+            vertex[0].set(x - half, y - half, red, green, blue, 255);
+            vertex[1].set(x + half, y - half, red, green, blue, 255);
+            vertex[2].set(x + half, y + half, red, green, blue, 255);
+            vertex[3].set(x - half, y - half, red, green, blue, 255);
+            vertex[4].set(x + half, y + half, red, green, blue, 255);
+            vertex[5].set(x - half, y + half, red, green, blue, 255);
+            vertex += 6;
+        }
+
+        node->markDirty(QSGNode::DirtyGeometry);
+        geometryDirty = false;
+    }
+
+    // Grid metres to item pixels, flipping northings so north is up
+    QMatrix4x4 matrix;
+    matrix.translate(float(width() / 2), float(height() / 2));
+    matrix.scale(float(1 / scale), float(-1 / scale));
+    matrix.translate(float(origin.x() - centre.x()), float(origin.y() - centre.y()));
+    root->setMatrix(matrix);
+    root->markDirty(QSGNode::DirtyMatrix);
+
+    return root;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <QQuickItem>
+#include <QAbstractItemModel>
+#include <QPointer>
+#include <QPointF>
+#include <QVariantMap>
+#include <QVector>
+#include "spatialindex.hpp"
+
+// Draws every row of a sampling point model as a marker in one batched
+// scene graph node instead of one QML item per site. Markers are placed in
+// the British National Grid plane: panning only changes the node's
+// transform, and zooming rebuilds the vertex buffer so markers keep their
+// on-screen size. When markers would overlap, the layer draws the spatial
+// index's clusters for the current zoom instead of individual sites. The
+// model needs "easting", "northing", "classified" and "exceedances" roles.
+class SiteMarkerLayer : public QQuickItem
+{
+    Q_OBJECT
+    Q_PROPERTY(QAbstractItemModel* model READ model WRITE setModel NOTIFY modelChanged)
+    Q_PROPERTY(qreal markerSize READ markerSize WRITE setMarkerSize NOTIFY markerSizeChanged)
+    Q_PROPERTY(qreal metresPerPixel READ metresPerPixel NOTIFY viewChanged)
+
+public:
+    explicit SiteMarkerLayer(QQuickItem* parent = nullptr);
+
+    QAbstractItemModel* model() const { return siteModel; }
+    void setModel(QAbstractItemModel* model);
+    qreal markerSize() const { return size; }
+    void setMarkerSize(qreal pixels);
+    qreal metresPerPixel() const { return scale; }
+
+    // View controls, in item pixels
+    Q_INVOKABLE void fitToSites();
+    Q_INVOKABLE void panBy(qreal dx, qreal dy);
+    Q_INVOKABLE void zoomAt(qreal x, qreal y, qreal factor);
+
+    // Row of the site marker under a point, or -1, and that row's roles by name
+    Q_INVOKABLE int siteAt(qreal x, qreal y) const;
+    // Number of sites in the cluster marker under a point, or 0
+    Q_INVOKABLE int clusterSizeAt(qreal x, qreal y) const;
+    Q_INVOKABLE QVariantMap siteInfo(int row) const;
+
+signals:
+    void modelChanged();
+    void markerSizeChanged();
+    void viewChanged();
+
+protected:
+    QSGNode* updatePaintNode(QSGNode* oldNode, UpdatePaintNodeData* data) override;
+    void geometryChange(const QRectF& newGeometry, const QRectF& oldGeometry) override;
+
+private:
+    void reloadMarkers();
+    QPointF toGrid(const QPointF& point) const;
+
+    // Pyramid level drawn at the current zoom, or -1 for individual sites
+    int clusterLevel() const;
+    SiteCluster clusterAt(qreal x, qreal y) const;
+    qreal clusterPixels(int count) const;
+
+    QPointer<QAbstractItemModel> siteModel;
+    QVector<SamplingPoint> sites;   // Model rows, in row order
+    SiteSpatialIndex index;         // Over sites, for hit tests and clusters
+    QPointF centre;          // Grid position shown at the middle of the item
+    QPointF origin;          // Grid position vertices are stored relative to, for float precision
+    qreal scale = 100.0;     // Metres per pixel
+    qreal size = 6.0;        // Marker width in pixels
+    bool geometryDirty = true;
+};
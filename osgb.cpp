@@ -0,0 +1,131 @@
+#include "osgb.hpp"
+#include <cmath>
+
+namespace {
+
+const double PI = 3.14159265358979323846;
+const double DEGREES = 180.0 / PI;
+
+// Airy 1830 ellipsoid and National Grid projection constants
+const double AIRY_A = 6377563.396;
+const double AIRY_B = 6356256.909;
+const double F0 = 0.9996012717;              // Scale factor on the central meridian
+const double LAT0 = 49.0 / DEGREES;          // True origin
+const double LON0 = -2.0 / DEGREES;
+const double N0 = -100000.0;                 // Northing and easting of the true origin
+const double E0 = 400000.0;
+
+// WGS84 / GRS80 ellipsoid
+const double WGS_A = 6378137.000;
+const double WGS_B = 6356752.3141;
+
+// OSGB36 to WGS84 Helmert parameters: metres, parts per million, arc seconds
+const double TX = 446.448;
+const double TY = -125.157;
+const double TZ = 542.060;
+const double SCALE_PPM = -20.4894;
+const double RX = 0.1502 / 3600 / DEGREES;
+const double RY = 0.2470 / 3600 / DEGREES;
+const double RZ = 0.8421 / 3600 / DEGREES;
+
+// Enough to converge below 0.01 mm anywhere on the grid
+const int MERIDIAN_ITERATIONS = 6;
+const int LATITUDE_ITERATIONS = 4;
+
+// Meridional arc from the true origin to latitude phi on the Airy ellipsoid
+inline double meridionalArc(double phi)
+{
+    const double n = (AIRY_A - AIRY_B) / (AIRY_A + AIRY_B);
+    const double n2 = n * n, n3 = n2 * n;
+    const double dPhi = phi - LAT0, sPhi = phi + LAT0;
+
+    return AIRY_B * F0 * ((1 + n + 1.25 * n2 + 1.25 * n3) * dPhi
+                          - (3 * n + 3 * n2 + 2.625 * n3) * std::sin(dPhi) * std::cos(sPhi)
+                          + (1.875 * n2 + 1.875 * n3) * std::sin(2 * dPhi) * std::cos(2 * sPhi)
+                          - (35.0 / 24.0) * n3 * std::sin(3 * dPhi) * std::cos(3 * sPhi));
+}
+
+// Inverse Transverse Mercator from National Grid easting/northing to
+// OSGB36 latitude/longitude in radians
+inline void inverseProjection(double e, double northing, double airyE2, double& lat, double& lon)
+{
+    // Solve for the footpoint latitude
+    double phi = LAT0;
+    for (int k = 0; k < MERIDIAN_ITERATIONS; ++k) {
+        phi += (northing - N0 - meridionalArc(phi)) / (AIRY_A * F0);
+    }
+
+    const double sinPhi = std::sin(phi), cosPhi = std::cos(phi);
+    const double tanPhi = sinPhi / cosPhi, secPhi = 1 / cosPhi;
+    const double t2 = tanPhi * tanPhi, t4 = t2 * t2, t6 = t4 * t2;
+    const double w = 1 - airyE2 * sinPhi * sinPhi;
+    const double nu = AIRY_A * F0 / std::sqrt(w);
+    const double rho = AIRY_A * F0 * (1 - airyE2) / (w * std::sqrt(w));
+    const double eta2 = nu / rho - 1;
+    const double nu3 = nu * nu * nu, nu5 = nu3 * nu * nu, nu7 = nu5 * nu * nu;
+
+    const double vii = tanPhi / (2 * rho * nu);
+    const double viii = tanPhi / (24 * rho * nu3) * (5 + 3 * t2 + eta2 - 9 * t2 * eta2);
+    const double ix = tanPhi / (720 * rho * nu5) * (61 + 90 * t2 + 45 * t4);
+    const double x = secPhi / nu;
+    const double xi = secPhi / (6 * nu3) * (nu / rho + 2 * t2);
+    const double xii = secPhi / (120 * nu5) * (5 + 28 * t2 + 24 * t4);
+    const double xiia = secPhi / (5040 * nu7) * (61 + 662 * t2 + 1320 * t4 + 720 * t6);
+
+    const double dE = e - E0;
+    const double dE2 = dE * dE, dE3 = dE2 * dE, dE4 = dE3 * dE, dE5 = dE4 * dE, dE6 = dE5 * dE, dE7 = dE6 * dE;
+    lat = phi - vii * dE2 + viii * dE4 - ix * dE6;
+    lon = LON0 + x * dE - xi * dE3 + xii * dE5 - xiia * dE7;
+}
+
+}
+
+void osgbToOsgb36(const double* eastings, const double* northings,
+                  double* latitudes, double* longitudes, int count)
+{
+    const double airyE2 = 1 - (AIRY_B * AIRY_B) / (AIRY_A * AIRY_A);
+
+    for (int i = 0; i < count; ++i) {
+        double lat, lon;
+        inverseProjection(eastings[i], northings[i], airyE2, lat, lon);
+        latitudes[i] = lat * DEGREES;
+        longitudes[i] = lon * DEGREES;
+    }
+}
+
+void osgbToWgs84(const double* eastings, const double* northings,
+                 double* latitudes, double* longitudes, int count)
+{
+    const double airyE2 = 1 - (AIRY_B * AIRY_B) / (AIRY_A * AIRY_A);
+    const double wgsE2 = 1 - (WGS_B * WGS_B) / (WGS_A * WGS_A);
+    const double s = SCALE_PPM * 1e-6;
+
+    for (int i = 0; i < count; ++i) {
+        double lat, lon;
+        inverseProjection(eastings[i], northings[i], airyE2, lat, lon);
+
+        // OSGB36 geodetic to cartesian, at zero ellipsoidal height
+        const double sinLat = std::sin(lat), cosLat = std::cos(lat);
+        const double airyNu = AIRY_A / std::sqrt(1 - airyE2 * sinLat * sinLat);
+        const double x1 = airyNu * cosLat * std::cos(lon);
+        const double y1 = airyNu * cosLat * std::sin(lon);
+        const double z1 = airyNu * (1 - airyE2) * sinLat;
+
+        // Helmert transform to WGS84 cartesian
+        const double x2 = TX + (1 + s) * x1 - RZ * y1 + RY * z1;
+        const double y2 = TY + RZ * x1 + (1 + s) * y1 - RX * z1;
+        const double z2 = TZ - RY * x1 + RX * y1 + (1 + s) * z1;
+
+        // Cartesian back to geodetic on the WGS84 ellipsoid
+        const double p = std::sqrt(x2 * x2 + y2 * y2);
+        double wgsLat = std::atan2(z2, p * (1 - wgsE2));
+        for (int k = 0; k < LATITUDE_ITERATIONS; ++k) {
+            const double sinWgs = std::sin(wgsLat);
+            const double wgsNu = WGS_A / std::sqrt(1 - wgsE2 * sinWgs * sinWgs);
+            wgsLat = std::atan2(z2 + wgsE2 * wgsNu * sinWgs, p);
+        }
+
+        latitudes[i] = wgsLat * DEGREES;
+        longitudes[i] = std::atan2(y2, x2) * DEGREES;
+    }
+}
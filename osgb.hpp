@@ -0,0 +1,17 @@
+#pragma once
+
+// Convert British National Grid (OSGB36) eastings/northings to WGS84
+// latitude/longitude in degrees, for count points at once. Each point
+// goes through the inverse Transverse Mercator projection on the Airy 1830
+// ellipsoid, then a seven-parameter Helmert transform to WGS84. That is
+// accurate to roughly 5 m; the full OSTN15 grid shift is not used. Inputs
+// and outputs are separate contiguous arrays and the iterative steps run a
+// fixed number of times, so the batch is one branch-free loop.
+void osgbToWgs84(const double* eastings, const double* northings,
+                 double* latitudes, double* longitudes, int count);
+
+// The projection step alone: National Grid eastings/northings to OSGB36
+// latitude/longitude in degrees on the Airy 1830 ellipsoid, before any
+// datum transform.
+void osgbToOsgb36(const double* eastings, const double* northings,
+                  double* latitudes, double* longitudes, int count);
@@ -1,7 +1,7 @@
 #include "pollutantOverview.hpp"
-#include <QFile>
-#include <QTextStream>
-#include <QStandardItem>
+#include "categories.hpp"
+#include "tracedchartview.hpp"
+#include "rowsort.hpp"
 #include <QHeaderView>
 #include <QDateTime>
 #include <QtCharts/QCategoryAxis>
@@ -13,8 +13,12 @@
 #include <QComboBox>
 #include <QToolTip>
 #include <QDebug>
+#include <QSignalBlocker>
 
-PollutantOverviewPage::PollutantOverviewPage(QWidget* parent) : QWidget(parent)
+PollutantOverviewPage::PollutantOverviewPage(TaskScheduler* scheduler, QWidget* parent)
+    : QWidget(parent),
+      chartJob(scheduler, this, &PollutantOverviewPage::computeGroupSeries,
+               [this](const GroupSeries& data) { showGroupSeries(data); })
 {
     // Initialize the layout
     layout = new QVBoxLayout(this);
@@ -32,25 +36,29 @@ PollutantOverviewPage::PollutantOverviewPage(QWidget* parent) : QWidget(parent)
 
     // Create a search box
     searchBox = new QLineEdit(this);
+    searchBox->setObjectName("searchBox");
     searchBox->setPlaceholderText("Search pollutants...");
     connect(searchBox, &QLineEdit::textChanged, this, &PollutantOverviewPage::filterTableData);
 
     // Create the table view and model
     tableView = new QTableView(this);
-    dataModel = new QStandardItemModel(this);
-    dataModel->setHorizontalHeaderLabels({"Sampling Point", "Date", "pollutant", "Result", "Unit", "Compliance"});
+    dataModel = new RowTableModel({"Sampling Point", "Date", "pollutant", "Result", "Unit", "Compliance"}, scheduler, this);
+    dataModel->setColumnKind(1, RowTableModel::ColumnKind::Time);
+    dataModel->setColumnKind(3, RowTableModel::ColumnKind::Number);
     tableView->setModel(dataModel);
     tableView->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    dataModel->attachHeader(tableView->horizontalHeader());
 
     // Set compliance delegate for color-coding
     tableView->setItemDelegateForColumn(5, new ComplianceDelegate(this));
 
     // Create dropdown for pollutants
     pollutantDateDropdown = new QComboBox(this);
+    pollutantDateDropdown->setObjectName("pollutantDateDropdown");
     connect(pollutantDateDropdown, &QComboBox::currentTextChanged, this, &PollutantOverviewPage::createChartForGroup);
 
     // Create the chart view
-    chartView = new QChartView(this);
+    chartView = new TracedChartView(this);
     chartView->setRenderHint(QPainter::Antialiasing);
 
     // Add widgets to the layout
@@ -70,180 +78,140 @@ PollutantOverviewPage::PollutantOverviewPage(QWidget* parent) : QWidget(parent)
     layout->setStretch(5, 1);
 }
 
-void PollutantOverviewPage::loadCsvFile(const QString& filePath)
+void PollutantOverviewPage::loadDataset(const WaterDataset& source)
 {
+    TraceScope trace("PollutantOverviewPage::loadDataset");
+
+    dataset = &source;
+
     // Clear existing data
-    dataModel->removeRows(0, dataModel->rowCount());
+    dataModel->clear();
+    chartJob.cancel(); // A chart of the previous data must not land on this one
     pollutantDateDropdown->clear();
     dropdownGroups.clear();
+    monthSamples.clear();
 
     // Load new data
-    loadData(filePath);
+    loadData(source);
     populateDropdown();
 }
 
-void PollutantOverviewPage::loadData(const QString& filePath)
+void PollutantOverviewPage::loadData(const WaterDataset& dataset)
 {
-    QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        qWarning() << "Unable to open file:" << filePath;
-        return;
-    }
+    TraceScope trace("PollutantOverviewPage::loadData");
 
-    QTextStream in(&file);
-    bool isHeader = true;
+    const QVector<quint32>& siteRanks = dataset.samplingPointRanks();
+    dataModel->beginRows(dataset.categoryRows(PollutantCategory::PollutantOverview).count());
 
-    while (!in.atEnd()) {
-        QString line = in.readLine();
-        if (isHeader) {
-            isHeader = false;
-            continue;
-        }
+    // The specified pollutants only, as marked during parsing
+    const QVector<WaterRecord>& records = dataset.records();
+    dataset.categoryRows(PollutantCategory::PollutantOverview).forEachSet([&](int index) {
+        const WaterRecord& record = records[index];
+        const QStringList cells = recordCells(record);
+        dataModel->appendRow(cells, siteRanks[record.samplingPointId], timestampKey(record.date));
+        addChartSample(cells);
+    });
 
-        QStringList columns = parseCSVLine(line);
-        if (columns.size() >= 12) {
-            QString pollutant = columns[5].trimmed(); 
-
-            // Filter only specified pollutants
-            if ((pollutant == "112TCEthan" || pollutant == "Chloroform" || 
-                 pollutant == "Benzene" || pollutant == "Toluene")) {
-
-                QString samplingPoint = columns[3].trimmed();
-                QString date = columns[4].trimmed();
-                QString result = columns[9].trimmed();
-                QString unit = columns[11].trimmed();
-
-                QList<QStandardItem*> row;
-
-                // Helper function to create items
-                auto makeItem = [](const QString& text) {
-                    QStandardItem* item = new QStandardItem(text);
-                    item->setFlags(item->flags() & ~Qt::ItemIsEditable);
-                    return item;
-                };
-
-                row.append(makeItem(samplingPoint));
-                row.append(makeItem(date));
-                row.append(makeItem(pollutant));
-
-                // Process the "Result" column
-                bool ok;
-                double numericResult = result.startsWith("<") ? result.mid(1).toDouble(&ok) : result.toDouble(&ok);
-                if (ok) {
-                    // Convert mg/L to µg/L if necessary
-                    if (unit == "mg/l") {
-                        numericResult *= 1000;
-                        unit = "ug/l"; 
-                    }
-                    row.append(makeItem(QString::number(numericResult, 'f', 5)));
-                } else {
-                    row.append(makeItem("N/A"));
-                }
-
-                row.append(makeItem(unit));
-
-                // Compliance check with thresholds
-                QString compliance;
-                if (ok) {
-                    if (pollutant == "112TCEthan" || pollutant == "Chloroform") {
-                        if (numericResult < 0.1)
-                            compliance = "Compliant";
-                        else if (qFuzzyCompare(numericResult, 0.1))
-                            compliance = "Caution";
-                        else
-                            compliance = "Exceeds";
-                    } else if (pollutant == "Benzene") {
-                        if (numericResult < 1.0)
-                            compliance = "Compliant";
-                        else if (qFuzzyCompare(numericResult, 1.0))
-                            compliance = "Caution";
-                        else
-                            compliance = "Exceeds";
-                    } else if (pollutant == "Toluene") {
-                        if (numericResult < 4.0)
-                            compliance = "Compliant";
-                        else if (qFuzzyCompare(numericResult, 4.0))
-                            compliance = "Caution";
-                        else
-                            compliance = "Exceeds";
-                    } else {
-                        compliance = "Unknown";
-                    }
-                } else {
-                    compliance = "Unknown";
-                }
-                row.append(makeItem(compliance));
-
-                dataModel->appendRow(row);
-            }
-        }
-    }
-
-    file.close();
-    dataModel->sort(0, Qt::AscendingOrder);
+    dataModel->endRows();
 }
 
-QStringList PollutantOverviewPage::parseCSVLine(const QString& line) const
+void PollutantOverviewPage::appendDataset(const WaterDataset& source, int firstRow)
 {
-    QStringList result;
-    QString currentField;
-    bool insideQuotes = false;
-
-    for (QChar ch : line) {
-        if (ch == '"') {
-            insideQuotes = !insideQuotes;
-        } else if (ch == ',' && !insideQuotes) {
-            result.append(currentField.trimmed());
-            currentField.clear();
-        } else {
-            currentField.append(ch);
-        }
+    TraceScope trace("PollutantOverviewPage::appendDataset");
+
+    dataset = &source;
+
+    const QVector<quint32>& siteRanks = source.samplingPointRanks();
+    dataModel->beginAppend(source.samplingPointRankMoves());
+
+    const QVector<WaterRecord>& records = source.records();
+    source.categoryRows(PollutantCategory::PollutantOverview).forEachSetFrom(firstRow, [&](int index) {
+        const WaterRecord& record = records[index];
+        const QStringList cells = recordCells(record);
+        dataModel->appendRow(cells, siteRanks[record.samplingPointId], timestampKey(record.date));
+        addChartSample(cells);
+    });
+
+    dataModel->endAppend();
+
+    // Month groups are counted afresh; the selection stays if it still exists
+    const QString selected = pollutantDateDropdown->currentText();
+    {
+        const QSignalBlocker blocker(pollutantDateDropdown);
+        pollutantDateDropdown->clear();
+        dropdownGroups.clear();
+        populateDropdown();
+        pollutantDateDropdown->setCurrentIndex(qMax(0, pollutantDateDropdown->findText(selected)));
     }
-
-    if (!currentField.isEmpty()) {
-        result.append(currentField.trimmed());
+    if (pollutantDateDropdown->count() > 0) {
+        createChartForGroup(pollutantDateDropdown->currentText());
     }
+}
+
+QStringList PollutantOverviewPage::recordCells(const WaterRecord& record)
+{
+    // Compliance check with per-pollutant thresholds, in µg/L
+    Classification classification = classifyRecord(PollutantCategory::PollutantOverview, record);
 
-    return result;
+    const QString result = classification.numeric ? QString::number(classification.value, 'f', 5) : "N/A";
+    return {record.samplingPoint, record.date, record.determinand, result, classification.unit, classification.status};
 }
 
-void PollutantOverviewPage::populateDropdown() {
-    QMap<QString, QStringList> pollutantMonthTimesMap;
+void PollutantOverviewPage::addChartSample(const QStringList& cells)
+{
+    const QDateTime dateTime = QDateTime::fromString(cells[1], "yyyy-MM-ddThh:mm:ss");
+    if (!dateTime.isValid()) {
+        return;
+    }
 
-    for (int i = 0; i < dataModel->rowCount(); ++i) {
-        QString pollutant = dataModel->item(i, 2)->text();
-        QString date = dataModel->item(i, 1)->text();
+    ChartSample sample;
+    sample.samplingPoint = cells[0];
+    sample.time = dateTime.toString("yyyy-MM-dd hh:mm:ss");
+    sample.label = QString("%1\n%2").arg(dateTime.toString("dd -"), dateTime.toString("hh:mm:ss"));
+    sample.value = cells[3].toDouble(&sample.numeric);
 
-        QDateTime dateTime = QDateTime::fromString(date, "yyyy-MM-ddThh:mm:ss");
-        if (!dateTime.isValid()) continue;
+    const QDate date = dateTime.date();
+    monthSamples[{cells[2], QDate(date.year(), date.month(), 1)}].append(sample);
+}
 
-        QString monthYear = dateTime.toString("yyyy-MM");
-        QString dayTime = dateTime.toString("yyyy-MM-dd hh:mm:ss");
+void PollutantOverviewPage::populateDropdown() {
+    TraceScope trace("PollutantOverviewPage::populateDropdown");
 
-        QString key = QString("%1 - %2").arg(pollutant, monthYear);
-        pollutantMonthTimesMap[key].append(dayTime);
-    }
+    // Monthly sample counts come from the dataset's trend cube, so building
+    // the dropdown no longer walks every table row
+    QStringList pollutants = {"112TCEthan", "Chloroform", "Benzene", "Toluene"};
+    pollutants.sort();
 
-    for (auto it = pollutantMonthTimesMap.begin(); it != pollutantMonthTimesMap.end(); ++it) {
-        QString key = it.key();
-        QStringList times = it.value();
-        times.sort(); 
-        int groupCount = (times.size() + 9) / 10; 
+    // Ten samples per chart, so each month splits into groups of ten
+    auto addMonth = [this](const QString& pollutant, const QDate& month, int count) {
+        QString key = QString("%1 - %2").arg(pollutant, month.toString("yyyy-MM"));
+        int groupCount = (count + 9) / 10;
 
         for (int group = 0; group < groupCount; ++group) {
             QString dropdownText = QString("%1 (%2)").arg(key).arg(group + 1);
-            dropdownGroups[dropdownText] = times.mid(group * 10, 10); 
+            dropdownGroups[dropdownText] = {pollutant, month, group};
             pollutantDateDropdown->addItem(dropdownText);
         }
-    }
+    };
 
-    connect(pollutantDateDropdown, &QComboBox::currentTextChanged, this, &PollutantOverviewPage::createChartForGroup);
-
-    // Automatically set default chart using the first dropdown item
-    if (pollutantDateDropdown->count() > 0) {
-        QString defaultSelection = pollutantDateDropdown->itemText(0);
-        createChartForGroup(defaultSelection);
+    if (!dataset->hasSummaries()) {
+        // Trend cube still building: count the table's samples per pollutant and month
+        for (auto it = monthSamples.cbegin(); it != monthSamples.cend(); ++it) {
+            addMonth(it.key().first, it.key().second, it.value().size());
+        }
+    } else {
+        for (const QString& pollutant : pollutants) {
+            int determinand = dataset->determinandIndex(pollutant);
+            if (determinand < 0) continue;
+
+            const QVector<TrendBucket> months = dataset->trends().series(determinand, TrendCube::ALL_SITES, TimeGranularity::Month);
+            for (const TrendBucket& month : months) {
+                addMonth(pollutant, month.start, month.count);
+            }
+        }
     }
+
+    // Adding the first item already selected it, which requested its chart
 }
 
 void PollutantOverviewPage::createChartForGroup(const QString& selection) {
@@ -252,67 +220,69 @@ void PollutantOverviewPage::createChartForGroup(const QString& selection) {
         return;
     }
 
-    QChart* chart = new QChart();
-    QBarSeries* series = new QBarSeries();
+    // Only the selected month's samples go to the pool, where the group is
+    // picked out; the chart itself is built on the GUI thread
+    const ChartGroup group = dropdownGroups.value(selection);
+    chartJob.request({monthSamples.value({group.pollutant, group.month}), group, selection});
+}
 
-    QStringList times = dropdownGroups[selection];
-    times.sort(); 
-
-    QMap<QString, QMap<QString, double>> timeToSamplingPointMap; 
-    QSet<QString> uniqueSamplingPoints; 
-    QStringList xAxisLabels;   
-    QMap<QString, QString> timeToPollutantMap;
-
-    // Populate data for chart and X-axis labels
-    for (const QString& time : times) {
-        for (int i = 0; i < dataModel->rowCount(); ++i) {
-            QString rowDate = dataModel->item(i, 1)->text();
-            QString samplingPoint = dataModel->item(i, 0)->text();
-            QString result = dataModel->item(i, 3)->text();
-            QString pollutant = dataModel->item(i, 2)->text();
-
-            QDateTime dateTime = QDateTime::fromString(rowDate, "yyyy-MM-ddThh:mm:ss");
-            if (!dateTime.isValid() || dateTime.toString("yyyy-MM-dd hh:mm:ss") != time) {
-                continue;
-            }
+PollutantOverviewPage::GroupSeries PollutantOverviewPage::computeGroupSeries(const GroupRequest& request,
+                                                                             const CancelToken& token)
+{
+    TraceScope trace("PollutantOverviewPage::computeGroupSeries");
 
-            bool ok;
-            double value = result.toDouble(&ok);
-            if (!ok) continue;
+    const QVector<ChartSample>& samples = request.samples;
 
-            if (!timeToSamplingPointMap.contains(time)) {
-                timeToSamplingPointMap[time] = QMap<QString, double>();
-            }
+    GroupSeries data;
+    data.selection = request.selection;
+    data.pollutant = request.group.pollutant;
+    data.times = groupTimes(samples, request.group);
+    if (data.times.isEmpty() || token.isCancelled()) {
+        return data;
+    }
 
-            timeToSamplingPointMap[time][samplingPoint] = value; 
-            uniqueSamplingPoints.insert(samplingPoint);   
-            timeToPollutantMap[time] = pollutant;    
+    // One pass over the month's samples, keeping those taken at one of the group's times
+    const QSet<QString> timeSet(data.times.begin(), data.times.end());
+    QMap<QString, QString> timeToLabel;
 
-            // Add formatted label for X-axis
-            QString formattedLabel = QString("%1\n%2")
-                                         .arg(dateTime.toString("dd -")) 
-                                         .arg(dateTime.toString("hh:mm:ss")); 
-            if (!xAxisLabels.contains(formattedLabel)) {
-                xAxisLabels.append(formattedLabel);
-            }
+    for (const ChartSample& sample : samples) {
+        if (!sample.numeric || !timeSet.contains(sample.time)) continue;
+
+        data.values[sample.time][sample.samplingPoint] = sample.value;
+        data.samplingPoints.insert(sample.samplingPoint);
+        timeToLabel[sample.time] = sample.label;
+    }
+
+    for (const QString& time : data.times) {
+        if (timeToLabel.contains(time) && !data.xAxisLabels.contains(timeToLabel[time])) {
+            data.xAxisLabels.append(timeToLabel[time]);
         }
     }
+    return data;
+}
+
+void PollutantOverviewPage::showGroupSeries(const GroupSeries& data) {
+    TraceScope trace("PollutantOverviewPage::showGroupSeries");
+
+    if (data.times.isEmpty()) {
+        qWarning() << "No samples for selection:" << data.selection;
+        return;
+    }
+
+    QChart* chart = new QChart();
+    QBarSeries* series = new QBarSeries();
 
     // Add bar sets for each sampling point
-    for (const QString& samplingPoint : uniqueSamplingPoints) {
+    for (const QString& samplingPoint : data.samplingPoints) {
         QBarSet* barSet = new QBarSet(samplingPoint);
 
-        for (const QString& time : times) {
-            if (timeToSamplingPointMap[time].contains(samplingPoint)) {
-                barSet->append(timeToSamplingPointMap[time][samplingPoint]);
-            } else {
-                barSet->append(0.0); 
-            }
+        for (const QString& time : data.times) {
+            barSet->append(data.values.value(time).value(samplingPoint, 0.0));
         }
         series->append(barSet);
 
         // Connect hover event to show tooltip
-        connect(barSet, &QBarSet::hovered, this, [this, barSet, samplingPoint, pollutant = timeToPollutantMap.value(times.first())](bool state, int index) {
+        connect(barSet, &QBarSet::hovered, this, [this, barSet, samplingPoint, pollutant = data.pollutant](bool state, int index) {
             if (state) {
                 // Show tooltip when hovering over the bar
                 double value = barSet->at(index);
@@ -333,7 +303,7 @@ void PollutantOverviewPage::createChartForGroup(const QString& selection) {
 
     // Configure X-axis with custom labels (day on one line, time on the next)
     QBarCategoryAxis* xAxis = new QBarCategoryAxis();
-    xAxis->append(xAxisLabels); 
+    xAxis->append(data.xAxisLabels); 
     xAxis->setLabelsAngle(0);
     xAxis->setTitleText("Day and Time (dd - hh:mm:ss)"); 
     chart->addAxis(xAxis, Qt::AlignBottom);
@@ -347,7 +317,7 @@ void PollutantOverviewPage::createChartForGroup(const QString& selection) {
     series->attachAxis(yAxis);
 
     // Chart title and legend
-    QString title = selection.left(selection.lastIndexOf("(")).trimmed();
+    QString title = data.selection.left(data.selection.lastIndexOf("(")).trimmed();
     chart->setTitle(QString("Trends for %1 - Threshold = 1.0µg/L").arg(title));
     chart->legend()->setVisible(true);
     chart->legend()->setAlignment(Qt::AlignBottom);
@@ -355,18 +325,23 @@ void PollutantOverviewPage::createChartForGroup(const QString& selection) {
     chartView->setChart(chart);
 }
 
-void PollutantOverviewPage::filterTableData(const QString& text)
+QStringList PollutantOverviewPage::groupTimes(const QVector<ChartSample>& samples, const ChartGroup& group)
 {
-    for (int i = 0; i < dataModel->rowCount(); ++i) {
-        bool matches = false;
-        for (int j = 0; j < dataModel->columnCount(); ++j) {
-            if (dataModel->item(i, j)->text().contains(text, Qt::CaseInsensitive)) {
-                matches = true;
-                break;
-            }
-        }
-        tableView->setRowHidden(i, !matches);
+    QStringList times;
+    times.reserve(samples.size());
+    for (const ChartSample& sample : samples) {
+        times.append(sample.time);
     }
+
+    times.sort();
+    return times.mid(group.index * 10, 10);
+}
+
+void PollutantOverviewPage::filterTableData(const QString& text)
+{
+    TraceScope trace("PollutantOverviewPage::filterTableData");
+
+    dataModel->setFilter(text);
 }
 
 QString PollutantOverviewPage::getPollutantInfo(const QString& pollutant) const {
@@ -6,7 +6,6 @@
 #include <QLineEdit>
 #include <QLabel>
 #include <QTableView>
-#include <QStandardItemModel>
 #include <QChartView>
 #include <QPushButton>
 #include <QComboBox>
@@ -17,16 +16,25 @@
 #include <QtCharts/QValueAxis>
 #include <QMap>
 #include <QStringList>
+#include <QDate>
+#include <QSet>
+#include <QVector>
+#include "dataset.hpp"
+#include "rowtablemodel.hpp"
+#include "latestjob.hpp"
 
 class PollutantOverviewPage : public QWidget {
     Q_OBJECT
 
 public:
     // Constructor
-    explicit PollutantOverviewPage(QWidget* parent = nullptr);
+    explicit PollutantOverviewPage(TaskScheduler* scheduler, QWidget* parent = nullptr);
 
-    // New method to provide a CSV file to the page
-    void loadCsvFile(const QString& filePath);
+    // Materialise the page from the shared parsed dataset
+    void loadDataset(const WaterDataset& dataset);
+
+    // Add the rows a followed file gained from firstRow on, without reloading
+    void appendDataset(const WaterDataset& dataset, int firstRow);
 
 signals:
     // Signal to navigate back to the dashboard
@@ -37,21 +45,62 @@ private:
     QVBoxLayout* layout;
     QLineEdit* searchBox;
     QTableView* tableView;
-    QStandardItemModel* dataModel;
+    RowTableModel* dataModel;
     QChartView* chartView;
     QComboBox* pollutantDateDropdown;
     QPushButton* backButton;
 
-    // Add dropdownGroups to store times for each group
-    QMap<QString, QStringList> dropdownGroups;
+    // Dropdown entry: up to ten sample times of one pollutant within a month
+    struct ChartGroup {
+        QString pollutant;
+        QDate month;
+        int index = 0;
+    };
+
+    // Add dropdownGroups to store the group behind each dropdown entry
+    QMap<QString, ChartGroup> dropdownGroups;
+    const WaterDataset* dataset = nullptr;
+    // Chart columns of one table row, with its time parsed once as the row
+    // is loaded, so chart jobs never parse dates or read the model
+    struct ChartSample {
+        QString samplingPoint;
+        QString time;        // "yyyy-MM-dd hh:mm:ss", which sorts in time order
+        QString label;       // X-axis label, day on one line and time on the next
+        double value = 0.0;
+        bool numeric = false;
+    };
+    // Samples of each (pollutant, month), in the order the rows were added
+    QMap<QPair<QString, QDate>, QVector<ChartSample>> monthSamples;
+
+    // Bars of one dropdown group, computed by a pool task
+    struct GroupSeries {
+        QString selection;
+        QStringList times;                            // Up to ten sample times, in order
+        QMap<QString, QMap<QString, double>> values;  // Result by time, then sampling point
+        QSet<QString> samplingPoints;
+        QStringList xAxisLabels;
+        QString pollutant;                            // Pollutant at the first time, for tooltips
+    };
+
+    // Inputs of one chart job: the month's samples and the selected group
+    struct GroupRequest {
+        QVector<ChartSample> samples;
+        ChartGroup group;
+        QString selection;
+    };
+    LatestJob<GroupRequest, GroupSeries> chartJob; // Only the newest selection is drawn
 
     // Function to get pollutant information (health risk, compliance, etc.)
     QString getPollutantInfo(const QString& pollutant) const;
 
-    void loadData(const QString& filePath);
-    QStringList parseCSVLine(const QString& line) const;
+    void loadData(const WaterDataset& dataset);
+    static QStringList recordCells(const WaterRecord& record);
+    void addChartSample(const QStringList& cells);
     void populateDropdown();
     void createChartForGroup(const QString& selection);
+    static QStringList groupTimes(const QVector<ChartSample>& samples, const ChartGroup& group);
+    static GroupSeries computeGroupSeries(const GroupRequest& request, const CancelToken& token);
+    void showGroupSeries(const GroupSeries& data);
 
     // Inner class for compliance delegate
     class ComplianceDelegate : public QStyledItemDelegate {
@@ -1,16 +1,43 @@
 #include "pops.hpp"
-#include <QFile>
-#include <QTextStream>
-#include <QStandardItem>
+#include "categories.hpp"
+#include "tracedchartview.hpp"
+#include "rowsort.hpp"
 #include <QHeaderView>
+#include <QSet>
 #include <QtCharts/QCategoryAxis>
 #include <QtCharts/QValueAxis>
 #include <QtCharts/QScatterSeries>
 #include <QComboBox>
 #include <QToolTip>
 #include <QDebug>
+#include <algorithm>
 
-POPsPage::POPsPage(QWidget* parent) : QWidget(parent)
+namespace {
+
+// Add an item to a dropdown kept in text order, unless it is already there
+void insertSortedItem(QComboBox* dropdown, const QString& text)
+{
+    int low = 0;
+    int high = dropdown->count();
+    while (low < high) {
+        const int middle = (low + high) / 2;
+        if (dropdown->itemText(middle) < text) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    if (low == dropdown->count() || dropdown->itemText(low) != text) {
+        dropdown->insertItem(low, text);
+    }
+}
+
+}
+
+POPsPage::POPsPage(TaskScheduler* scheduler, QWidget* parent)
+    : QWidget(parent),
+      chartJob(scheduler, this, &POPsPage::computePointSeries,
+               [this](const PointSeries& data) { showPointSeries(data); })
 {
     // Initialize the layout
     layout = new QVBoxLayout(this);
@@ -28,31 +55,40 @@ POPsPage::POPsPage(QWidget* parent) : QWidget(parent)
 
     // Create a search box
     searchBox = new QLineEdit(this);
+    searchBox->setObjectName("searchBox");
     searchBox->setPlaceholderText("Search...");
     connect(searchBox, &QLineEdit::textChanged, this, &POPsPage::filterTableData);
 
     // Create the table view and model
     tableView = new QTableView(this);
-    dataModel = new QStandardItemModel(this);
-    dataModel->setHorizontalHeaderLabels({"Sampling Point", "Date", "Pollutant", "Result", "Unit", "Compliance (UK/EU Regulations)"});
+    dataModel = new RowTableModel({"Sampling Point", "Date", "Pollutant", "Result", "Unit", "Compliance (UK/EU Regulations)"}, scheduler, this);
+    dataModel->setColumnKind(1, RowTableModel::ColumnKind::Time);
+    dataModel->setColumnKind(3, RowTableModel::ColumnKind::Number);
     tableView->setModel(dataModel);
     tableView->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    dataModel->attachHeader(tableView->horizontalHeader());
 
     // Set custom delegate for Compliance column
     tableView->setItemDelegateForColumn(5, new ComplianceDelegate(this));
 
+    // Pages through large aggregation-mode tables
+    pager = new AggregatePager(this);
+    connect(pager, &AggregatePager::pageChanged, this, &POPsPage::showAggregatePage);
+
     // Create dropdown for sampling points and dates
     samplingPointDropdown = new QComboBox(this);
+    samplingPointDropdown->setObjectName("samplingPointDropdown");
     connect(samplingPointDropdown, &QComboBox::currentTextChanged, this, &POPsPage::createChartForPoint);
 
     // Create the chart view
-    chartView = new QChartView(this);
+    chartView = new TracedChartView(this);
     chartView->setRenderHint(QPainter::Antialiasing);
 
     // Add widgets to the layout
     layout->addWidget(title);
     layout->addWidget(searchBox);
     layout->addWidget(tableView);
+    layout->addWidget(pager);
     layout->addWidget(samplingPointDropdown);
     layout->addWidget(chartView);
     layout->addWidget(backButton);
@@ -61,131 +97,156 @@ POPsPage::POPsPage(QWidget* parent) : QWidget(parent)
     layout->setStretch(0, 1);
     layout->setStretch(1, 1); 
     layout->setStretch(2, 4); 
-    layout->setStretch(3, 1); 
-    layout->setStretch(4, 6); 
-    layout->setStretch(5, 1);
+    layout->setStretch(3, 0); 
+    layout->setStretch(4, 1); 
+    layout->setStretch(5, 6); 
+    layout->setStretch(6, 1);
 }
 
-void POPsPage::loadCsvFile(const QString& filePath)
+void POPsPage::loadDataset(const WaterDataset& dataset)
 {
+    TraceScope trace("POPsPage::loadDataset");
+
     // Clear the previous data
-    dataModel->removeRows(0, dataModel->rowCount());
+    dataModel->clear();
     samplingPointDropdown->clear();
+    loadedDataset = &dataset;
+    sourceRows.clear();
+    loadedAggregates = nullptr;
+    pager->reset();
 
     // Load new data
-    loadData(filePath);
+    loadData(dataset);
     populateDropdown();
 }
 
-void POPsPage::loadData(const QString& filePath)
+void POPsPage::loadData(const WaterDataset& dataset)
 {
-    QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        qWarning() << "Unable to open file:" << filePath;
-        return;
-    }
-
-    QTextStream in(&file);
-    bool isHeader = true;
+    TraceScope trace("POPsPage::loadData");
 
-    while (!in.atEnd()) {
-        QString line = in.readLine();
-        if (isHeader) {
-            isHeader = false;
-            continue;
-        }
+    const QVector<quint32>& siteRanks = dataset.samplingPointRanks();
+    dataModel->beginRows(dataset.categoryRows(PollutantCategory::POPs).count());
 
-        QStringList columns = parseCSVLine(line);
-        if (columns.size() >= 12) {
-            QString samplingPoint = columns[3].trimmed();
-            QString date = columns[4].trimmed();
-            QString pollutant = columns[6].trimmed();
+    // Individual PCB congeners only, as marked during parsing
+    const QVector<WaterRecord>& records = dataset.records();
+    dataset.categoryRows(PollutantCategory::POPs).forEachSet([&](int index) {
+        const WaterRecord& record = records[index];
+        dataModel->appendRow(recordCells(record), siteRanks[record.samplingPointId], timestampKey(record.date));
+        sourceRows.append(index);
+    });
 
-            // Skip "PCB : Total"
-            if (pollutant.compare("PCB : Total", Qt::CaseInsensitive) == 0) {
-                continue;
-            }
+    dataModel->endRows();
+}
 
-            QString result = columns[9].trimmed();
-            QString unit = columns[11].trimmed();
-
-            // Check for "PCB"
-            if (pollutant.contains("PCB", Qt::CaseInsensitive)) {
-                QList<QStandardItem*> row;
-
-                // Create items and set them as non-editable
-                auto makeItem = [](const QString& text) {
-                    QStandardItem* item = new QStandardItem(text);
-                    item->setFlags(item->flags() & ~Qt::ItemIsEditable); 
-                    return item;
-                };
-
-                row.append(makeItem(samplingPoint));
-                row.append(makeItem(date));
-                row.append(makeItem(pollutant));
-
-                // Process "Result" column
-                bool ok;
-                double numericResult = result.startsWith("<") ? result.mid(1).toDouble(&ok) : result.toDouble(&ok);
-                if (ok) {
-                    row.append(makeItem(QString::number(numericResult, 'f', 5)));
-                } else {
-                    row.append(makeItem("N/A"));
-                }
+void POPsPage::appendDataset(const WaterDataset& dataset, int firstRow)
+{
+    TraceScope trace("POPsPage::appendDataset");
+
+    const QString selected = samplingPointDropdown->currentText();
+    bool selectedGrew = false;
+
+    const QVector<quint32>& siteRanks = dataset.samplingPointRanks();
+    dataModel->beginAppend(dataset.samplingPointRankMoves());
+
+    const QVector<WaterRecord>& records = dataset.records();
+    dataset.categoryRows(PollutantCategory::POPs).forEachSetFrom(firstRow, [&](int index) {
+        const WaterRecord& record = records[index];
+        const QStringList cells = recordCells(record);
+        dataModel->appendRow(cells, siteRanks[record.samplingPointId], timestampKey(record.date));
+        sourceRows.append(index);
+
+        // Chart rows take new rows after the earlier ones; charts plot a
+        // sample's rows by position within it, so this order is all they need
+        chartIndices.insert(index, chartRows.size());
+        chartRows.append({cells[0], cells[1], cells[2], cells[3]});
+        const QString locationDate = QString("%1 - %2").arg(record.samplingPoint, record.date);
+        insertSortedItem(samplingPointDropdown, locationDate);
+        selectedGrew = selectedGrew || locationDate == selected;
+    });
+
+    dataModel->endAppend();
+
+    // Redraw the chart on show if it gained samples
+    if (selectedGrew) {
+        createChartForPoint(selected);
+    }
+}
 
-                row.append(makeItem(unit));
+QStringList POPsPage::recordCells(const WaterRecord& record)
+{
+    Classification classification = classifyRecord(PollutantCategory::POPs, record);
 
-                // Calculate compliance based on the "Result" column
-                QString compliance;
-                if (ok) {
-                    compliance = numericResult <= 0.001 ? "Compliant" : "Non-Compliant";
-                } else {
-                    compliance = "Unknown"; 
-                }
-                row.append(makeItem(compliance));
+    const QString result = classification.numeric ? QString::number(classification.value, 'f', 5) : "N/A";
+    return {record.samplingPoint, record.date, record.definition, result, classification.unit, classification.status};
+}
 
-                dataModel->appendRow(row);
-            }
-        }
-    }
+void POPsPage::loadAggregates(const AggregationIndex& aggregates)
+{
+    TraceScope trace("POPsPage::loadAggregates");
 
-    file.close();
-    dataModel->sort(0, Qt::AscendingOrder);
+    loadedDataset = nullptr;
+    sourceRows.clear();
+    loadedAggregates = &aggregates;
+    pager->reset();
+    showAggregatePage();
 }
 
-QStringList POPsPage::parseCSVLine(const QString& line) const
+void POPsPage::showAggregatePage()
 {
-    QStringList result;
-    QString currentField;
-    bool insideQuotes = false;
+    TraceScope trace("POPsPage::showAggregatePage");
 
-    for (QChar ch : line) {
-        if (ch == '"') {
-            insideQuotes = !insideQuotes;
-        } else if (ch == ',' && !insideQuotes) {
+    // Clear the previous data
+    dataModel->clear();
+    samplingPointDropdown->clear();
 
-            result.append(currentField.trimmed());
-            currentField.clear();
-        } else {
-            currentField.append(ch);
+    const AggregationIndex& aggregates = *loadedAggregates;
+    const QVector<quint32> siteRanks = aggregates.siteRanks();
+    const qint64 first = pager->firstRow();
+    qint64 matching = 0;
+    dataModel->beginRows();
+
+    // One row per sampling point, compound and month, so charts compare
+    // monthly means; only the current page's rows are copied into the model
+    aggregates.forEachAggregate([&](const AggregateKey& key, const MonthlyAggregate& aggregate) {
+        if (aggregate.classified == 0 || !aggregates.inCategory(key.determinand, PollutantCategory::POPs)) {
+            return;
+        }
+        const qint64 row = matching++;
+        if (row < first || row >= first + AggregationIndex::PAGE_ROWS) {
+            return;
         }
-    }
 
-    if (!currentField.isEmpty()) {
-        result.append(currentField.trimmed());
-    }
+        const QString mean = aggregate.valueCount > 0 ? QString::number(aggregate.mean(), 'f', 5) : "N/A";
+        dataModel->appendRow({aggregates.siteName(key.site), AggregationIndex::monthLabel(key.month),
+                              aggregates.determinandDefinition(key.determinand), mean,
+                              aggregates.determinandUnit(key.determinand), aggregate.categoryStatus()},
+                             siteRanks[key.site], key.month);
+    });
 
-    return result;
+    dataModel->endRows();
+    pager->setTotal(matching);
+    populateDropdown();
 }
 
 void POPsPage::populateDropdown()
 {
+    TraceScope trace("POPsPage::populateDropdown");
+
     QSet<QString> locationDateSet; 
+    chartJob.cancel(); // A chart of the previous data must not land on this one
+    chartRows.clear();
+    chartRows.reserve(dataModel->rowCount());
+    chartIndices.clear();
     for (int i = 0; i < dataModel->rowCount(); ++i) {
-        QString location = dataModel->item(i, 0)->text();
-        QString date = dataModel->item(i, 1)->text();
+        const int added = dataModel->addedRow(i);
+        if (added < sourceRows.size()) {
+            chartIndices.insert(sourceRows[added], i);
+        }
+        QString location = dataModel->text(i, 0);
+        QString date = dataModel->text(i, 1);
         QString locationDate = QString("%1 - %2").arg(location, date);
         locationDateSet.insert(locationDate); 
+        chartRows.append({location, date, dataModel->text(i, 2), dataModel->text(i, 3)});
     }
 
     QStringList sortedLocationDates = locationDateSet.values();
@@ -194,11 +255,6 @@ void POPsPage::populateDropdown()
 }
 
 void POPsPage::createChartForPoint(const QString& pointWithDate) {
-    QChart* chart = new QChart();
-    QLineSeries* series = new QLineSeries();
-    QMap<QString, QColor> colorMap;
-    QMap<QString, QScatterSeries*> dotMap;
-
     // Split the dropdown value into location and date
     int lastDashIndex = pointWithDate.lastIndexOf(" - ");
     if (lastDashIndex == -1) {
@@ -209,6 +265,83 @@ void POPsPage::createChartForPoint(const QString& pointWithDate) {
     QString location = pointWithDate.left(lastDashIndex).trimmed();
     QString date = pointWithDate.mid(lastDashIndex + 3).trimmed();
 
+    // Walk the rows on the pool; only the chart itself is built on the GUI thread.
+    // Once the dataset's site and date index is ready only the sample's own
+    // rows are walked.
+    PointRequest request{chartRows, location, date};
+    if (loadedDataset && loadedDataset->hasSiteDateIndex()) {
+        request.indexed = true;
+        const int site = loadedDataset->samplingPointIndex(location);
+        for (int row : loadedDataset->sampleRows(site, date)) {
+            auto chartIndex = chartIndices.constFind(row);
+            if (chartIndex != chartIndices.constEnd()) {
+                request.sampleRows.append(chartIndex.value());
+            }
+        }
+        std::sort(request.sampleRows.begin(), request.sampleRows.end());
+    }
+    chartJob.request(request);
+}
+
+POPsPage::PointSeries POPsPage::computePointSeries(const PointRequest& request, const CancelToken& token)
+{
+    TraceScope trace("POPsPage::computePointSeries");
+
+    const QVector<ChartRow>& rows = request.rows;
+    const QString& location = request.location;
+    const QString& date = request.date;
+
+    PointSeries data;
+    data.location = location;
+    data.date = date;
+    data.minIndex = 1;
+    data.maxIndex = 0;
+    data.maxValue = 0.0;
+
+    const int visitCount = request.indexed ? request.sampleRows.size() : rows.size();
+    for (int visit = 0; visit < visitCount; ++visit) {
+        // A newer selection makes this result worthless
+        if (visit % CANCEL_CHECK_ROWS == 0 && token.isCancelled()) {
+            return data;
+        }
+
+        const int i = request.indexed ? request.sampleRows[visit] : visit;
+        const ChartRow& row = rows[i];
+        if (row.location != location || row.date != date) {
+            continue;
+        }
+
+        // Rows are plotted by position within the sample, which rows appended
+        // to a followed file extend; the axis spans every row, plotted or not
+        const int position = ++data.maxIndex;
+
+        if (row.pollutant == "PCB : Total") {
+            continue;
+        }
+
+        bool ok;
+        double value = row.value.toDouble(&ok);
+        if (ok) {
+            data.points.append({row.pollutant, QPointF(position, value)});
+            data.maxValue = qMax(data.maxValue, value);
+        }
+    }
+    return data;
+}
+
+void POPsPage::showPointSeries(const PointSeries& data) {
+    TraceScope trace("POPsPage::showPointSeries");
+
+    if (data.points.isEmpty()) {
+        qWarning() << "No data found for the selected point.";
+        return;
+    }
+
+    QChart* chart = new QChart();
+    QLineSeries* series = new QLineSeries();
+    QMap<QString, QColor> colorMap;
+    QMap<QString, QScatterSeries*> dotMap;
+
     // Color mapping for pollutants
     colorMap["PCB - 028"] = Qt::blue;
     colorMap["PCB - 052"] = Qt::green;
@@ -220,60 +353,35 @@ void POPsPage::createChartForPoint(const QString& pointWithDate) {
     colorMap["PCB - 105"] = Qt::darkBlue;
     colorMap["PCB - 118"] = Qt::darkRed;
 
-    int minIndex = std::numeric_limits<int>::max();
-    int maxIndex = std::numeric_limits<int>::min();
-    double maxValue = 0.0;
-    double padding = (maxIndex - minIndex) * 0.02;
-    if (padding < 1) padding = 1;
-
-    // Process the data and populate series
-    for (int i = 0; i < dataModel->rowCount(); ++i) {
-        QString rowLocation = dataModel->item(i, 0)->text();
-        QString rowDate = dataModel->item(i, 1)->text();
-
-        if (rowLocation == location && rowDate == date) {
-            QString pollutant = dataModel->item(i, 2)->text();
-
-            if (pollutant == "PCB : Total") {
-                continue;
-            }
-
-            bool ok;
-            double value = dataModel->item(i, 3)->text().toDouble(&ok);
-
-            if (ok) {
-                QPointF dataPoint(i + 1, value);
-                series->append(dataPoint);
-
-                if (!dotMap.contains(pollutant)) {
-                    QScatterSeries* dotSeries = new QScatterSeries();
-                    dotSeries->setName(pollutant);
-                    dotSeries->setMarkerSize(10);
-                    dotSeries->setColor(colorMap[pollutant]);
-                    dotMap[pollutant] = dotSeries;
-
-                    // Tooltip on hover for dots
-                    connect(dotSeries, &QScatterSeries::hovered, this, [this, pollutant](const QPointF& point, bool state) {
-                        if (state) {
-                            QString pollutantInfo = getPollutantInfo(pollutant);
-                            QString tooltipText = QString("Pollutant: %1\nLevel: %2 µg/L\n%3")
-                                .arg(pollutant)
-                                .arg(point.y(), 0, 'f', 5)
-                                .arg(pollutantInfo);
-                            QToolTip::showText(QCursor::pos(), tooltipText);
-                        } else {
-                            QToolTip::hideText();
-                        }
-                    });
+    // Populate the series from the precomputed points
+    for (const auto& point : data.points) {
+        const QString& pollutant = point.first;
+        const QPointF& dataPoint = point.second;
+        series->append(dataPoint);
+
+        if (!dotMap.contains(pollutant)) {
+            QScatterSeries* dotSeries = new QScatterSeries();
+            dotSeries->setName(pollutant);
+            dotSeries->setMarkerSize(10);
+            dotSeries->setColor(colorMap[pollutant]);
+            dotMap[pollutant] = dotSeries;
+
+            // Tooltip on hover for dots
+            connect(dotSeries, &QScatterSeries::hovered, this, [this, pollutant](const QPointF& point, bool state) {
+                if (state) {
+                    QString pollutantInfo = getPollutantInfo(pollutant);
+                    QString tooltipText = QString("Pollutant: %1\nLevel: %2 µg/L\n%3")
+                        .arg(pollutant)
+                        .arg(point.y(), 0, 'f', 5)
+                        .arg(pollutantInfo);
+                    QToolTip::showText(QCursor::pos(), tooltipText);
+                } else {
+                    QToolTip::hideText();
                 }
-
-                dotMap[pollutant]->append(dataPoint);
-
-                minIndex = qMin(minIndex, i);
-                maxIndex = qMax(maxIndex, i);
-                maxValue = qMax(maxValue, value);
-            }
+            });
         }
+
+        dotMap[pollutant]->append(dataPoint);
     }
 
     // Add threshold line
@@ -296,26 +404,17 @@ void POPsPage::createChartForPoint(const QString& pointWithDate) {
         chart->addSeries(dotSeries);
     }
 
-    for (int i = 0; i < dataModel->rowCount(); ++i) {
-    QString rowLocation = dataModel->item(i, 0)->text();
-    QString rowDate = dataModel->item(i, 1)->text();
-
-    if (rowLocation == location && rowDate == date) {
-        minIndex = qMin(minIndex, i);
-        maxIndex = qMax(maxIndex, i);
-        }
-    }
-
-    // Create and configure the x-axis
+    // Create and configure the x-axis, one step clear of the sample's first and last rows
+    const double padding = 1;
     QValueAxis* xAxis = new QValueAxis();
-    xAxis->setTitleText("Index"); 
+    xAxis->setTitleText("Row in sample"); 
     xAxis->setLabelsVisible(true); 
-    xAxis->setRange(minIndex - padding, maxIndex + padding); 
+    xAxis->setRange(data.minIndex - padding, data.maxIndex + padding); 
     chart->addAxis(xAxis, Qt::AlignBottom);
 
     // Create and configure the y-axis
     QValueAxis* yAxis = new QValueAxis();
-    yAxis->setRange(0, maxValue + (0.1 * maxValue));
+    yAxis->setRange(0, data.maxValue + (0.1 * data.maxValue));
     yAxis->setTitleText("Pollutant Level (µg/L)");
     chart->addAxis(yAxis, Qt::AlignLeft);
 
@@ -329,22 +428,27 @@ void POPsPage::createChartForPoint(const QString& pointWithDate) {
         dotSeries->attachAxis(yAxis);
     }
 
-    chart->setTitle(QString("Pollutant Levels at %1 on %2").arg(location, date));
+    chart->setTitle(QString("Pollutant Levels at %1 on %2").arg(data.location, data.date));
     chartView->setChart(chart);
 }
 
 void POPsPage::filterTableData(const QString& text)
 {
-    for (int i = 0; i < dataModel->rowCount(); ++i) {
-        bool matches = false;
-        for (int j = 0; j < dataModel->columnCount(); ++j) {
-            if (dataModel->item(i, j)->text().contains(text, Qt::CaseInsensitive)) {
-                matches = true;
-                break;
-            }
+    TraceScope trace("POPsPage::filterTableData");
+
+    // The dataset's search index answers the columns copied from the
+    // records; only the result, unit and compliance cells are scanned
+    if (loadedDataset && loadedDataset->hasSearchIndex() && !text.isEmpty()) {
+        const RowBitmap found = loadedDataset->searchIndex().matches(text,
+            {SearchIndex::Field::SamplingPoint, SearchIndex::Field::Date, SearchIndex::Field::Definition});
+        QVector<bool> matched(sourceRows.size());
+        for (int row = 0; row < sourceRows.size(); ++row) {
+            matched[row] = sourceRows[row] < found.size() && found.test(sourceRows[row]);
         }
-        tableView->setRowHidden(i, !matches);
+        dataModel->setFilter(text, matched, {3, 4, 5});
+        return;
     }
+    dataModel->setFilter(text);
 }
 
 // Pollutant info for the tooltip
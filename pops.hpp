@@ -5,13 +5,21 @@
 #include <QVBoxLayout>
 #include <QLabel>
 #include <QTableView>
-#include <QStandardItemModel>
 #include <QLineEdit>
 #include <QComboBox>
 #include <QtCharts/QChartView>
 #include <QtCharts/QLineSeries>
 #include <QStyledItemDelegate>
 #include <QPainter>
+#include <QHash>
+#include <QPair>
+#include <QPointF>
+#include <QVector>
+#include "dataset.hpp"
+#include "rowtablemodel.hpp"
+#include "aggregates.hpp"
+#include "aggregatepager.hpp"
+#include "latestjob.hpp"
 
 class POPsPage : public QWidget
 {
@@ -19,10 +27,16 @@ class POPsPage : public QWidget
 
 public:
     // Constructor
-    explicit POPsPage(QWidget* parent = nullptr);
+    explicit POPsPage(TaskScheduler* scheduler, QWidget* parent = nullptr);
 
-    // New method to provide a CSV file to the page
-    void loadCsvFile(const QString& filePath);
+    // Materialise the page from the shared parsed dataset
+    void loadDataset(const WaterDataset& dataset);
+
+    // Add the rows a followed file gained from firstRow on, without reloading
+    void appendDataset(const WaterDataset& dataset, int firstRow);
+
+    // Show monthly averages for files opened in aggregation mode
+    void loadAggregates(const AggregationIndex& aggregates);
 
 signals:
     // Signal to navigate back to the dashboard
@@ -34,16 +48,60 @@ private:
     QPushButton* backButton;              
     QTableView* tableView;               
     QLineEdit* searchBox;                 
-    QStandardItemModel* dataModel;       
+    RowTableModel* dataModel;          
     QComboBox* samplingPointDropdown;      
     QComboBox* dateDropdown;               
-    QChartView* chartView;                
+    QChartView* chartView;
+    AggregatePager* pager;                
+
+    // Chart columns of each table row, in table order with appended rows
+    // after the rest, copied when the dropdown is filled so chart jobs
+    // never read the model off the GUI thread
+    struct ChartRow {
+        QString location;
+        QString date;
+        QString pollutant;
+        QString value;
+    };
+    QVector<ChartRow> chartRows;
+
+    // Dataset the table was loaded from and the dataset row behind each
+    // table row, in the order rows were added; null and empty for aggregates
+    const WaterDataset* loadedDataset = nullptr;
+    QVector<int> sourceRows;
+    QHash<int, int> chartIndices; // Chart row of each dataset row
+
+    // Index the table pages through in aggregation mode; null otherwise
+    const AggregationIndex* loadedAggregates = nullptr;
+
+    // Points of one location and date's chart, computed by a pool task
+    struct PointSeries {
+        QString location;
+        QString date;
+        QVector<QPair<QString, QPointF>> points; // Pollutant and (position in sample, value)
+        int minIndex;                            // First and last position in the sample
+        int maxIndex;
+        double maxValue;
+    };
+
+    // Inputs of one chart job: the table snapshot and the selected sample
+    struct PointRequest {
+        QVector<ChartRow> rows;
+        QString location;
+        QString date;
+        bool indexed = false;     // Whether sampleRows holds the sample's chart rows
+        QVector<int> sampleRows;  // Ascending; found through the dataset's site and date index
+    };
+    LatestJob<PointRequest, PointSeries> chartJob; // Only the newest selection is drawn
 
-    void loadData(const QString& filePath); 
+    void loadData(const WaterDataset& dataset); 
+    static QStringList recordCells(const WaterRecord& record);
+    void showAggregatePage();
     void populateDropdown();               
     void createChartForPoint(const QString& point);  
+    static PointSeries computePointSeries(const PointRequest& request, const CancelToken& token);
+    void showPointSeries(const PointSeries& data);
     QString getPollutantInfo(const QString& pollutant) const; 
-    QStringList parseCSVLine(const QString& line) const;  
 
     // Inner class for compliance delegate
     class ComplianceDelegate : public QStyledItemDelegate {
@@ -0,0 +1,220 @@
+#include "report.hpp"
+#include "dataset.hpp"
+#include "determinands.hpp"
+#include <QMap>
+#include <QSaveFile>
+#include <QTemporaryFile>
+#include <QDebug>
+#include <memory>
+#include <vector>
+
+namespace {
+
+// Quote a string for JSON output
+QByteArray jsonString(const QString& text)
+{
+    QByteArray out = "\"";
+    for (char ch : text.toUtf8()) {
+        switch (ch) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(ch) < 0x20) {
+                out += QByteArray("\\u00") + QByteArray::number(static_cast<int>(ch), 16).rightJustified(2, '0');
+            } else {
+                out += ch;
+            }
+        }
+    }
+    return out + "\"";
+}
+
+// Quote a field for CSV output when it contains a delimiter or quote
+QByteArray csvField(const QString& text)
+{
+    QByteArray field = text.toUtf8();
+    if (field.contains(',') || field.contains('"') || field.contains('\n')) {
+        field.replace("\"", "\"\"");
+        return "\"" + field + "\"";
+    }
+    return field;
+}
+
+const char* CSV_HEADER =
+    "kind,category,site,date,determinand,definition,result,unit,status,"
+    "total,compliant,caution,exceedances,unknown\n";
+
+}
+
+void ComplianceReport::Counts::add(const QString& status)
+{
+    total++;
+    if (status == "Compliant")
+        compliant++;
+    else if (status == "Caution")
+        caution++;
+    else if (isExceedance(status))
+        exceedances++;
+    else
+        unknown++;
+}
+
+bool ComplianceReport::generate(const QString& inputPath, const QString& outputPath)
+{
+    const bool asJson = !outputPath.endsWith(".csv", Qt::CaseInsensitive);
+    const QList<PollutantCategory> categories = allCategories();
+
+    // One spool file of exceedance rows per category
+    std::vector<std::unique_ptr<QTemporaryFile>> spools;
+    for (int i = 0; i < categories.size(); ++i) {
+        spools.push_back(std::make_unique<QTemporaryFile>());
+        if (!spools.back()->open()) {
+            qWarning() << "Unable to create temporary file for report";
+            return false;
+        }
+    }
+
+    QVector<Counts> categoryCounts(categories.size());
+    QVector<qint64> spooledRows(categories.size(), 0);
+    QMap<QString, Counts> siteCounts; // Sorted by site name, bounded by distinct sites
+    qint64 rows = 0;
+    DeterminandDimension determinands;
+
+    bool ok = WaterDataset::readRecords(inputPath, [&](const WaterRecord& record) {
+        rows++;
+
+        if (record.columnCount >= 14) {
+            siteCounts[record.samplingPoint].add(complianceFlagStatus(record));
+        }
+
+        quint8 determinandCategories = 0;
+        determinands.intern(record, &determinandCategories);
+        const quint8 mask = rowCategories(determinandCategories, record.columnCount);
+        for (int i = 0; mask && i < categories.size(); ++i) {
+            if (!(mask & categoryBit(categories[i]))) {
+                continue;
+            }
+            Classification classification = classifyRecord(categories[i], record);
+            categoryCounts[i].add(classification.status);
+
+            if (isExceedance(classification.status)) {
+                QByteArray line = exceedanceLine(categories[i], record, classification, asJson);
+                if (asJson && spooledRows[i] > 0) {
+                    line.prepend(",\n");
+                }
+                spools[i]->write(line);
+                spooledRows[i]++;
+            }
+        }
+    });
+    if (!ok) {
+        return false;
+    }
+
+    QSaveFile output(outputPath);
+    if (!output.open(QIODevice::WriteOnly)) {
+        qWarning() << "Unable to write report:" << outputPath;
+        return false;
+    }
+
+    if (asJson) {
+        output.write("{\"input\":" + jsonString(inputPath) + ",\"rows\":" + QByteArray::number(rows)
+                     + ",\n\"categories\":[\n");
+    } else {
+        output.write(CSV_HEADER);
+    }
+
+    for (int i = 0; i < categories.size(); ++i) {
+        QByteArray counts = countsLine("category", categoryName(categories[i]), categoryCounts[i], asJson);
+        if (asJson) {
+            // Splice the spooled exceedance list into the category object
+            counts.chop(1);
+            output.write((i > 0 ? ",\n" : "") + counts + ",\"exceedanceRecords\":[\n");
+        } else {
+            output.write(counts);
+        }
+
+        QTemporaryFile& spool = *spools[i];
+        spool.seek(0);
+        while (!spool.atEnd()) {
+            output.write(spool.read(1 << 16));
+        }
+
+        if (asJson) {
+            output.write("]}");
+        }
+    }
+
+    if (asJson) {
+        output.write("],\n\"sites\":[\n");
+    }
+
+    bool firstSite = true;
+    for (auto it = siteCounts.constBegin(); it != siteCounts.constEnd(); ++it) {
+        if (asJson && !firstSite) {
+            output.write(",\n");
+        }
+        output.write(countsLine("site", it.key(), it.value(), asJson));
+        firstSite = false;
+    }
+
+    if (asJson) {
+        output.write("]}\n");
+    }
+
+    if (!output.commit()) {
+        qWarning() << "Unable to write report:" << outputPath;
+        return false;
+    }
+    return true;
+}
+
+QByteArray ComplianceReport::exceedanceLine(PollutantCategory category, const WaterRecord& record,
+                                            const Classification& classification, bool asJson) const
+{
+    const QString value = classification.numeric ? QString::number(classification.value) : record.result;
+
+    if (asJson) {
+        return "{\"site\":" + jsonString(record.samplingPoint)
+             + ",\"date\":" + jsonString(record.date)
+             + ",\"determinand\":" + jsonString(record.determinand)
+             + ",\"definition\":" + jsonString(record.definition)
+             + ",\"result\":" + jsonString(value)
+             + ",\"unit\":" + jsonString(classification.unit)
+             + ",\"status\":" + jsonString(classification.status) + "}";
+    }
+
+    return "exceedance," + csvField(categoryName(category))
+         + "," + csvField(record.samplingPoint)
+         + "," + csvField(record.date)
+         + "," + csvField(record.determinand)
+         + "," + csvField(record.definition)
+         + "," + csvField(value)
+         + "," + csvField(classification.unit)
+         + "," + csvField(classification.status) + ",,,,,\n";
+}
+
+QByteArray ComplianceReport::countsLine(const QString& kind, const QString& name, const Counts& counts,
+                                        bool asJson) const
+{
+    if (asJson) {
+        return "{\"" + kind.toUtf8() + "\":" + jsonString(name)
+             + ",\"total\":" + QByteArray::number(counts.total)
+             + ",\"compliant\":" + QByteArray::number(counts.compliant)
+             + ",\"caution\":" + QByteArray::number(counts.caution)
+             + ",\"exceedances\":" + QByteArray::number(counts.exceedances)
+             + ",\"unknown\":" + QByteArray::number(counts.unknown) + "}";
+    }
+
+    QByteArray line = kind.toUtf8();
+    line += kind == "site" ? ",," + csvField(name) : "," + csvField(name) + ",";
+    line += ",,,,,,," + QByteArray::number(counts.total)
+          + "," + QByteArray::number(counts.compliant)
+          + "," + QByteArray::number(counts.caution)
+          + "," + QByteArray::number(counts.exceedances)
+          + "," + QByteArray::number(counts.unknown) + "\n";
+    return line;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <QString>
+#include <QByteArray>
+#include "categories.hpp"
+
+// Headless compliance summary used by `watertool --report`. The input is
+// streamed once through the same reader and compliance rules as the GUI;
+// exceedance rows are spooled to temporary files rather than held in memory.
+class ComplianceReport
+{
+public:
+    // Write per-category and per-site counts plus exceedance lists.
+    // The output format follows the file suffix: .csv, otherwise JSON.
+    bool generate(const QString& inputPath, const QString& outputPath);
+
+private:
+    // Tally of compliance outcomes
+    struct Counts {
+        qint64 total = 0;
+        qint64 compliant = 0;
+        qint64 caution = 0;
+        qint64 exceedances = 0;
+        qint64 unknown = 0;
+
+        void add(const QString& status);
+    };
+
+    QByteArray exceedanceLine(PollutantCategory category, const WaterRecord& record,
+                              const Classification& classification, bool asJson) const;
+    QByteArray countsLine(const QString& kind, const QString& name, const Counts& counts,
+                          bool asJson) const;
+};
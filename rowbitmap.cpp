@@ -0,0 +1,36 @@
+#include "rowbitmap.hpp"
+
+void RowBitmap::clear()
+{
+    words.clear();
+    rowCount = 0;
+}
+
+void RowBitmap::resize(int rows)
+{
+    words.resize((rows + 63) / 64);
+    rowCount = rows;
+
+    // Rows dropped by a shrink must not reappear when the bitmap grows again
+    if (rows % 64 != 0) {
+        words.last() &= (quint64(1) << (rows % 64)) - 1;
+    }
+}
+
+void RowBitmap::append(const RowBitmap& other)
+{
+    const int base = rowCount;
+    resize(rowCount + other.rowCount);
+    other.forEachSet([this, base](int row) {
+        set(base + row);
+    });
+}
+
+int RowBitmap::count() const
+{
+    int total = 0;
+    for (quint64 word : words) {
+        total += qPopulationCount(word);
+    }
+    return total;
+}
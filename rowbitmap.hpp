@@ -0,0 +1,55 @@
+#pragma once
+
+#include <QVector>
+#include <QtAlgorithms>
+#include <utility>
+
+// One bit per dataset row, for row sets such as the rows of a pollutant
+// category. Visiting the set rows skips 64 unset rows per word, so sparse
+// sets cost little more than their members.
+class RowBitmap
+{
+public:
+    void clear();
+    void resize(int rows);
+    int size() const { return rowCount; }
+
+    void set(int row) { words[row >> 6] |= quint64(1) << (row & 63); }
+    bool test(int row) const { return (words[row >> 6] >> (row & 63)) & 1; }
+
+    // Add other's rows after this bitmap's, growing it by other.size()
+    void append(const RowBitmap& other);
+
+    // Number of set rows
+    int count() const;
+
+    // Call visit(row) for every set row in ascending order
+    template <typename Visit>
+    void forEachSet(Visit&& visit) const
+    {
+        forEachSetFrom(0, std::forward<Visit>(visit));
+    }
+
+    // As forEachSet, skipping rows before first
+    template <typename Visit>
+    void forEachSetFrom(int first, Visit&& visit) const
+    {
+        for (int word = first / 64; word < words.size(); ++word) {
+            quint64 bits = words[word];
+            if (word == first / 64) {
+                bits &= ~quint64(0) << (first % 64);
+            }
+            while (bits) {
+                visit(word * 64 + qCountTrailingZeroBits(bits));
+                bits &= bits - 1;
+            }
+        }
+    }
+
+    // Approximate heap bytes held by the bitmap
+    qint64 memoryUsage() const { return words.capacity() * qint64(sizeof(quint64)); }
+
+private:
+    QVector<quint64> words;
+    int rowCount = 0;
+};
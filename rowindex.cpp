@@ -0,0 +1,60 @@
+#include "rowindex.hpp"
+
+void RowOffsetIndex::clear()
+{
+    deltas.clear();
+    checkpoints.clear();
+    checkpointPositions.clear();
+    lastOffset = 0;
+    count = 0;
+}
+
+void RowOffsetIndex::append(qint64 offset)
+{
+    if (count % CHECKPOINT_INTERVAL == 0) {
+        checkpoints.append(offset);
+        checkpointPositions.append(deltas.size());
+    } else {
+        // LEB128: seven bits per byte, high bit set while more bytes follow
+        quint64 delta = static_cast<quint64>(offset - lastOffset);
+        while (delta >= 0x80) {
+            deltas.append(static_cast<char>((delta & 0x7F) | 0x80));
+            delta >>= 7;
+        }
+        deltas.append(static_cast<char>(delta));
+    }
+
+    lastOffset = offset;
+    count++;
+}
+
+qint64 RowOffsetIndex::offset(int row) const
+{
+    if (row < 0 || row >= count) {
+        return -1;
+    }
+
+    const int checkpoint = row / CHECKPOINT_INTERVAL;
+    qint64 value = checkpoints[checkpoint];
+    const uchar* data = reinterpret_cast<const uchar*>(deltas.constData()) + checkpointPositions[checkpoint];
+
+    for (int i = row % CHECKPOINT_INTERVAL; i > 0; --i) {
+        quint64 delta = 0;
+        int shift = 0;
+        uchar byte;
+        do {
+            byte = *data++;
+            delta |= static_cast<quint64>(byte & 0x7F) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+        value += static_cast<qint64>(delta);
+    }
+    return value;
+}
+
+qint64 RowOffsetIndex::memoryUsage() const
+{
+    return deltas.capacity()
+         + checkpoints.capacity() * qint64(sizeof(qint64))
+         + checkpointPositions.capacity() * qint64(sizeof(qsizetype));
+}
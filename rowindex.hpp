@@ -0,0 +1,31 @@
+#pragma once
+
+#include <QByteArray>
+#include <QVector>
+
+// Byte offset of every parsed row, kept so full rows can be re-read from the
+// file on demand instead of holding every column in memory. Offsets are
+// delta-encoded as variable-length integers (usually one or two bytes per
+// row) with an absolute checkpoint every CHECKPOINT_INTERVAL rows, so a
+// lookup decodes at most CHECKPOINT_INTERVAL - 1 deltas.
+class RowOffsetIndex
+{
+public:
+    static const int CHECKPOINT_INTERVAL = 64;
+
+    void clear();
+    void append(qint64 offset);
+
+    qint64 offset(int row) const;
+    int size() const { return count; }
+
+    // Approximate heap bytes held by the index
+    qint64 memoryUsage() const;
+
+private:
+    QByteArray deltas;                // Varint gaps between consecutive rows
+    QVector<qint64> checkpoints;      // Absolute offset of rows 0, 64, 128, ...
+    QVector<qsizetype> checkpointPositions; // Where each checkpoint's following deltas start
+    qint64 lastOffset = 0;
+    int count = 0;
+};
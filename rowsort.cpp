@@ -0,0 +1,35 @@
+#include "rowsort.hpp"
+#include <algorithm>
+#include <numeric>
+
+QVector<quint32> textRanks(const QStringList& labels)
+{
+    QVector<int> byText(labels.size());
+    std::iota(byText.begin(), byText.end(), 0);
+    std::sort(byText.begin(), byText.end(), [&labels](int a, int b) {
+        return labels[a] < labels[b];
+    });
+
+    QVector<quint32> ranks(labels.size());
+    quint32 rank = 0;
+    for (int i = 0; i < byText.size(); ++i) {
+        if (i > 0 && labels[byText[i]] != labels[byText[i - 1]]) {
+            rank++;
+        }
+        ranks[byText[i]] = rank;
+    }
+    return ranks;
+}
+
+quint64 timestampKey(QStringView timestamp)
+{
+    quint64 key = 0;
+    int digits = 0;
+    for (QChar ch : timestamp) {
+        if (ch.isDigit() && digits < 19) {
+            key = key * 10 + ch.digitValue();
+            digits++;
+        }
+    }
+    return key;
+}
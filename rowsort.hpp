@@ -0,0 +1,90 @@
+#pragma once
+
+#include <QStringList>
+#include <QVector>
+#include <algorithm>
+#include "taskscheduler.hpp"
+
+// Rank of each label in text order, equal labels sharing a rank. Lets rows
+// holding interned ids be ordered by their labels with integer keys.
+QVector<quint32> textRanks(const QStringList& labels);
+
+// Sortable integer for a "yyyy-MM-ddThh:mm:ss" timestamp: its digits read as
+// one number, so yyyyMMddhhmmss for a well-formed value
+quint64 timestampKey(QStringView timestamp);
+
+// Stable LSD radix sort of a permutation by keys[order[i]], a byte per pass.
+// Bytes that are the same in every key are skipped, so small keys cost one
+// or two passes. Sorting by a minor key and then a major one orders by both.
+template <typename Key>
+void radixSortByKey(QVector<int>& order, const QVector<Key>& keys)
+{
+    // Bits set in every key and in any key; bytes where they agree are constant
+    Key all = ~Key(0);
+    Key any = Key(0);
+    for (int row : order) {
+        all &= keys[row];
+        any |= keys[row];
+    }
+
+    QVector<int> sorted(order.size());
+    for (int shift = 0; shift < int(sizeof(Key)) * 8; shift += 8) {
+        if ((((all ^ any) >> shift) & 0xFF) == 0) {
+            continue;
+        }
+
+        int counts[257] = {};
+        for (int row : order) {
+            counts[((keys[row] >> shift) & 0xFF) + 1]++;
+        }
+        for (int byte = 0; byte < 256; ++byte) {
+            counts[byte + 1] += counts[byte];
+        }
+        for (int row : order) {
+            sorted[counts[(keys[row] >> shift) & 0xFF]++] = row;
+        }
+        order.swap(sorted);
+    }
+}
+
+// Slices below this are sorted on one thread
+static const int MIN_PARALLEL_SORT_ROWS = 16384;
+
+// Stable sort of a permutation by keys[order[i]] for keys that do not suit
+// radix passes, such as doubles. Slices are sorted on the pool, then merged
+// pairwise, each round's merges also running in parallel.
+template <typename Key>
+void parallelSortByKey(QVector<int>& order, const QVector<Key>& keys, TaskScheduler* scheduler)
+{
+    auto less = [&keys](int a, int b) {
+        return keys[a] < keys[b];
+    };
+
+    const int slices = scheduler ? qMin(scheduler->workerCount() * 2, int(order.size() / MIN_PARALLEL_SORT_ROWS))
+                                 : 1;
+    if (slices <= 1) {
+        std::stable_sort(order.begin(), order.end(), less);
+        return;
+    }
+
+    QVector<int> bounds(slices + 1);
+    for (int slice = 0; slice <= slices; ++slice) {
+        bounds[slice] = int(qint64(order.size()) * slice / slices);
+    }
+    scheduler->parallelFor(TaskPriority::Interactive, slices, [&](int slice) {
+        std::stable_sort(order.begin() + bounds[slice], order.begin() + bounds[slice + 1], less);
+    });
+
+    QVector<int> merged(order.size());
+    for (int width = 1; width < slices; width *= 2) {
+        const int pairs = (slices + 2 * width - 1) / (2 * width);
+        scheduler->parallelFor(TaskPriority::Interactive, pairs, [&](int pair) {
+            const int first = bounds[pair * 2 * width];
+            const int middle = bounds[qMin(pair * 2 * width + width, slices)];
+            const int last = bounds[qMin(pair * 2 * width + 2 * width, slices)];
+            std::merge(order.begin() + first, order.begin() + middle, order.begin() + middle,
+                       order.begin() + last, merged.begin() + first, less);
+        });
+        order.swap(merged);
+    }
+}
@@ -0,0 +1,411 @@
+#include "rowtablemodel.hpp"
+#include "rowsort.hpp"
+#include "tracing.hpp"
+#include <QGuiApplication>
+#include <QHeaderView>
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+// More separate runs of inserted rows than this reset views instead, which
+// costs them less than one insertion per run
+const int MAX_INSERT_RUNS = 64;
+
+// Sort value of a number or time cell; unreadable numbers such as "N/A"
+// sort after every value
+double sortValue(RowTableModel::ColumnKind kind, const QString& cell)
+{
+    if (kind == RowTableModel::ColumnKind::Time) {
+        return double(timestampKey(cell));
+    }
+    bool ok = false;
+    const double value = cell.toDouble(&ok);
+    return ok ? value : std::numeric_limits<double>::infinity();
+}
+
+}
+
+RowTableModel::RowTableModel(const QStringList& headers, TaskScheduler* scheduler, QObject* parent)
+    : QAbstractTableModel(parent), headers(headers), scheduler(scheduler), kinds(headers.size(), ColumnKind::Text),
+      columns(headers.size()), columnOrders(headers.size())
+{
+}
+
+void RowTableModel::setColumnKind(int column, ColumnKind kind)
+{
+    kinds[column] = kind;
+    columnOrders[column] = ColumnOrder();
+}
+
+void RowTableModel::beginRows(int expectedRows)
+{
+    beginResetModel();
+    for (QVector<QString>& column : columns) {
+        column.clear();
+        column.reserve(expectedRows);
+    }
+    ranks.clear();
+    ranks.reserve(expectedRows);
+    times.clear();
+    times.reserve(expectedRows);
+    columnOrders = QVector<ColumnOrder>(columns.size());
+    keys.clear();
+    sorted.clear();
+    filterText.clear();
+    matches.clear();
+}
+
+void RowTableModel::appendRow(const QStringList& cells, quint32 rank, quint64 time)
+{
+    for (int column = 0; column < columns.size(); ++column) {
+        columns[column].append(cells.value(column));
+    }
+    ranks.append(rank);
+    times.append(time);
+}
+
+void RowTableModel::endRows()
+{
+    TraceScope trace("RowTableModel::sortRows");
+
+    baseOrder.resize(ranks.size());
+    for (int row = 0; row < baseOrder.size(); ++row) {
+        baseOrder[row] = row;
+    }
+    // Minor key first; each pass is stable
+    radixSortByKey(baseOrder, times);
+    radixSortByKey(baseOrder, ranks);
+    shown = baseOrder;
+    endResetModel();
+    updateSortIndicator();
+}
+
+void RowTableModel::clear()
+{
+    beginRows();
+    endRows();
+}
+
+void RowTableModel::beginAppend(const QVector<quint32>& rankMoves)
+{
+    firstAppended = ranks.size();
+    if (!rankMoves.isEmpty()) {
+        for (quint32& rank : ranks) {
+            rank = rankMoves.value(rank, rank);
+        }
+    }
+}
+
+void RowTableModel::endAppend()
+{
+    TraceScope trace("RowTableModel::insertRows");
+
+    const int rowCount = ranks.size();
+    if (firstAppended == rowCount) {
+        return;
+    }
+
+    // Order the new rows among themselves, then merge them into each kept order
+    QVector<int> added(rowCount - firstAppended);
+    for (int i = 0; i < added.size(); ++i) {
+        added[i] = firstAppended + i;
+    }
+    QVector<int> addedBase = added;
+    radixSortByKey(addedBase, times);
+    radixSortByKey(addedBase, ranks);
+    baseOrder = mergeRows(baseOrder, addedBase, {});
+    if (!keys.isEmpty()) {
+        std::stable_sort(added.begin(), added.end(), [this](int a, int b) {
+            return rowLess(a, b, keys);
+        });
+        sorted = mergeRows(sorted, added, keys);
+    }
+    columnOrders = QVector<ColumnOrder>(columns.size()); // Rebuilt over every row when next asked for
+
+    if (!filterText.isEmpty()) {
+        matches.resize(rowCount);
+        for (int row = firstAppended; row < rowCount; ++row) {
+            matches[row] = false;
+            for (const QVector<QString>& column : columns) {
+                if (column[row].contains(filterText, Qt::CaseInsensitive)) {
+                    matches[row] = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    // Earlier rows keep their relative order, so the new ones form runs
+    // that can be inserted front to back
+    const QVector<int> target = visibleRows();
+    QVector<QPair<int, int>> runs; // First position and length
+    for (int position = 0; position < target.size(); ++position) {
+        if (target[position] < firstAppended) {
+            continue;
+        }
+        if (!runs.isEmpty() && runs.last().first + runs.last().second == position) {
+            runs.last().second++;
+        } else {
+            runs.append({position, 1});
+        }
+    }
+    firstAppended = rowCount;
+
+    if (runs.size() > MAX_INSERT_RUNS) {
+        beginResetModel();
+        shown = target;
+        endResetModel();
+        return;
+    }
+    for (const QPair<int, int>& run : runs) {
+        beginInsertRows(QModelIndex(), run.first, run.first + run.second - 1);
+        shown.insert(run.first, run.second, 0);
+        std::copy(target.begin() + run.first, target.begin() + run.first + run.second, shown.begin() + run.first);
+        endInsertRows();
+    }
+}
+
+const RowTableModel::ColumnOrder& RowTableModel::columnOrder(int column)
+{
+    ColumnOrder& cached = columnOrders[column];
+    if (cached.ranks.size() == baseOrder.size() && !baseOrder.isEmpty()) {
+        return cached;
+    }
+
+    TraceScope trace("RowTableModel::sortColumn");
+
+    const QVector<QString>& cells = columns[column];
+    cached.ascending = baseOrder;
+    if (kinds[column] == ColumnKind::Text) {
+        cached.ranks = textRanks(cells);
+        radixSortByKey(cached.ascending, cached.ranks);
+    } else {
+        QVector<double> values(cells.size());
+        for (int row = 0; row < cells.size(); ++row) {
+            values[row] = sortValue(kinds[column], cells[row]);
+        }
+        parallelSortByKey(cached.ascending, values, scheduler);
+
+        cached.ranks.resize(cells.size());
+        quint32 rank = 0;
+        for (int i = 0; i < cached.ascending.size(); ++i) {
+            if (i > 0 && values[cached.ascending[i]] != values[cached.ascending[i - 1]]) {
+                rank++;
+            }
+            cached.ranks[cached.ascending[i]] = rank;
+        }
+    }
+
+    // Descending keeps ties in default order too, rather than reversing them
+    const quint32 highest = cached.ranks.isEmpty() ? 0 : *std::max_element(cached.ranks.begin(), cached.ranks.end());
+    cached.reversedRanks.resize(cached.ranks.size());
+    for (int row = 0; row < cached.ranks.size(); ++row) {
+        cached.reversedRanks[row] = highest - cached.ranks[row];
+    }
+    cached.descending = baseOrder;
+    radixSortByKey(cached.descending, cached.reversedRanks);
+    return cached;
+}
+
+void RowTableModel::sortBy(const QList<SortKey>& sortKeys)
+{
+    TraceScope trace("RowTableModel::sortBy");
+
+    keys.clear();
+    for (const SortKey& key : sortKeys) {
+        if (key.column >= 0 && key.column < columns.size()) {
+            keys.append(key);
+        }
+    }
+
+    if (keys.size() == 1) {
+        const ColumnOrder& cached = columnOrder(keys.first().column);
+        sorted = keys.first().order == Qt::AscendingOrder ? cached.ascending : cached.descending;
+    } else if (keys.size() > 1) {
+        // Least significant key first, each pass stable, over the default order
+        sorted = baseOrder;
+        for (int key = keys.size() - 1; key >= 0; --key) {
+            const ColumnOrder& cached = columnOrder(keys[key].column);
+            radixSortByKey(sorted, keys[key].order == Qt::AscendingOrder ? cached.ranks : cached.reversedRanks);
+        }
+    } else {
+        sorted.clear();
+    }
+
+    beginResetModel();
+    updateShown();
+    endResetModel();
+    updateSortIndicator();
+}
+
+void RowTableModel::setFilter(const QString& text)
+{
+    QList<int> allColumns;
+    for (int column = 0; column < columns.size(); ++column) {
+        allColumns.append(column);
+    }
+    setFilter(text, QVector<bool>(), allColumns);
+}
+
+void RowTableModel::setFilter(const QString& text, const QVector<bool>& matched, const QList<int>& scanColumns)
+{
+    TraceScope trace("RowTableModel::setFilter");
+
+    filterText = text;
+    if (!text.isEmpty()) {
+        const int rowCount = ranks.size();
+        matches = matched;
+        matches.resize(rowCount);
+        for (int column : scanColumns) {
+            const QVector<QString>& cells = columns[column];
+            for (int row = 0; row < rowCount; ++row) {
+                if (!matches[row] && cells[row].contains(text, Qt::CaseInsensitive)) {
+                    matches[row] = true;
+                }
+            }
+        }
+    }
+
+    beginResetModel();
+    updateShown();
+    endResetModel();
+}
+
+bool RowTableModel::rowLess(int a, int b, const QList<SortKey>& by) const
+{
+    for (const SortKey& key : by) {
+        const QString& left = columns[key.column][a];
+        const QString& right = columns[key.column][b];
+        int order = 0;
+        if (kinds[key.column] == ColumnKind::Text) {
+            order = left.compare(right);
+        } else {
+            const double leftValue = sortValue(kinds[key.column], left);
+            const double rightValue = sortValue(kinds[key.column], right);
+            order = leftValue < rightValue ? -1 : rightValue < leftValue ? 1 : 0;
+        }
+        if (order != 0) {
+            return key.order == Qt::AscendingOrder ? order < 0 : order > 0;
+        }
+    }
+
+    // Ties fall back to the default order
+    if (ranks[a] != ranks[b]) {
+        return ranks[a] < ranks[b];
+    }
+    if (times[a] != times[b]) {
+        return times[a] < times[b];
+    }
+    return a < b;
+}
+
+QVector<int> RowTableModel::mergeRows(const QVector<int>& existing, const QVector<int>& added,
+                                      const QList<SortKey>& by) const
+{
+    QVector<int> merged(existing.size() + added.size());
+    std::merge(existing.begin(), existing.end(), added.begin(), added.end(), merged.begin(), [&](int a, int b) {
+        return rowLess(a, b, by);
+    });
+    return merged;
+}
+
+QVector<int> RowTableModel::visibleRows() const
+{
+    const QVector<int>& order = keys.isEmpty() ? baseOrder : sorted;
+    if (filterText.isEmpty()) {
+        return order;
+    }
+
+    QVector<int> visible;
+    for (int row : order) {
+        if (matches[row]) {
+            visible.append(row);
+        }
+    }
+    return visible;
+}
+
+void RowTableModel::updateShown()
+{
+    shown = visibleRows();
+}
+
+void RowTableModel::attachHeader(QHeaderView* header)
+{
+    sortHeader = header;
+    header->setSectionsClickable(true);
+    header->setSortIndicatorShown(true);
+    connect(header, &QHeaderView::sectionClicked, this, &RowTableModel::headerClicked);
+    updateSortIndicator();
+}
+
+void RowTableModel::headerClicked(int section)
+{
+    QList<SortKey> next = keys;
+    int existing = -1;
+    for (int key = 0; key < next.size(); ++key) {
+        if (next[key].column == section) {
+            existing = key;
+        }
+    }
+    auto flipped = [](Qt::SortOrder order) {
+        return order == Qt::AscendingOrder ? Qt::DescendingOrder : Qt::AscendingOrder;
+    };
+
+    if (QGuiApplication::keyboardModifiers() & Qt::ShiftModifier) {
+        if (existing >= 0) {
+            next[existing].order = flipped(next[existing].order);
+        } else {
+            next.append({section, Qt::AscendingOrder});
+        }
+    } else if (existing == 0) {
+        next = {{section, flipped(next.first().order)}};
+    } else {
+        next = {{section, Qt::AscendingOrder}};
+    }
+    sortBy(next);
+}
+
+void RowTableModel::updateSortIndicator()
+{
+    if (!sortHeader) {
+        return;
+    }
+    if (keys.isEmpty()) {
+        sortHeader->setSortIndicator(-1, Qt::AscendingOrder);
+    } else {
+        sortHeader->setSortIndicator(keys.first().column, keys.first().order);
+    }
+}
+
+int RowTableModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : shown.size();
+}
+
+int RowTableModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : columns.size();
+}
+
+QVariant RowTableModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= shown.size() || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    return text(index.row(), index.column());
+}
+
+QVariant RowTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole) {
+        return headers.value(section);
+    }
+    return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+void RowTableModel::sort(int column, Qt::SortOrder order)
+{
+    sortBy({{column, order}});
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QPointer>
+#include <QStringList>
+#include <QVector>
+
+class QHeaderView;
+class TaskScheduler;
+
+// Read-only table of text cells kept column by column. Rows are shown
+// through a permutation, so ordering them sorts integer indexes and never
+// moves a cell. Each row carries a rank (e.g. its sampling point's text
+// rank) and a time key, and rows are shown by rank, then time, then the
+// order they were added, until the user sorts by a column.
+//
+// A column's sort order is worked out on first request and cached until
+// the rows are replaced: text columns are ranked, number and time columns
+// are sorted on the pool. Sorting by several columns composes the cached
+// ranks with radix passes, and the search filter is applied on top of
+// whichever order is current.
+class RowTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum class ColumnKind { Text, Number, Time };
+
+    struct SortKey
+    {
+        int column;
+        Qt::SortOrder order;
+    };
+
+    RowTableModel(const QStringList& headers, TaskScheduler* scheduler, QObject* parent = nullptr);
+
+    // How a column's cells compare when sorting; Text unless set
+    void setColumnKind(int column, ColumnKind kind);
+
+    // Replace every row: add them between beginRows() and endRows(), which
+    // orders them and resets attached views once. Sorting and filtering
+    // start over with the new rows.
+    void beginRows(int expectedRows = 0);
+    void appendRow(const QStringList& cells, quint32 rank, quint64 time);
+    void endRows();
+    void clear();
+
+    // Add rows after the loaded ones without resetting views: add them
+    // between beginAppend() and endAppend(), which merges them into the
+    // current order and filter and announces them as inserted rows. Given
+    // rankMoves, every rank passed so far is first replaced by
+    // rankMoves[rank], for ranks that shift as new labels appear.
+    void beginAppend(const QVector<quint32>& rankMoves = QVector<quint32>());
+    void endAppend();
+
+    // Cell text of a row in display order
+    const QString& text(int row, int column) const { return columns[column][shown[row]]; }
+    // Position in the order rows were added of a row in display order
+    int addedRow(int row) const { return shown[row]; }
+
+    // Sort by the first key, then the next, and so on; no keys restores the default order
+    void sortBy(const QList<SortKey>& keys);
+    const QList<SortKey>& sortKeys() const { return keys; }
+
+    // Show only rows with a cell containing text, ignoring case; empty shows every row
+    void setFilter(const QString& text);
+
+    // As setFilter(text), for callers that already know some columns' answer
+    // from an index: rows set in matched, by the order they were added, pass
+    // as they are, and only scanColumns are searched for the rest
+    void setFilter(const QString& text, const QVector<bool>& matched, const QList<int>& scanColumns);
+
+    // Sort on header clicks: a click sorts by that column, toggling its order
+    // when it already leads; a shift-click adds the column as a further key
+    void attachHeader(QHeaderView* header);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+private:
+    // A column's cached order, filled in on first use
+    struct ColumnOrder
+    {
+        QVector<quint32> ranks;         // Dense rank of each added row's cell
+        QVector<quint32> reversedRanks; // Highest rank minus rank, for descending keys
+        QVector<int> ascending;         // Added rows by rank, ties in default order
+        QVector<int> descending;
+    };
+
+    const ColumnOrder& columnOrder(int column);
+    bool rowLess(int a, int b, const QList<SortKey>& by) const;
+    QVector<int> mergeRows(const QVector<int>& existing, const QVector<int>& added, const QList<SortKey>& by) const;
+    QVector<int> visibleRows() const;
+    void updateShown();
+    void headerClicked(int section);
+    void updateSortIndicator();
+
+    QStringList headers;
+    TaskScheduler* scheduler;
+    QVector<ColumnKind> kinds;
+    QVector<QVector<QString>> columns; // Cells of each column, in the order rows were added
+    QVector<quint32> ranks;
+    QVector<quint64> times;
+    QVector<int> baseOrder;            // Added rows by (rank, time)
+    QVector<ColumnOrder> columnOrders; // Indexed by column; empty until requested
+    QList<SortKey> keys;
+    QVector<int> sorted;               // Added rows in the order of keys, when there are keys
+    QString filterText;
+    QVector<bool> matches;             // Whether each added row passes the filter
+    QVector<int> shown;                // Added row at each displayed position
+    int firstAppended = 0;             // First row added since beginAppend()
+    QPointer<QHeaderView> sortHeader;
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <QString>
+#include "categories.hpp"
+
+// One distinct sampling point, with its location and exceedance totals
+struct SamplingPoint
+{
+    QString label;
+    double easting = 0.0;     // Column 15: British National Grid (OSGB36) metres
+    double northing = 0.0;    // Column 16
+    bool hasLocation = false; // Whether the coordinates parsed
+    double latitude = 0.0;    // WGS84 degrees, converted once per site at load
+    double longitude = 0.0;
+    quint32 samples = 0;      // Rows recorded at the site
+    quint32 classified = 0;   // ...that fall in a pollutant category
+    quint32 exceedances = 0;  // ...over that category's threshold
+    quint32 flaggedSamples = 0;   // ...carrying a compliance sample flag
+    quint32 flaggedCompliant = 0; // ...of which flagged compliant
+
+    // Classified and compliant rows counted under each category their
+    // determinand belongs to, indexed by PollutantCategory
+    quint32 categoryClassified[POLLUTANT_CATEGORY_COUNT] = {};
+    quint32 categoryCompliant[POLLUTANT_CATEGORY_COUNT] = {};
+
+    double exceedanceRate() const { return classified > 0 ? double(exceedances) / classified : 0.0; }
+};
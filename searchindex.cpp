@@ -0,0 +1,74 @@
+#include "searchindex.hpp"
+#include "dataset.hpp"
+
+namespace {
+
+const QString& fieldText(const WaterRecord& record, SearchIndex::Field field)
+{
+    switch (field) {
+    case SearchIndex::Field::SamplingPoint:
+        return record.samplingPoint;
+    case SearchIndex::Field::Date:
+        return record.date;
+    case SearchIndex::Field::Determinand:
+        return record.determinand;
+    case SearchIndex::Field::Definition:
+        break;
+    }
+    return record.definition;
+}
+
+}
+
+void SearchIndex::clear()
+{
+    for (Column& column : columns) {
+        column = Column();
+    }
+    rowCount = 0;
+}
+
+void SearchIndex::append(const QVector<WaterRecord>& records, int first)
+{
+    for (int field = 0; field < FIELD_COUNT; ++field) {
+        Column& column = columns[field];
+        column.rows.reserve(rowCount + records.size() - first);
+        for (int row = first; row < records.size(); ++row) {
+            const QString& text = fieldText(records[row], static_cast<Field>(field));
+            auto id = column.ids.constFind(text);
+            if (id == column.ids.constEnd()) {
+                id = column.ids.insert(text, quint32(column.values.size()));
+                column.values.append(text);
+            }
+            column.rows.append(id.value());
+        }
+    }
+    rowCount += records.size() - first;
+}
+
+RowBitmap SearchIndex::matches(const QString& text, const QList<Field>& fields) const
+{
+    RowBitmap found;
+    found.resize(rowCount);
+
+    for (Field field : fields) {
+        const Column& column = columns[static_cast<int>(field)];
+
+        QVector<bool> hit(column.values.size(), false);
+        bool any = false;
+        for (int id = 0; id < column.values.size(); ++id) {
+            hit[id] = column.values[id].contains(text, Qt::CaseInsensitive);
+            any = any || hit[id];
+        }
+        if (!any) {
+            continue;
+        }
+
+        for (int row = 0; row < rowCount; ++row) {
+            if (hit[column.rows[row]]) {
+                found.set(row);
+            }
+        }
+    }
+    return found;
+}
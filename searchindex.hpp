@@ -0,0 +1,41 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "rowbitmap.hpp"
+
+struct WaterRecord;
+
+// Case-insensitive substring search over the record columns that pages
+// show unchanged. Each column is dictionary encoded, so a search tests
+// every distinct value once and then marks the rows holding a matching
+// value, instead of testing the text of every row.
+class SearchIndex
+{
+public:
+    enum class Field { SamplingPoint, Date, Determinand, Definition };
+    static const int FIELD_COUNT = 4;
+
+    void clear();
+
+    // Encode records from first on after the rows already indexed
+    void append(const QVector<WaterRecord>& records, int first = 0);
+    int size() const { return rowCount; }
+
+    // Rows with any of the fields containing text, ignoring case
+    RowBitmap matches(const QString& text, const QList<Field>& fields) const;
+
+private:
+    struct Column
+    {
+        QStringList values;           // Distinct values, by id
+        QHash<QString, quint32> ids;
+        QVector<quint32> rows;        // Value id of each row
+    };
+
+    Column columns[FIELD_COUNT];      // Indexed by Field
+    int rowCount = 0;
+};
@@ -0,0 +1,47 @@
+#include "sitedateindex.hpp"
+#include "dataset.hpp"
+#include <algorithm>
+
+void SiteDateIndex::clear()
+{
+    order.clear();
+}
+
+void SiteDateIndex::append(const QVector<WaterRecord>& records, int first)
+{
+    auto less = [&records](int a, int b) {
+        const WaterRecord& left = records[a];
+        const WaterRecord& right = records[b];
+        if (left.samplingPointId != right.samplingPointId) {
+            return left.samplingPointId < right.samplingPointId;
+        }
+        const int dates = left.date.compare(right.date);
+        return dates != 0 ? dates < 0 : a < b;
+    };
+
+    // New rows are sorted on their own and merged in, so an append costs
+    // one pass over the existing rows
+    const int existing = order.size();
+    order.reserve(existing + records.size() - first);
+    for (int row = first; row < records.size(); ++row) {
+        order.append(row);
+    }
+    std::sort(order.begin() + existing, order.end(), less);
+    std::inplace_merge(order.begin(), order.begin() + existing, order.end(), less);
+}
+
+QVector<int> SiteDateIndex::rows(const QVector<WaterRecord>& records, int site, const QString& date) const
+{
+    auto before = [&](int row) {
+        const WaterRecord& record = records[row];
+        return record.samplingPointId != site ? record.samplingPointId < site : record.date < date;
+    };
+    auto notAfter = [&](int row) {
+        const WaterRecord& record = records[row];
+        return record.samplingPointId != site ? record.samplingPointId < site : record.date <= date;
+    };
+
+    const auto begin = std::partition_point(order.begin(), order.end(), before);
+    const auto end = std::partition_point(begin, order.end(), notAfter);
+    return QVector<int>(begin, end);
+}
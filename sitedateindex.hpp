@@ -0,0 +1,26 @@
+#pragma once
+
+#include <QString>
+#include <QVector>
+
+struct WaterRecord;
+
+// Rows of each sample, a (sampling point, date) pair, for charts of one
+// sample's results. Row numbers are kept sorted by site id, then date,
+// then row, so a sample's rows are one binary search away and come out in
+// file order.
+class SiteDateIndex
+{
+public:
+    void clear();
+
+    // Index records from first on after the rows already indexed
+    void append(const QVector<WaterRecord>& records, int first = 0);
+    int size() const { return order.size(); }
+
+    // Rows of the sample in ascending order; records must be the ones indexed
+    QVector<int> rows(const QVector<WaterRecord>& records, int site, const QString& date) const;
+
+private:
+    QVector<int> order;
+};
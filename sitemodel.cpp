@@ -0,0 +1,68 @@
+#include "sitemodel.hpp"
+
+SamplingPointModel::SamplingPointModel(QObject* parent) : QAbstractListModel(parent)
+{
+}
+
+void SamplingPointModel::setSites(const QVector<SamplingPoint>& sites)
+{
+    beginResetModel();
+    points.clear();
+    for (const SamplingPoint& site : sites) {
+        if (site.hasLocation) {
+            points.append(site);
+        }
+    }
+    endResetModel();
+}
+
+int SamplingPointModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : points.size();
+}
+
+QVariant SamplingPointModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= points.size()) {
+        return QVariant();
+    }
+
+    const SamplingPoint& site = points.at(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+    case LabelRole:
+        return site.label;
+    case EastingRole:
+        return site.easting;
+    case NorthingRole:
+        return site.northing;
+    case LatitudeRole:
+        return site.latitude;
+    case LongitudeRole:
+        return site.longitude;
+    case SamplesRole:
+        return site.samples;
+    case ClassifiedRole:
+        return site.classified;
+    case ExceedancesRole:
+        return site.exceedances;
+    case ExceedanceRateRole:
+        return site.exceedanceRate();
+    }
+    return QVariant();
+}
+
+QHash<int, QByteArray> SamplingPointModel::roleNames() const
+{
+    return {
+        {LabelRole, "label"},
+        {EastingRole, "easting"},
+        {NorthingRole, "northing"},
+        {LatitudeRole, "latitude"},
+        {LongitudeRole, "longitude"},
+        {SamplesRole, "samples"},
+        {ClassifiedRole, "classified"},
+        {ExceedancesRole, "exceedances"},
+        {ExceedanceRateRole, "exceedanceRate"}
+    };
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QVector>
+#include "dataset.hpp"
+
+// List of the dataset's located sampling points, exposed to QML by role
+class SamplingPointModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    enum Roles {
+        LabelRole = Qt::UserRole + 1,
+        EastingRole,
+        NorthingRole,
+        LatitudeRole,
+        LongitudeRole,
+        SamplesRole,
+        ClassifiedRole,
+        ExceedancesRole,
+        ExceedanceRateRole
+    };
+
+    explicit SamplingPointModel(QObject* parent = nullptr);
+
+    // Replace the model's contents; sites without coordinates are left out
+    void setSites(const QVector<SamplingPoint>& sites);
+    const QVector<SamplingPoint>& sites() const { return points; }
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+private:
+    QVector<SamplingPoint> points;
+};
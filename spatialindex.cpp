@@ -0,0 +1,214 @@
+#include "spatialindex.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Fold one cluster into another, weighting the centroid by member count
+void mergeCluster(SiteCluster& into, const SiteCluster& from)
+{
+    const int count = into.count + from.count;
+    into.centroid = (into.centroid * into.count + from.centroid * from.count) / count;
+    into.count = count;
+    into.classified += from.classified;
+    into.exceedances += from.exceedances;
+}
+
+}
+
+void SiteSpatialIndex::clear()
+{
+    extent = QRectF();
+    entries.clear();
+    entryKeys.clear();
+    levels.clear();
+}
+
+double SiteSpatialIndex::cellSize(int level)
+{
+    return BASE_CELL * double(1LL << level);
+}
+
+void SiteSpatialIndex::build(const QVector<SamplingPoint>& sites)
+{
+    clear();
+
+    for (int site = 0; site < sites.size(); ++site) {
+        if (sites[site].hasLocation) {
+            entries.append({0, site, QPointF(sites[site].easting, sites[site].northing)});
+        }
+    }
+    if (entries.isEmpty()) {
+        return;
+    }
+
+    // Grid origin is the south-west corner of the sites' bounds. Northings
+    // are stored as y unflipped, so extent.top() is the minimum northing and
+    // rows count northwards from it.
+    double minEasting = entries.first().position.x(), maxEasting = minEasting;
+    double minNorthing = entries.first().position.y(), maxNorthing = minNorthing;
+    for (const Entry& entry : entries) {
+        minEasting = qMin(minEasting, entry.position.x());
+        maxEasting = qMax(maxEasting, entry.position.x());
+        minNorthing = qMin(minNorthing, entry.position.y());
+        maxNorthing = qMax(maxNorthing, entry.position.y());
+    }
+    extent = QRectF(minEasting, minNorthing, maxEasting - minEasting, maxNorthing - minNorthing);
+
+    Level base;
+    base.cell = BASE_CELL;
+    base.columns = qint64(extent.width() / base.cell) + 1;
+    for (Entry& entry : entries) {
+        const qint64 column = qint64((entry.position.x() - extent.left()) / base.cell);
+        const qint64 row = qint64((entry.position.y() - extent.top()) / base.cell);
+        entry.key = row * base.columns + column;
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return a.key != b.key ? a.key < b.key : a.site < b.site;
+    });
+
+    entryKeys.reserve(entries.size());
+    for (const Entry& entry : entries) {
+        entryKeys.append(entry.key);
+    }
+
+    // Level 0: one cluster per occupied base cell
+    for (const Entry& entry : entries) {
+        SiteCluster cluster;
+        cluster.centroid = entry.position;
+        cluster.count = 1;
+        cluster.representative = entry.site;
+        cluster.classified = sites[entry.site].classified;
+        cluster.exceedances = sites[entry.site].exceedances;
+
+        if (!base.keys.isEmpty() && base.keys.last() == entry.key) {
+            mergeCluster(base.clusters.last(), cluster);
+        } else {
+            base.keys.append(entry.key);
+            base.clusters.append(cluster);
+        }
+    }
+    levels.append(base);
+
+    // Each coarser level merges 2x2 cells of the one below until one cluster is left
+    while (levels.last().clusters.size() > 1 && levels.size() < MAX_LEVELS) {
+        const Level& child = levels.last();
+        Level parent;
+        parent.cell = cellSize(levels.size());
+        parent.columns = qint64(extent.width() / parent.cell) + 1;
+
+        QVector<QPair<qint64, int>> order;
+        order.reserve(child.keys.size());
+        for (int i = 0; i < child.keys.size(); ++i) {
+            const qint64 row = (child.keys[i] / child.columns) >> 1;
+            const qint64 column = (child.keys[i] % child.columns) >> 1;
+            order.append({row * parent.columns + column, i});
+        }
+        std::sort(order.begin(), order.end());
+
+        for (const auto& item : order) {
+            if (!parent.keys.isEmpty() && parent.keys.last() == item.first) {
+                mergeCluster(parent.clusters.last(), child.clusters[item.second]);
+            } else {
+                parent.keys.append(item.first);
+                parent.clusters.append(child.clusters[item.second]);
+            }
+        }
+        levels.append(parent);
+    }
+}
+
+template <typename Visit>
+void SiteSpatialIndex::forEachRowRange(const QVector<qint64>& keys, double cell, qint64 columns,
+                                       const QRectF& rect, Visit&& visit) const
+{
+    const QRectF area = rect.normalized().intersected(extent.adjusted(0, 0, cell, cell));
+    if (keys.isEmpty() || area.isNull()) {
+        return;
+    }
+
+    const qint64 rows = qint64(extent.height() / cell) + 1;
+    const qint64 firstColumn = qBound<qint64>(0, qint64(std::floor((area.left() - extent.left()) / cell)), columns - 1);
+    const qint64 lastColumn = qBound<qint64>(0, qint64(std::floor((area.right() - extent.left()) / cell)), columns - 1);
+    // top() is the smaller northing of each rectangle, so rows run south to north
+    const qint64 firstRow = qBound<qint64>(0, qint64(std::floor((area.top() - extent.top()) / cell)), rows - 1);
+    const qint64 lastRow = qBound<qint64>(0, qint64(std::floor((area.bottom() - extent.top()) / cell)), rows - 1);
+
+    for (qint64 row = firstRow; row <= lastRow; ++row) {
+        auto first = std::lower_bound(keys.begin(), keys.end(), row * columns + firstColumn);
+        auto last = std::upper_bound(first, keys.end(), row * columns + lastColumn);
+        if (first != last) {
+            visit(int(first - keys.begin()), int(last - keys.begin()));
+        }
+    }
+}
+
+QVector<int> SiteSpatialIndex::sitesInRect(const QRectF& rect) const
+{
+    QVector<int> result;
+    if (levels.isEmpty()) {
+        return result;
+    }
+
+    const QRectF area = rect.normalized();
+    forEachRowRange(entryKeys, BASE_CELL, levels.first().columns, area, [&](int first, int last) {
+        for (int i = first; i < last; ++i) {
+            const QPointF& position = entries[i].position;
+            if (position.x() >= area.left() && position.x() <= area.right()
+                && position.y() >= area.top() && position.y() <= area.bottom()) {
+                result.append(entries[i].site);
+            }
+        }
+    });
+    return result;
+}
+
+QVector<NearbySite> SiteSpatialIndex::sitesWithin(const QPointF& centre, double radius) const
+{
+    QVector<NearbySite> result;
+    if (levels.isEmpty()) {
+        return result;
+    }
+
+    const QRectF area(centre.x() - radius, centre.y() - radius, radius * 2, radius * 2);
+    forEachRowRange(entryKeys, BASE_CELL, levels.first().columns, area, [&](int first, int last) {
+        for (int i = first; i < last; ++i) {
+            const QPointF delta = entries[i].position - centre;
+            const double distance = std::hypot(delta.x(), delta.y());
+            if (distance <= radius) {
+                result.append({entries[i].site, distance});
+            }
+        }
+    });
+
+    std::sort(result.begin(), result.end(), [](const NearbySite& a, const NearbySite& b) {
+        return a.distance < b.distance;
+    });
+    return result;
+}
+
+int SiteSpatialIndex::levelForSpacing(double spacing) const
+{
+    for (int level = 0; level < levels.size(); ++level) {
+        if (cellSize(level) >= spacing) {
+            return level;
+        }
+    }
+    return levels.size() - 1;
+}
+
+QVector<SiteCluster> SiteSpatialIndex::clustersInRect(int level, const QRectF& rect) const
+{
+    QVector<SiteCluster> result;
+    if (level < 0 || level >= levels.size()) {
+        return result;
+    }
+
+    const Level& grid = levels[level];
+    forEachRowRange(grid.keys, grid.cell, grid.columns, rect, [&](int first, int last) {
+        for (int i = first; i < last; ++i) {
+            result.append(grid.clusters[i]);
+        }
+    });
+    return result;
+}
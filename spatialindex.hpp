@@ -0,0 +1,83 @@
+#pragma once
+
+#include <QPointF>
+#include <QRectF>
+#include <QVector>
+#include "samplingpoint.hpp"
+
+// A site returned by a proximity query
+struct NearbySite
+{
+    int site;         // Index into the vector the index was built from
+    double distance;  // Metres
+};
+
+// Sites sharing one grid cell at a clustering level
+struct SiteCluster
+{
+    QPointF centroid;         // Mean grid position of the members
+    int count = 0;
+    int representative = -1;  // One member's site index
+    quint32 classified = 0;   // Summed over the members
+    quint32 exceedances = 0;
+
+    double exceedanceRate() const { return classified > 0 ? double(exceedances) / classified : 0.0; }
+};
+
+// Uniform grid over British National Grid easting/northing with sites sorted
+// by cell key (row-major), so every grid row a query touches is one binary
+// search plus a contiguous scan: O(rows * log n + k). On top sits a
+// clustering pyramid whose cell size doubles per level; each level is
+// merged from the one below and kept sorted the same way, so the map can
+// fetch the clusters for any zoom without touching individual sites.
+class SiteSpatialIndex
+{
+public:
+    static constexpr double BASE_CELL = 250.0; // Cell width of level 0, in metres
+    static const int MAX_LEVELS = 16;
+
+    void clear();
+
+    // Index the located sites; results refer to positions in this vector
+    void build(const QVector<SamplingPoint>& sites);
+    bool isEmpty() const { return entries.isEmpty(); }
+    QRectF bounds() const { return extent; }
+
+    QVector<int> sitesInRect(const QRectF& rect) const;
+
+    // Sites within radius metres of centre, nearest first
+    QVector<NearbySite> sitesWithin(const QPointF& centre, double radius) const;
+
+    // Clustering pyramid
+    int levelCount() const { return levels.size(); }
+    static double cellSize(int level);
+
+    // Finest level whose cells are at least spacing metres wide
+    int levelForSpacing(double spacing) const;
+    const QVector<SiteCluster>& clusters(int level) const { return levels[level].clusters; }
+    QVector<SiteCluster> clustersInRect(int level, const QRectF& rect) const;
+
+private:
+    struct Entry {
+        qint64 key;
+        int site;
+        QPointF position;
+    };
+
+    struct Level {
+        double cell = BASE_CELL;
+        qint64 columns = 1;            // Grid width in cells
+        QVector<qint64> keys;          // Sorted cell key of each cluster
+        QVector<SiteCluster> clusters;
+    };
+
+    // Call visit(first, last) for each grid row's range of sorted keys overlapping rect
+    template <typename Visit>
+    void forEachRowRange(const QVector<qint64>& keys, double cell, qint64 columns,
+                         const QRectF& rect, Visit&& visit) const;
+
+    QRectF extent;              // Bounds of the indexed sites
+    QVector<Entry> entries;     // Sites sorted by level 0 cell key
+    QVector<qint64> entryKeys;  // entries[i].key, kept apart for binary search
+    QVector<Level> levels;
+};
@@ -0,0 +1,125 @@
+#include "stallwatchdog.hpp"
+#include "tracing.hpp"
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QStandardPaths>
+
+StallWatchdog::StallWatchdog(QObject* parent) : QObject(parent)
+{
+    TraceRecorder::markGuiThread();
+
+    const QString directory = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
+    QDir().mkpath(directory);
+    logFile = QDir(directory).filePath("stalls.log");
+}
+
+StallWatchdog::~StallWatchdog()
+{
+    if (thread) {
+        stopping = true;
+        thread->wait();
+        delete thread;
+    }
+}
+
+void StallWatchdog::start()
+{
+    if (thread) {
+        return;
+    }
+    thread = QThread::create([this]() { monitor(); });
+    thread->setObjectName("StallWatchdog");
+    thread->start(QThread::HighPriority);
+}
+
+QVector<StallRecord> StallWatchdog::recentStalls() const
+{
+    QMutexLocker lock(&mutex);
+    return stalls;
+}
+
+void StallWatchdog::monitor()
+{
+    while (!stopping) {
+        // Pings are told apart by their post time
+        const qint64 sent = TraceRecorder::now();
+        const QDateTime when = QDateTime::currentDateTime();
+        QMetaObject::invokeMethod(this, [this, sent]() {
+            answered.store(sent);
+        }, Qt::QueuedConnection);
+
+        QHash<QStringList, int> stacks;
+        int sampleCount = 0;
+        while (!stopping && answered.load() != sent) {
+            QThread::msleep(SAMPLE_INTERVAL_MS);
+            if (TraceRecorder::now() - sent > STALL_THRESHOLD_MS * 1000000LL) {
+                stacks[TraceRecorder::guiOperations()]++;
+                sampleCount++;
+            }
+        }
+        if (stopping) {
+            return;
+        }
+
+        const qint64 latency = TraceRecorder::now() - sent;
+        if (latency > STALL_THRESHOLD_MS * 1000000LL && sampleCount > 0) {
+            StallRecord stall;
+            stall.when = when;
+            stall.durationMs = latency / 1e6;
+            stall.sampleCount = sampleCount;
+            for (auto it = stacks.begin(); it != stacks.end(); ++it) {
+                if (it.value() > stall.samples) {
+                    stall.operations = it.key();
+                    stall.samples = it.value();
+                }
+            }
+            report(stall);
+        }
+
+        QThread::msleep(PING_INTERVAL_MS);
+    }
+}
+
+void StallWatchdog::report(const StallRecord& stall)
+{
+    {
+        QMutexLocker lock(&mutex);
+        stalls.append(stall);
+        if (stalls.size() > MAX_RECENT_STALLS) {
+            stalls.removeFirst();
+        }
+    }
+    appendToLog(stall);
+
+    QMetaObject::invokeMethod(this, [this, stall]() {
+        emit stallDetected(stall);
+    }, Qt::QueuedConnection);
+}
+
+void StallWatchdog::appendToLog(const StallRecord& stall)
+{
+    // Shift stalls.log -> .1 -> .2 ... once the current file is full
+    if (QFile(logFile).size() >= MAX_LOG_BYTES) {
+        QFile::remove(logFile + "." + QString::number(LOG_GENERATIONS));
+        for (int generation = LOG_GENERATIONS - 1; generation >= 1; --generation) {
+            QFile::rename(logFile + "." + QString::number(generation), logFile + "." + QString::number(generation + 1));
+        }
+        QFile::rename(logFile, logFile + ".1");
+    }
+
+    QFile log(logFile);
+    if (!log.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+        return;
+    }
+
+    const QString operation = stall.operations.isEmpty() ? QString("(no traced operation)")
+                                                         : stall.operations.join(" > ");
+    log.write(QString("%1 stall %2 ms in %3 (%4 of %5 samples)\n")
+                  .arg(stall.when.toString(Qt::ISODateWithMs))
+                  .arg(stall.durationMs, 0, 'f', 0)
+                  .arg(operation)
+                  .arg(stall.samples)
+                  .arg(stall.sampleCount)
+                  .toUtf8());
+}
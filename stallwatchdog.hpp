@@ -0,0 +1,64 @@
+#pragma once
+
+#include <QDateTime>
+#include <QMutex>
+#include <QObject>
+#include <QStringList>
+#include <QThread>
+#include <QVector>
+#include <atomic>
+
+// One time the GUI event loop failed to answer within the threshold
+struct StallRecord
+{
+    QDateTime when;           // When the unanswered ping was posted
+    double durationMs = 0.0;  // Until the event loop answered it
+    QStringList operations;   // Traced scopes open on the GUI thread, outermost first
+    int samples = 0;          // How many of the stall's samples saw that stack
+    int sampleCount = 0;      // Samples taken during the stall
+};
+
+// Watches the GUI event loop from its own thread. Every PING_INTERVAL_MS it
+// posts an empty call to the GUI thread and waits for it to run. Once the
+// reply is later than STALL_THRESHOLD_MS, the GUI thread's open TraceScopes
+// are sampled until it answers, and the stall is put down to the stack seen
+// most often. Stalls are appended to a rotating log and kept for the stats
+// dialog. Must be created on the GUI thread, which it marks for tracing.
+class StallWatchdog : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit StallWatchdog(QObject* parent = nullptr);
+    ~StallWatchdog() override;
+
+    void start();
+
+    // Most recent stalls, oldest first
+    QVector<StallRecord> recentStalls() const;
+    QString logPath() const { return logFile; }
+
+signals:
+    // Emitted on the GUI thread once it has recovered
+    void stallDetected(const StallRecord& stall);
+
+private:
+    void monitor();
+    void report(const StallRecord& stall);
+    void appendToLog(const StallRecord& stall);
+
+    static const int PING_INTERVAL_MS = 100;
+    static const int STALL_THRESHOLD_MS = 200;
+    static const int SAMPLE_INTERVAL_MS = 10;
+    static const int MAX_RECENT_STALLS = 200;
+    static const qint64 MAX_LOG_BYTES = 1024 * 1024;  // Size at which the log rotates
+    static const int LOG_GENERATIONS = 3;             // stalls.log.1 .. .3 are kept
+
+    QThread* thread = nullptr;
+    std::atomic<bool> stopping{false};
+    std::atomic<qint64> answered{0};  // Post time of the last ping the GUI ran
+    QString logFile;
+
+    mutable QMutex mutex;
+    QVector<StallRecord> stalls;
+};
@@ -0,0 +1,156 @@
+#include "statsdialog.hpp"
+#include "stallwatchdog.hpp"
+#include "tracing.hpp"
+#include <QHeaderView>
+
+namespace {
+
+QString megabytes(qint64 bytes)
+{
+    return QString("%1 MB").arg(bytes / (1024.0 * 1024.0), 0, 'f', 1);
+}
+
+QTableWidgetItem* readOnlyItem(const QString& text)
+{
+    QTableWidgetItem* item = new QTableWidgetItem(text);
+    item->setFlags(item->flags() & ~Qt::ItemIsEditable);
+    return item;
+}
+
+}
+
+StatsDialog::StatsDialog(const StallWatchdog* watchdog, QWidget* parent) : QDialog(parent), watchdog(watchdog)
+{
+    setWindowTitle("Performance Stats");
+    resize(640, 520);
+
+    // Recording toggle; disabled scopes cost a single branch
+    recordBox = new QCheckBox("Record timings", this);
+    recordBox->setChecked(TraceRecorder::isEnabled());
+    connect(recordBox, &QCheckBox::toggled, this, [](bool on) {
+        TraceRecorder::setEnabled(on);
+    });
+
+    memoryLabel = new QLabel(this);
+
+    // Latency per instrumented operation
+    operationTable = new QTableWidget(0, 8, this);
+    operationTable->setHorizontalHeaderLabels({"Operation", "Count", "p50 (ms)", "p95 (ms)", "p99 (ms)", "Max (ms)",
+                                               "Allocs/Call", "KB/Call"});
+    operationTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    operationTable->horizontalHeader()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
+    operationTable->verticalHeader()->setVisible(false);
+
+    // Allocation columns only mean something in allocation tracking builds
+    operationTable->setColumnHidden(6, !allocationTrackingEnabled());
+    operationTable->setColumnHidden(7, !allocationTrackingEnabled());
+
+    // Memory each page's model added
+    pageTable = new QTableWidget(0, 2, this);
+    pageTable->setHorizontalHeaderLabels({"Page", "RSS Growth on Load"});
+    pageTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    pageTable->verticalHeader()->setVisible(false);
+
+    resetButton = new QPushButton("Reset Timings", this);
+    connect(resetButton, &QPushButton::clicked, this, [this]() {
+        TraceRecorder::instance().reset();
+        refresh();
+    });
+
+    // GUI stalls, newest first
+    stallTable = new QTableWidget(0, 4, this);
+    stallTable->setHorizontalHeaderLabels({"Time", "Duration (ms)", "Operation", "Samples"});
+    stallTable->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    stallTable->horizontalHeader()->setSectionResizeMode(2, QHeaderView::Stretch);
+    stallTable->verticalHeader()->setVisible(false);
+    stallLogLabel = new QLabel(QString("Logged to %1").arg(watchdog->logPath()), this);
+    stallLogLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+
+    refreshTimer = new QTimer(this);
+    refreshTimer->setInterval(REFRESH_INTERVAL_MS);
+    connect(refreshTimer, &QTimer::timeout, this, &StatsDialog::refresh);
+
+    QWidget* timingsTab = new QWidget(this);
+    QVBoxLayout* timingsLayout = new QVBoxLayout(timingsTab);
+    timingsLayout->addWidget(recordBox);
+    timingsLayout->addWidget(memoryLabel);
+    timingsLayout->addWidget(operationTable, 3);
+    timingsLayout->addWidget(pageTable, 1);
+    timingsLayout->addWidget(resetButton);
+
+    QWidget* stallsTab = new QWidget(this);
+    QVBoxLayout* stallsLayout = new QVBoxLayout(stallsTab);
+    stallsLayout->addWidget(stallTable);
+    stallsLayout->addWidget(stallLogLabel);
+
+    tabs = new QTabWidget(this);
+    tabs->addTab(timingsTab, "Timings");
+    tabs->addTab(stallsTab, "Stalls");
+
+    mainLayout = new QVBoxLayout(this);
+    mainLayout->addWidget(tabs);
+}
+
+void StatsDialog::setPageMemory(const QMap<QString, qint64>& bytes)
+{
+    pageMemory = bytes;
+    if (isVisible()) {
+        refresh();
+    }
+}
+
+void StatsDialog::showEvent(QShowEvent* event)
+{
+    QDialog::showEvent(event);
+    refresh();
+    refreshTimer->start();
+}
+
+void StatsDialog::hideEvent(QHideEvent* event)
+{
+    refreshTimer->stop();
+    QDialog::hideEvent(event);
+}
+
+void StatsDialog::refresh()
+{
+    const qint64 resident = processResidentBytes();
+    QString memory = QString("Process resident memory: %1").arg(resident < 0 ? QString("n/a") : megabytes(resident));
+    if (allocationTrackingEnabled()) {
+        const AllocationCount allocated = processAllocations();
+        memory += QString(", %1 allocations (%2) since start").arg(allocated.allocations).arg(megabytes(qint64(allocated.bytes)));
+    }
+    memoryLabel->setText(memory);
+
+    const QVector<OperationStats> operations = TraceRecorder::instance().operations();
+    operationTable->setRowCount(operations.size());
+    for (int row = 0; row < operations.size(); ++row) {
+        const OperationStats& stats = operations[row];
+        operationTable->setItem(row, 0, readOnlyItem(stats.name));
+        operationTable->setItem(row, 1, readOnlyItem(QString::number(stats.count)));
+        operationTable->setItem(row, 2, readOnlyItem(QString::number(stats.p50, 'f', 2)));
+        operationTable->setItem(row, 3, readOnlyItem(QString::number(stats.p95, 'f', 2)));
+        operationTable->setItem(row, 4, readOnlyItem(QString::number(stats.p99, 'f', 2)));
+        operationTable->setItem(row, 5, readOnlyItem(QString::number(stats.max, 'f', 2)));
+        operationTable->setItem(row, 6, readOnlyItem(QString::number(stats.allocationsPerCall, 'f', 0)));
+        operationTable->setItem(row, 7, readOnlyItem(QString::number(stats.bytesPerCall / 1024.0, 'f', 1)));
+    }
+
+    pageTable->setRowCount(pageMemory.size());
+    int row = 0;
+    for (auto it = pageMemory.begin(); it != pageMemory.end(); ++it, ++row) {
+        pageTable->setItem(row, 0, readOnlyItem(it.key()));
+        pageTable->setItem(row, 1, readOnlyItem(megabytes(it.value())));
+    }
+
+    const QVector<StallRecord> stalls = watchdog->recentStalls();
+    stallTable->setRowCount(stalls.size());
+    for (int i = 0; i < stalls.size(); ++i) {
+        const StallRecord& stall = stalls[stalls.size() - 1 - i];
+        stallTable->setItem(i, 0, readOnlyItem(stall.when.toString("HH:mm:ss.zzz")));
+        stallTable->setItem(i, 1, readOnlyItem(QString::number(stall.durationMs, 'f', 0)));
+        stallTable->setItem(i, 2, readOnlyItem(stall.operations.isEmpty() ? QString("(no traced operation)")
+                                                                          : stall.operations.join(" > ")));
+        stallTable->setItem(i, 3, readOnlyItem(QString("%1 / %2").arg(stall.samples).arg(stall.sampleCount)));
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <QDialog>
+#include <QCheckBox>
+#include <QLabel>
+#include <QMap>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QTabWidget>
+#include <QTimer>
+#include <QVBoxLayout>
+
+class StallWatchdog;
+
+// Live view of the timings gathered by TraceScope: one row per operation
+// with its p50/p95/p99 latency, plus process memory and how much each
+// page's model added to it when it was built. A second tab lists the GUI
+// stalls the watchdog caught. Refreshes itself while shown.
+class StatsDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit StatsDialog(const StallWatchdog* watchdog, QWidget* parent = nullptr);
+
+    // Resident memory each page grew the process by while loading its model
+    void setPageMemory(const QMap<QString, qint64>& bytes);
+
+protected:
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
+
+private:
+    void refresh();
+
+    QVBoxLayout* mainLayout;
+    QTabWidget* tabs;
+    QCheckBox* recordBox;
+    QLabel* memoryLabel;
+    QTableWidget* operationTable;
+    QTableWidget* pageTable;
+    QPushButton* resetButton;
+    QTableWidget* stallTable;
+    QLabel* stallLogLabel;
+    const StallWatchdog* watchdog;
+    QTimer* refreshTimer;
+    QMap<QString, qint64> pageMemory;
+
+    // How often the figures are redrawn while the dialog is open
+    static const int REFRESH_INTERVAL_MS = 1000;
+};
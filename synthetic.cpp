@@ -0,0 +1,462 @@
+#include "synthetic.hpp"
+#include <QDebug>
+#include <QFile>
+#include <cmath>
+#include <utility>
+
+namespace {
+
+// One determinand as reported by the EA, with a log-normal result spread
+struct Determinand
+{
+    const char* label;
+    const char* definition;
+    const char* notation;
+    const char* unit;
+    double typical;         // Median result
+    double spread;          // Log-normal sigma
+    double detectionLimit;  // Results below this are reported as "<" the limit
+};
+
+const Determinand CATALOGUE[] = {
+    // Routine chemistry, most of every real extract
+    {"pH", "pH", "0061", "phunits", 7.8, 0.05, 0.0},
+    {"Temp Water", "Temperature of Water", "0076", "cel", 11.0, 0.35, 0.0},
+    {"Cond @ 25C", "Conductivity at 25 C", "0077", "us/cm", 520.0, 0.5, 1.0},
+    {"Oxygen Diss", "Oxygen, Dissolved as O2", "9901", "mg/l", 9.5, 0.2, 0.5},
+    {"O Diss %sat", "Oxygen, Dissolved, % Saturation", "9924", "%", 92.0, 0.12, 1.0},
+    {"Ammonia(N)", "Ammoniacal Nitrogen as N", "0111", "mg/l", 0.06, 1.1, 0.03},
+    {"Nitrate-N", "Nitrate as N", "0117", "mg/l", 4.5, 0.6, 0.2},
+    {"Nitrite-N", "Nitrite as N", "0118", "mg/l", 0.03, 0.9, 0.004},
+    {"BOD ATU", "BOD : 5 Day ATU", "0085", "mg/l", 1.5, 0.6, 1.0},
+    {"Sld Sus@105C", "Solids, Suspended at 105 C", "0135", "mg/l", 8.0, 1.0, 3.0},
+    {"Orthophospht", "Orthophosphate, reactive as P", "0180", "mg/l", 0.09, 1.0, 0.02},
+    {"Chloride Ion", "Chloride Ion as Cl", "0172", "mg/l", 38.0, 0.6, 1.0},
+    {"Alky pH 4.5", "Alkalinity to pH 4.5 as CaCO3", "0162", "mg/l", 180.0, 0.5, 5.0},
+    {"Hardness", "Hardness, Total as CaCO3", "0158", "mg/l", 240.0, 0.4, 5.0},
+    {"Zinc - as Zn", "Zinc - as Zn", "3408", "ug/l", 12.0, 1.0, 5.0},
+    {"Copper - Cu", "Copper - as Cu", "6452", "ug/l", 3.0, 0.9, 1.0},
+    {"Lead - as Pb", "Lead - as Pb", "6051", "ug/l", 0.8, 1.1, 0.2},
+    {"Iron - as Fe", "Iron - as Fe", "6450", "ug/l", 310.0, 0.9, 30.0},
+    {"Nickel - Ni", "Nickel - as Ni", "3409", "ug/l", 2.5, 0.8, 0.5},
+    // Pollutant Overview solvents
+    {"Chloroform", "Trichloromethane", "0111C", "ug/l", 0.05, 1.2, 0.1},
+    {"112TCEthan", "1,1,2-Trichloroethane", "7231", "ug/l", 0.03, 1.0, 0.1},
+    {"Benzene", "Benzene", "7272", "ug/l", 0.3, 1.3, 0.1},
+    {"Toluene", "Toluene", "7344", "ug/l", 1.2, 1.3, 0.1},
+    // Persistent organic pollutants
+    {"PCB Con 028", "PCB Congener 28 - 2,4,4'-Trichlorobiphenyl", "5939", "ug/l", 0.0006, 1.0, 0.0005},
+    {"PCB Con 052", "PCB Congener 52 - 2,2',5,5'-Tetrachlorobiphenyl", "5940", "ug/l", 0.0006, 1.0, 0.0005},
+    {"PCB Con 101", "PCB Congener 101 - 2,2',4,5,5'-Pentachlorobiphenyl", "5941", "ug/l", 0.0005, 1.1, 0.0005},
+    {"PCB Con 118", "PCB Congener 118 - 2,3',4,4',5-Pentachlorobiphenyl", "5942", "ug/l", 0.0004, 1.1, 0.0005},
+    {"PCB Con 138", "PCB Congener 138 - 2,2',3,4,4',5'-Hexachlorobiphenyl", "5943", "ug/l", 0.0005, 1.1, 0.0005},
+    {"PCB Con 153", "PCB Congener 153 - 2,2',4,4',5,5'-Hexachlorobiphenyl", "5944", "ug/l", 0.0005, 1.1, 0.0005},
+    {"PCB Con 180", "PCB Congener 180 - 2,2',3,4,4',5,5'-Heptachlorobiphenyl", "5945", "ug/l", 0.0004, 1.2, 0.0005},
+    {"PCB - Total", "PCB : Total", "5946", "ug/l", 0.003, 1.0, 0.001},
+    // Per- and polyfluoroalkyl substances
+    {"PFOS", "Perfluorooctane sulphonate (PFOS)", "2942", "ug/l", 0.008, 1.1, 0.001},
+    {"PFOA", "Perfluorooctanoic acid (PFOA)", "2943", "ug/l", 0.005, 1.0, 0.001},
+    {"PFHxS", "Perfluorohexane sulphonate (PFHxS)", "2944", "ug/l", 0.003, 1.0, 0.001},
+    {"PFBA", "Perfluorobutanoic acid (PFBA)", "2945", "ug/l", 0.006, 1.1, 0.001},
+    {"6:2 FTS", "6:2 Fluorotelomer sulphonate", "2946", "ug/l", 0.004, 1.3, 0.001},
+    // Bathing water profile litter observations, present (1) or absent (0)
+    {"BWP - O.L.", "Bathing Water Profile : Other Litter (incl. plastics)", "7601", "pres/nf", -0.2, 0.0, 0.0},
+    {"BWP - A.F.", "Bathing Water Profile : Abnormal Foam", "7602", "pres/nf", -0.1, 0.0, 0.0},
+};
+
+const int CATALOGUE_COUNT = int(sizeof(CATALOGUE) / sizeof(CATALOGUE[0]));
+
+// Real extracts name several thousand determinands, most of them reported
+// a handful of times by screening samples. The long tail is built from
+// these parts, the same for every seed, so files share one determinand
+// dimension the way extracts from different years do.
+const int LONG_TAIL_COUNT = 4000;
+const quint64 LONG_TAIL_SEED = 0x5eed7a11;
+
+// Prefix with its label abbreviation; "fluoro" ones fall in the Fluorinated category
+const struct { const char* name; const char* abbreviation; } TAIL_PREFIXES[] = {
+    {"Methyl", "Me"}, {"Ethyl", "Et"}, {"Propyl", "Pr"}, {"Butyl", "Bu"}, {"Dimethyl", "DMe"},
+    {"Diethyl", "DEt"}, {"Chloro", "Cl"}, {"Dichloro", "DCl"}, {"Trichloro", "TCl"}, {"Tetrachloro", "QCl"},
+    {"Bromo", "Br"}, {"Dibromo", "DBr"}, {"Nitro", "NO2"}, {"Amino", "NH2"}, {"Hydroxy", "OH"},
+    {"Methoxy", "OMe"}, {"Cyano", "CN"}, {"Acetyl", "Ac"}, {"Phenyl", "Ph"}, {"Iodo", "I"},
+    {"Fluoro", "F"}, {"Trifluoromethyl", "CF3"},
+};
+
+const struct { const char* name; const char* abbreviation; } TAIL_STEMS[] = {
+    {"phenol", "phen"}, {"aniline", "anil"}, {"toluene", "tol"}, {"xylene", "xyl"}, {"benzoate", "bzte"},
+    {"pyridine", "pyr"}, {"naphthalene", "naph"}, {"furan", "fur"}, {"thiophene", "thio"}, {"acetamide", "acam"},
+    {"butanoate", "but"}, {"propanol", "prol"}, {"hexane", "hex"}, {"octanoate", "oct"}, {"cresol", "cres"},
+    {"quinoline", "quin"}, {"indole", "ind"}, {"carbazole", "carb"}, {"biphenyl ether", "bpe"}, {"triazine", "triaz"},
+    {"urea", "urea"}, {"phosphate", "phos"}, {"sulphonate", "sulf"}, {"acetate", "acet"}, {"benzamide", "bzam"},
+    {"imidazole", "imid"}, {"pyrrole", "pyrl"}, {"anthracene", "anth"}, {"pyrene", "pyre"}, {"benzoic acid", "bzac"},
+};
+
+const char* const TAIL_POSITIONS[] = {"", "2-", "3-", "4-", "2,4-", "2,6-", "3,5-"};
+
+const int TAIL_PREFIX_COUNT = int(sizeof(TAIL_PREFIXES) / sizeof(TAIL_PREFIXES[0]));
+const int TAIL_STEM_COUNT = int(sizeof(TAIL_STEMS) / sizeof(TAIL_STEMS[0]));
+const int TAIL_POSITION_COUNT = int(sizeof(TAIL_POSITIONS) / sizeof(TAIL_POSITIONS[0]));
+static_assert(TAIL_PREFIX_COUNT * TAIL_STEM_COUNT * TAIL_POSITION_COUNT >= LONG_TAIL_COUNT,
+              "Too few name parts for the long tail");
+
+// Determinands reported together by one kind of sample, as ranges of the
+// determinand table. A profile with picks draws that many at random from
+// its range, favouring the front of it; otherwise it reports the range.
+struct Profile
+{
+    int first;
+    int count;
+    double weight;  // Share of samples of this kind
+    int picks;
+};
+
+const Profile PROFILES[] = {
+    {0, 14, 0.56, 0},    // Routine chemistry
+    {14, 5, 0.14, 0},    // Metals
+    {19, 4, 0.09, 0},    // Solvents
+    {23, 8, 0.06, 0},    // PCB congeners and their total
+    {31, 5, 0.06, 0},    // PFAS
+    {36, 2, 0.03, 0},    // Bathing water litter
+    {CATALOGUE_COUNT, LONG_TAIL_COUNT, 0.06, 8}, // Screening for the long tail
+};
+
+// A determinand of the table the generator draws from: the catalogue
+// followed by the long tail
+struct DeterminandSpec
+{
+    QByteArray label;
+    QByteArray definition;
+    QByteArray notation;
+    QByteArray unit;
+    double typical;
+    double spread;
+    double detectionLimit;
+};
+
+quint64 splitMix(quint64& state)
+{
+    quint64 z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+QVector<DeterminandSpec> buildDeterminandTable()
+{
+    QVector<DeterminandSpec> table;
+    table.reserve(CATALOGUE_COUNT + LONG_TAIL_COUNT);
+    for (const Determinand& determinand : CATALOGUE) {
+        table.append({determinand.label, determinand.definition, determinand.notation, determinand.unit,
+                      determinand.typical, determinand.spread, determinand.detectionLimit});
+    }
+
+    // Every name combination once, in a fixed shuffled order
+    const int combinations = TAIL_PREFIX_COUNT * TAIL_STEM_COUNT * TAIL_POSITION_COUNT;
+    QVector<int> order(combinations);
+    for (int i = 0; i < combinations; ++i) {
+        order[i] = i;
+    }
+    quint64 state = LONG_TAIL_SEED;
+    for (int i = combinations - 1; i > 0; --i) {
+        std::swap(order[i], order[int(splitMix(state) % quint64(i + 1))]);
+    }
+
+    for (int i = 0; i < LONG_TAIL_COUNT; ++i) {
+        const int prefix = order[i] % TAIL_PREFIX_COUNT;
+        const int stem = order[i] / TAIL_PREFIX_COUNT % TAIL_STEM_COUNT;
+        const int position = order[i] / (TAIL_PREFIX_COUNT * TAIL_STEM_COUNT);
+
+        DeterminandSpec spec;
+        const QByteArray positionText = TAIL_POSITIONS[position];
+        spec.definition = positionText + TAIL_PREFIXES[prefix].name + TAIL_STEMS[stem].name;
+        spec.label = QByteArray(TAIL_PREFIXES[prefix].abbreviation) + TAIL_STEMS[stem].abbreviation;
+        if (!positionText.isEmpty()) {
+            spec.label += ' ' + positionText.chopped(1);
+        }
+        spec.notation = QByteArray::number(8000 + i);
+        spec.unit = "ug/l";
+
+        // Medians from 0.001 to 10 ug/l, evenly spread on a log scale
+        const double u = (splitMix(state) >> 11) * (1.0 / 9007199254740992.0);
+        spec.typical = std::pow(10.0, -3.0 + 4.0 * u);
+        spec.spread = 0.8 + 0.5 * ((splitMix(state) >> 11) * (1.0 / 9007199254740992.0));
+        spec.detectionLimit = spec.typical * 0.3;
+        table.append(spec);
+    }
+    return table;
+}
+
+const QVector<DeterminandSpec>& determinandTable()
+{
+    static const QVector<DeterminandSpec> table = buildDeterminandTable();
+    return table;
+}
+
+const char* const RIVERS[] = {
+    "AIRE", "CALDER", "DON", "OUSE", "WHARFE", "NIDD", "SWALE", "URE", "TRENT", "DERWENT",
+    "SEVERN", "AVON", "THAMES", "KENNET", "LEA", "MEDWAY", "STOUR", "ITCHEN", "TEST", "EXE",
+    "TAMAR", "DART", "MERSEY", "IRWELL", "RIBBLE", "LUNE", "EDEN", "TYNE", "WEAR", "TEES",
+    "HUMBER", "WITHAM", "WELLAND", "NENE", "GREAT OUSE", "CAM", "WAVENEY", "YARE", "COLNE", "CHELMER",
+};
+
+const char* const PLACES[] = {
+    "KNOSTROP", "CASTLEFORD", "SELBY", "YORK", "TADCASTER", "OTLEY", "ILKLEY", "SKIPTON", "BOROUGHBRIDGE", "RIPON",
+    "NEWARK", "GAINSBOROUGH", "BURTON", "DERBY", "MATLOCK", "SHREWSBURY", "WORCESTER", "GLOUCESTER", "BATH", "BRISTOL",
+    "READING", "OXFORD", "WINDSOR", "TEDDINGTON", "HERTFORD", "MAIDSTONE", "CANTERBURY", "WINCHESTER", "ROMSEY", "EXETER",
+    "TAVISTOCK", "TOTNES", "WARRINGTON", "SALFORD", "PRESTON", "LANCASTER", "CARLISLE", "HEXHAM", "DURHAM", "YARM",
+    "HULL", "LINCOLN", "STAMFORD", "PETERBOROUGH", "BEDFORD", "CAMBRIDGE", "BECCLES", "NORWICH", "COLCHESTER", "MALDON",
+    "WEIR", "BRIDGE", "MILL", "FOOTBRIDGE", "GAUGING STATION", "INTAKE", "OUTFALL", "D/S STW", "U/S STW", "CONFLUENCE",
+};
+
+const char* const REGIONS[] = {"NE", "AN", "MD", "NW", "SO", "SW", "TH"};
+
+// Material types with the share of sites sampling each
+const struct { const char* label; double weight; } MATERIALS[] = {
+    {"RIVER / RUNNING SURFACE WATER", 0.70},
+    {"POND / LAKE / RESERVOIR WATER", 0.10},
+    {"SEA WATER", 0.08},
+    {"ESTUARINE WATER", 0.04},
+    {"GROUNDWATER", 0.04},
+    {"FINAL SEWAGE EFFLUENT", 0.04},
+};
+
+const int RIVER_COUNT = int(sizeof(RIVERS) / sizeof(RIVERS[0]));
+const int PLACE_COUNT = int(sizeof(PLACES) / sizeof(PLACES[0]));
+const int REGION_COUNT = int(sizeof(REGIONS) / sizeof(REGIONS[0]));
+
+const char* const MEASUREMENT_URI = "http://environment.data.gov.uk/water-quality/data/measurement/";
+const char* const SAMPLING_POINT_URI = "http://environment.data.gov.uk/water-quality/id/sampling-point/";
+
+// Append a field, quoting it when it holds a delimiter or a quote
+void appendField(QByteArray& out, const QByteArray& field)
+{
+    if (field.contains(',') || field.contains('"')) {
+        out += '"';
+        for (char ch : field) {
+            if (ch == '"') {
+                out += '"';
+            }
+            out += ch;
+        }
+        out += '"';
+    } else {
+        out += field;
+    }
+    out += ',';
+}
+
+// A result with about three significant figures and no exponent
+QByteArray formatResult(double value)
+{
+    const int decimals = value > 0 ? qBound(0, 2 - int(std::floor(std::log10(value))), 6) : 0;
+    return QByteArray::number(value, 'f', decimals);
+}
+
+}
+
+SyntheticCsvGenerator::SyntheticCsvGenerator(const SyntheticOptions& options, qint64 expectedRows)
+    : options(options), state(options.seed)
+{
+    const int count = options.siteCount > 0 ? options.siteCount : defaultSiteCount(expectedRows);
+    sites.reserve(count);
+
+    for (int i = 0; i < count; ++i) {
+        Site site;
+        const int river = i % RIVER_COUNT;
+        const int place = (i / RIVER_COUNT) % PLACE_COUNT;
+        const int repeat = i / (RIVER_COUNT * PLACE_COUNT);
+
+        // About one label in twenty is written "RIVER, PLACE" and needs quoting
+        site.label = below(20) == 0 ? QByteArray(RIVERS[river]) + ", " + PLACES[place]
+                                    : QByteArray("RIVER ") + RIVERS[river] + " AT " + PLACES[place];
+        if (repeat > 0) {
+            site.label += " NO. " + QByteArray::number(repeat + 1);
+        }
+        site.notation = QByteArray(REGIONS[i % REGION_COUNT]) + '-'
+                      + QByteArray::number(10000000 + quint64(i) * 7919 % 90000000);
+
+        double pick = uniform();
+        for (const auto& material : MATERIALS) {
+            site.materialType = material.label;
+            pick -= material.weight;
+            if (pick < 0) {
+                break;
+            }
+        }
+
+        // Anywhere on the English part of the National Grid
+        site.easting = 150000 + below(500000);
+        site.northing = 20000 + below(630000);
+        sites.append(site);
+    }
+}
+
+QByteArray SyntheticCsvGenerator::header()
+{
+    return "@id,sample.samplingPoint,sample.samplingPoint.notation,sample.samplingPoint.label,"
+           "sample.sampleDateTime,determinand.label,determinand.definition,determinand.notation,"
+           "resultQualifier.notation,result,codedResultInterpretation.interpretation,determinand.unit.label,"
+           "sample.sampledMaterialType.label,sample.isComplianceSample,sample.purpose.label,"
+           "sample.samplingPoint.easting,sample.samplingPoint.northing\n";
+}
+
+int SyntheticCsvGenerator::defaultSiteCount(qint64 rows)
+{
+    return int(qBound<qint64>(20, rows / 250, 60000));
+}
+
+quint64 SyntheticCsvGenerator::next()
+{
+    return splitMix(state);
+}
+
+double SyntheticCsvGenerator::uniform()
+{
+    return (next() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+int SyntheticCsvGenerator::below(int bound)
+{
+    return int((next() >> 32) * quint64(bound) >> 32);
+}
+
+void SyntheticCsvGenerator::startSample()
+{
+    // Squaring skews the draw so low-numbered sites are sampled far more often
+    const double u = uniform();
+    sampleSite = qMin(int(u * u * sites.size()), sites.size() - 1);
+
+    const QDate day = options.firstDay.addDays(below(qMax(options.days, 1)));
+    sampleTime = day.toString(Qt::ISODate).toLatin1() + 'T'
+               + QByteArray::number(7 + below(10)).rightJustified(2, '0') + ':'
+               + QByteArray::number(below(60)).rightJustified(2, '0') + ":00";
+
+    const bool effluent = sites[sampleSite].materialType == "FINAL SEWAGE EFFLUENT";
+    compliance = effluent ? below(10) < 8 : below(10) == 0;
+
+    double pick = uniform();
+    const Profile* profile = &PROFILES[0];
+    for (const Profile& candidate : PROFILES) {
+        profile = &candidate;
+        pick -= candidate.weight;
+        if (pick < 0) {
+            break;
+        }
+    }
+
+    sampleDeterminands.clear();
+    if (profile->picks > 0) {
+        // Cubing skews the draw so a few screened determinands are common and most are rare
+        for (int drawn = 0; drawn < profile->picks; ++drawn) {
+            const double v = uniform();
+            const int index = profile->first + qMin(int(v * v * v * profile->count), profile->count - 1);
+            if (!sampleDeterminands.contains(index)) {
+                sampleDeterminands.append(index);
+            }
+        }
+        return;
+    }
+
+    // Report the profile in catalogue order, occasionally skipping one
+    for (int i = profile->first + profile->count - 1; i >= profile->first; --i) {
+        if (profile->count <= 2 || below(8) != 0) {
+            sampleDeterminands.append(i);
+        }
+    }
+    if (sampleDeterminands.isEmpty()) {
+        sampleDeterminands.append(profile->first);
+    }
+}
+
+void SyntheticCsvGenerator::appendRow(QByteArray& out)
+{
+    if (sampleDeterminands.isEmpty()) {
+        startSample();
+    }
+    const DeterminandSpec& determinand = determinandTable()[sampleDeterminands.takeLast()];
+    const Site& site = sites[sampleSite];
+
+    // Log-normal around the typical value; litter is a presence flag
+    QByteArray qualifier;
+    QByteArray result;
+    if (determinand.typical < 0) {
+        result = uniform() < -determinand.typical ? "1" : "0";
+    } else {
+        const double gaussian = uniform() + uniform() + uniform() + uniform() - 2.0; // Irwin-Hall, sd ~0.58
+        const double value = determinand.typical * std::exp(determinand.spread * gaussian * 1.73);
+        if (value < determinand.detectionLimit) {
+            qualifier = "<";
+            result = formatResult(determinand.detectionLimit);
+        } else {
+            result = formatResult(value);
+        }
+    }
+
+    const QByteArray id = QByteArray::number(++measurementId).rightJustified(7, '0');
+    appendField(out, MEASUREMENT_URI + site.notation + '-' + id);
+    appendField(out, SAMPLING_POINT_URI + site.notation);
+    appendField(out, site.notation);
+    appendField(out, site.label);
+    appendField(out, sampleTime);
+    appendField(out, determinand.label);
+    appendField(out, determinand.definition);
+    appendField(out, determinand.notation);
+    appendField(out, qualifier);
+    appendField(out, result);
+    appendField(out, QByteArray());
+    appendField(out, determinand.unit);
+    appendField(out, site.materialType);
+    appendField(out, compliance ? "true" : "false");
+    appendField(out, compliance ? "COMPLIANCE AUDIT (PERMIT)" : "ENVIRONMENTAL MONITORING STATUTORY (EA)");
+    appendField(out, QByteArray::number(site.easting));
+    out += QByteArray::number(site.northing);
+    out += '\n';
+}
+
+bool writeSyntheticCsv(const QString& filePath, qint64 rows, const SyntheticOptions& options)
+{
+    QFile output(filePath);
+    if (!output.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Unable to write synthetic data:" << filePath;
+        return false;
+    }
+    return writeSyntheticCsv(output, rows, 0, options);
+}
+
+bool writeSyntheticCsv(QIODevice& output, qint64 rows, qint64 bytes, const SyntheticOptions& options,
+                       const std::function<void(qint64)>& progress)
+{
+    const qint64 expectedRows = rows > 0 ? rows : qMax<qint64>(1, bytes / SyntheticCsvGenerator::AVERAGE_ROW_BYTES);
+    SyntheticCsvGenerator generator(options, expectedRows);
+
+    QByteArray buffer = SyntheticCsvGenerator::header();
+    const int flushBytes = 1 << 20;
+    qint64 written = 0;
+
+    auto flush = [&]() {
+        if (output.write(buffer) != buffer.size()) {
+            qWarning() << "Unable to write synthetic data:" << output.errorString();
+            return false;
+        }
+        written += buffer.size();
+        buffer.clear();
+        if (progress) {
+            progress(written);
+        }
+        return true;
+    };
+
+    // A byte limit is checked per row, so the file stops at a row boundary
+    const bool unlimited = rows <= 0 && bytes <= 0;
+    for (qint64 row = 0; !unlimited && (rows <= 0 || row < rows); ++row) {
+        if (bytes > 0 && written + buffer.size() >= bytes) {
+            break;
+        }
+        generator.appendRow(buffer);
+        if (buffer.size() >= flushBytes && !flush()) {
+            return false;
+        }
+    }
+
+    return flush();
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <QByteArray>
+#include <QDate>
+#include <QString>
+#include <QVector>
+#include <functional>
+
+class QIODevice;
+
+// Options for a synthetic Environment Agency extract. The generator uses its
+// own random stream, so the same options and seed give the same file on
+// every platform and standard library.
+struct SyntheticOptions
+{
+    quint64 seed = 2024;
+    int siteCount = 0;                  // 0 picks a count that scales with the rows
+    QDate firstDay = QDate(2024, 1, 1);
+    int days = 366;                     // Sample dates fall in [firstDay, firstDay + days)
+};
+
+// Generates rows in the 17-column Environment Agency schema the pages read.
+// Samples are taken at a skewed mix of sites (a few sites are sampled far
+// more than most) and each sample reports a batch of determinands, so
+// per-sample charts and per-site trends look like the real extracts. The
+// catalogue covers every page's pollutants alongside the routine
+// chemistry that makes up most real rows, and screening samples report a
+// long tail of several thousand generated determinands, so the number of
+// distinct determinands is as large as a real extract's.
+class SyntheticCsvGenerator
+{
+public:
+    explicit SyntheticCsvGenerator(const SyntheticOptions& options = SyntheticOptions(), qint64 expectedRows = 0);
+
+    static QByteArray header();
+
+    // Append the next row, newline included
+    void appendRow(QByteArray& out);
+
+    int siteCount() const { return sites.size(); }
+
+    // Sites for a file of this many rows, roughly as dense as the 2024 extract
+    static int defaultSiteCount(qint64 rows);
+
+    // Typical length of a row, for sizing a file by bytes
+    static const int AVERAGE_ROW_BYTES = 330;
+
+    // Bumped whenever the rows generated for a seed change, so cached files are remade
+    static const int VERSION = 2;
+
+private:
+    struct Site
+    {
+        QByteArray notation;
+        QByteArray label;
+        QByteArray materialType;
+        int easting = 0;
+        int northing = 0;
+    };
+
+    quint64 next();                 // splitmix64, so the stream is portable
+    double uniform();               // [0, 1)
+    int below(int bound);           // [0, bound)
+
+    void startSample();
+
+    SyntheticOptions options;
+    quint64 state;
+    quint64 measurementId = 0;
+    QVector<Site> sites;
+
+    // Sample currently being written
+    int sampleSite = 0;
+    QByteArray sampleTime;
+    bool compliance = false;
+    QVector<int> sampleDeterminands;  // Determinand table entries still to report
+};
+
+// Write rows to a file, streaming so memory stays flat for any size
+bool writeSyntheticCsv(const QString& filePath, qint64 rows, const SyntheticOptions& options = SyntheticOptions());
+
+// Write a header and rows to an open device until either limit is reached.
+// A limit of zero or less is ignored; with neither set only the header is
+// written. progress, when set, gets the bytes written after each block.
+bool writeSyntheticCsv(QIODevice& output, qint64 rows, qint64 bytes, const SyntheticOptions& options,
+                       const std::function<void(qint64)>& progress = nullptr);
@@ -0,0 +1,152 @@
+#include "taskscheduler.hpp"
+#include "tracing.hpp"
+
+namespace {
+
+// Worker the current thread runs, so tasks that submit more work keep it local
+thread_local const TaskScheduler* currentScheduler = nullptr;
+thread_local int currentWorker = -1;
+
+// Span names for tasks run at each priority
+const char* const TASK_SPANS[] = {"TaskScheduler::interactiveTask", "TaskScheduler::ingestTask",
+                                  "TaskScheduler::backgroundTask"};
+
+}
+
+TaskScheduler::TaskScheduler(QObject* parent, int workerCount) : QObject(parent)
+{
+    const int count = qMax(1, workerCount);
+    for (int i = 0; i < count; ++i) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    for (int i = 0; i < count; ++i) {
+        workers[i]->thread = QThread::create([this, i]() { workerLoop(i); });
+        workers[i]->thread->setObjectName(QString("TaskScheduler %1").arg(i));
+        workers[i]->thread->start();
+    }
+}
+
+TaskScheduler::~TaskScheduler()
+{
+    {
+        QMutexLocker lock(&sleepMutex);
+        stopping = true;
+        wake.wakeAll();
+    }
+    for (const std::unique_ptr<Worker>& worker : workers) {
+        worker->thread->wait();
+        delete worker->thread;
+    }
+}
+
+void TaskScheduler::submit(TaskPriority priority, Task task)
+{
+    pending++;
+    const int target = currentScheduler == this ? currentWorker : int(nextWorker++ % workers.size());
+    {
+        Worker& worker = *workers[target];
+        QMutexLocker lock(&worker.mutex);
+        worker.queues[static_cast<int>(priority)].append(std::move(task));
+    }
+
+    QMutexLocker lock(&sleepMutex);
+    queued++;
+    wake.wakeOne();
+}
+
+void TaskScheduler::parallelFor(TaskPriority priority, int count, const std::function<void(int)>& body)
+{
+    if (count <= 0) {
+        return;
+    }
+
+    // Helpers that start after every index is taken return without touching body
+    struct Progress
+    {
+        std::atomic<int> next{0};
+        std::atomic<int> finished{0};
+        QMutex mutex;
+        QWaitCondition done;
+    };
+    auto progress = std::make_shared<Progress>();
+    const std::function<void(int)>* work = &body;
+
+    auto runIndices = [progress, count, work]() {
+        for (int i = progress->next++; i < count; i = progress->next++) {
+            (*work)(i);
+            if (++progress->finished == count) {
+                QMutexLocker lock(&progress->mutex);
+                progress->done.wakeAll();
+            }
+        }
+    };
+
+    const int helpers = qMin(count, workerCount()) - 1;
+    for (int i = 0; i < helpers; ++i) {
+        submit(priority, runIndices);
+    }
+    runIndices();
+
+    QMutexLocker lock(&progress->mutex);
+    while (progress->finished < count) {
+        progress->done.wait(&progress->mutex);
+    }
+}
+
+void TaskScheduler::workerLoop(int index)
+{
+    currentScheduler = this;
+    currentWorker = index;
+
+    Task task;
+    int level = 0;
+    while (!stopping) {
+        if (takeTask(index, task, level)) {
+            {
+                QMutexLocker lock(&sleepMutex);
+                queued--;
+            }
+            {
+                TraceScope trace(TASK_SPANS[level]);
+                task();
+                task = nullptr;
+            }
+            pending--;
+            continue;
+        }
+
+        // A task taken between the push and the count update can leave queued
+        // briefly negative; it settles at zero and nobody sleeps through work
+        QMutexLocker lock(&sleepMutex);
+        while (queued <= 0 && !stopping) {
+            wake.wait(&sleepMutex);
+        }
+    }
+}
+
+bool TaskScheduler::takeTask(int index, Task& task, int& level)
+{
+    const int count = workerCount();
+    for (level = 0; level < PRIORITY_COUNT; ++level) {
+        // Own newest task first, while its data is likely still in cache
+        {
+            Worker& own = *workers[index];
+            QMutexLocker lock(&own.mutex);
+            if (!own.queues[level].isEmpty()) {
+                task = own.queues[level].takeLast();
+                return true;
+            }
+        }
+
+        // Otherwise the oldest task another worker has at this priority
+        for (int offset = 1; offset < count; ++offset) {
+            Worker& victim = *workers[(index + offset) % count];
+            QMutexLocker lock(&victim.mutex);
+            if (!victim.queues[level].isEmpty()) {
+                task = victim.queues[level].takeFirst();
+                return true;
+            }
+        }
+    }
+    return false;
+}
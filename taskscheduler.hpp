@@ -0,0 +1,92 @@
+#pragma once
+
+#include <QMutex>
+#include <QObject>
+#include <QPointer>
+#include <QThread>
+#include <QWaitCondition>
+#include <QList>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Order in which queued work is taken: what the user is waiting to see,
+// then file parsing, then index builds nobody has asked for yet
+enum class TaskPriority { Interactive, Ingest, Background };
+
+// Application-wide pool with one worker thread per core, owned by Window so
+// pages, ingest and index builds share the same threads instead of each
+// starting their own. Every worker keeps a deque per priority. A worker
+// takes its own newest task first and, when that deque is empty, steals the
+// oldest task at the same priority from another worker before moving down
+// a priority. Work submitted from the GUI thread is dealt round-robin;
+// work submitted from inside a task stays on that task's worker.
+class TaskScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    using Task = std::function<void()>;
+
+    explicit TaskScheduler(QObject* parent = nullptr, int workerCount = QThread::idealThreadCount());
+    ~TaskScheduler() override; // Drops queued tasks and waits for running ones
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    void submit(TaskPriority priority, Task task);
+
+    // Compute work() on the pool and pass its result to done() on the GUI
+    // thread through a queued call. Nothing is delivered if receiver has
+    // been destroyed in the meantime. Work must only read its own captures.
+    template <typename Work, typename Done>
+    void deliver(TaskPriority priority, QObject* receiver, Work work, Done done);
+
+    // Run body(0) .. body(count - 1) across the pool and return when all
+    // have finished. The calling thread takes indices too, so this finishes
+    // even when every worker is busy with something else.
+    void parallelFor(TaskPriority priority, int count, const std::function<void(int)>& body);
+
+    int workerCount() const { return int(workers.size()); }
+
+    // Tasks submitted and not yet finished, for waiting until the pool is quiet
+    int pendingTasks() const { return pending.load(); }
+
+private:
+    static const int PRIORITY_COUNT = 3;
+
+    struct Worker
+    {
+        QMutex mutex;
+        QList<Task> queues[PRIORITY_COUNT]; // Indexed by TaskPriority
+        QThread* thread = nullptr;
+    };
+
+    void workerLoop(int index);
+    bool takeTask(int index, Task& task, int& level);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<unsigned> nextWorker{0};   // Round-robin target for outside submissions
+    std::atomic<bool> stopping{false};
+    std::atomic<int> pending{0};
+    QMutex sleepMutex;
+    QWaitCondition wake;
+    int queued = 0;                        // Tasks submitted but not yet taken, guarded by sleepMutex
+};
+
+template <typename Work, typename Done>
+void TaskScheduler::deliver(TaskPriority priority, QObject* receiver, Work work, Done done)
+{
+    QPointer<QObject> target(receiver);
+    submit(priority, [this, target, work, done]() {
+        auto result = work();
+
+        // Post through the scheduler, which outlives its workers, and only
+        // look at the receiver once back on the GUI thread
+        QMetaObject::invokeMethod(this, [target, done, result]() {
+            if (target) {
+                done(result);
+            }
+        }, Qt::QueuedConnection);
+    });
+}
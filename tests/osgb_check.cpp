@@ -0,0 +1,97 @@
+#include <QDebug>
+#include <cmath>
+#include <iterator>
+#include "osgb.hpp"
+
+// Accuracy check of the grid conversion against published Ordnance Survey
+// values, run by ctest. The two steps are checked separately:
+//
+// - The inverse projection against the worked example in the OS's "A Guide
+//   to Coordinate Systems in Great Britain", which gives E 651409.903,
+//   N 313177.270 as OSGB36 52°39'27.2531"N, 1°43'4.5177"E.
+// - The full conversion against OSTN15 test points from the OS's published
+//   OSTN15/OSGM15 test data (ETRS89 positions, taken here as WGS84). The
+//   Helmert transform does not model the OSTN15 grid shift, so these only
+//   hold to the few metres osgb.hpp promises.
+
+namespace {
+
+struct ControlPoint
+{
+    const char* name;
+    double easting;
+    double northing;
+    double latitude;
+    double longitude;
+};
+
+const double PI = 3.14159265358979323846;
+
+// Degrees, minutes and seconds as published
+constexpr double dms(double degrees, double minutes, double seconds)
+{
+    return degrees + minutes / 60 + seconds / 3600;
+}
+
+const ControlPoint PROJECTION_POINTS[] = {
+    {"OS guide worked example", 651409.903, 313177.270, dms(52, 39, 27.2531), dms(1, 43, 4.5177)},
+};
+
+const ControlPoint OSTN15_POINTS[] = {
+    {"Isles of Scilly", 91492.146, 11318.804, 49.92226393730, -6.29977752014},
+    {"Lizard", 170370.718, 11572.405, 49.96006137820, -5.20304609998},
+    {"Plymouth", 250359.811, 62016.569, 50.43885825610, -4.10864563561},
+    {"Blackpool", 331534.564, 431920.792, 53.77911025760, -3.04045490691},
+    {"Worcestershire", 389544.190, 261912.153, 52.25529381630, -2.15458614387},
+};
+
+// The projection is exact to well under a millimetre; the published
+// seconds have four decimal places, about 3 mm
+const double PROJECTION_TOLERANCE_METRES = 0.005;
+const double HELMERT_TOLERANCE_METRES = 5.0;
+
+// Ground distance between two nearby positions, on a sphere of mean radius
+double distanceMetres(double lat1, double lon1, double lat2, double lon2)
+{
+    const double radius = 6371000.0;
+    const double dLat = (lat2 - lat1) * PI / 180;
+    const double dLon = (lon2 - lon1) * PI / 180 * std::cos(lat1 * PI / 180);
+    return radius * std::sqrt(dLat * dLat + dLon * dLon);
+}
+
+template<int N>
+int check(const char* step, const ControlPoint (&points)[N], double tolerance,
+          void (*convert)(const double*, const double*, double*, double*, int))
+{
+    double eastings[N], northings[N], latitudes[N], longitudes[N];
+    for (int i = 0; i < N; ++i) {
+        eastings[i] = points[i].easting;
+        northings[i] = points[i].northing;
+    }
+
+    // One batch, as the dataset converts its sites
+    convert(eastings, northings, latitudes, longitudes, N);
+
+    int failures = 0;
+    for (int i = 0; i < N; ++i) {
+        const ControlPoint& point = points[i];
+        const double error = distanceMetres(point.latitude, point.longitude, latitudes[i], longitudes[i]);
+        if (error > tolerance) {
+            qWarning().nospace() << step << ", " << point.name << ": expected "
+                                 << qSetRealNumberPrecision(12) << point.latitude << ", "
+                                 << point.longitude << " but got " << latitudes[i] << ", "
+                                 << longitudes[i] << " (" << error << " m off)";
+            failures++;
+        }
+    }
+    return failures;
+}
+
+}
+
+int main()
+{
+    int failures = check("Projection", PROJECTION_POINTS, PROJECTION_TOLERANCE_METRES, osgbToOsgb36);
+    failures += check("OSGB36 to WGS84", OSTN15_POINTS, HELMERT_TOLERANCE_METRES, osgbToWgs84);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,102 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <cstdio>
+#include "synthetic.hpp"
+
+// Synthetic Environment Agency extracts for load and stress testing:
+//     watertool_gen --rows 150000 --seed 7 --out data/Y-2024.csv
+//     watertool_gen --size 100G --out huge.csv
+// The same options always produce the same file.
+
+namespace {
+
+// "512M", "100G" and the like, in binary units; -1 when malformed
+qint64 parseSize(QString text)
+{
+    text = text.trimmed().toUpper();
+    if (text.endsWith('B')) {
+        text.chop(1);
+    }
+
+    qint64 unit = 1;
+    const QString suffixes = "KMGT";
+    if (!text.isEmpty() && suffixes.contains(text.back())) {
+        for (int i = 0; i <= suffixes.indexOf(text.back()); ++i) {
+            unit *= 1024;
+        }
+        text.chop(1);
+    }
+
+    bool ok = false;
+    const double value = text.toDouble(&ok);
+    return ok && value > 0 ? qint64(value * unit) : -1;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Generate a synthetic water quality CSV in the Environment Agency schema");
+    parser.addHelpOption();
+    QCommandLineOption outOption("out", "Output file, or - for standard output.", "file.csv");
+    QCommandLineOption rowsOption("rows", "Number of data rows.", "count");
+    QCommandLineOption sizeOption("size", "Approximate file size, e.g. 500M or 100G.", "bytes");
+    QCommandLineOption seedOption("seed", "Random seed (default 2024).", "seed", "2024");
+    QCommandLineOption sitesOption("sites", "Number of sampling points (default scales with the rows).", "count");
+    QCommandLineOption startOption("start", "First sample date (default 2024-01-01).", "yyyy-mm-dd", "2024-01-01");
+    QCommandLineOption daysOption("days", "Days covered by the samples (default 366).", "days", "366");
+    parser.addOptions({outOption, rowsOption, sizeOption, seedOption, sitesOption, startOption, daysOption});
+    parser.process(app);
+
+    if (!parser.isSet(outOption) || (!parser.isSet(rowsOption) && !parser.isSet(sizeOption))) {
+        qWarning() << "Usage: watertool_gen --out <file.csv|-> (--rows <count> | --size <bytes>)";
+        return 1;
+    }
+
+    bool ok = true;
+    const qint64 rows = parser.isSet(rowsOption) ? parser.value(rowsOption).toLongLong(&ok) : 0;
+    const qint64 bytes = parser.isSet(sizeOption) ? parseSize(parser.value(sizeOption)) : 0;
+    if (!ok || rows < 0 || bytes < 0) {
+        qWarning() << "Invalid --rows or --size";
+        return 1;
+    }
+
+    SyntheticOptions options;
+    options.seed = parser.value(seedOption).toULongLong(&ok);
+    if (ok && parser.isSet(sitesOption)) {
+        options.siteCount = parser.value(sitesOption).toInt(&ok);
+    }
+    options.firstDay = QDate::fromString(parser.value(startOption), Qt::ISODate);
+    const int days = parser.value(daysOption).toInt();
+    if (!ok || !options.firstDay.isValid() || days <= 0) {
+        qWarning() << "Invalid --seed, --sites, --start or --days";
+        return 1;
+    }
+    options.days = days;
+
+    const QString outPath = parser.value(outOption);
+    QFile output(outPath);
+    const bool opened = outPath == "-" ? output.open(stdout, QIODevice::WriteOnly)
+                                       : output.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    if (!opened) {
+        qWarning() << "Unable to write:" << outPath;
+        return 1;
+    }
+
+    // Report every gigabyte on stderr so long runs show they are alive
+    const qint64 reportEvery = 1LL << 30;
+    qint64 nextReport = reportEvery;
+    const bool written = writeSyntheticCsv(output, rows, bytes, options, [&](qint64 done) {
+        if (done >= nextReport) {
+            std::fprintf(stderr, "%lld MB written\n", static_cast<long long>(done >> 20));
+            nextReport += reportEvery;
+        }
+    });
+
+    return written ? 0 : 1;
+}
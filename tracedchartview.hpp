@@ -0,0 +1,18 @@
+#pragma once
+
+#include <QtCharts/QChartView>
+#include "tracing.hpp"
+
+// Chart view whose repaints are timed as their own traced operation
+class TracedChartView : public QChartView
+{
+public:
+    using QChartView::QChartView;
+
+protected:
+    void paintEvent(QPaintEvent* event) override
+    {
+        TraceScope trace("QChartView::paintEvent");
+        QChartView::paintEvent(event);
+    }
+};
@@ -0,0 +1,261 @@
+#include "tracing.hpp"
+#include <QFile>
+#include <QSaveFile>
+#include <QThread>
+#include <QtDebug>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(Q_OS_MACOS)
+#include <mach/mach.h>
+#elif defined(Q_OS_UNIX)
+#include <unistd.h>
+#endif
+
+std::atomic<bool> TraceRecorder::enabled{true};
+thread_local bool TraceRecorder::guiThread = false;
+std::atomic<const char*> TraceRecorder::guiStack[TraceRecorder::MAX_GUI_DEPTH];
+std::atomic<int> TraceRecorder::guiDepth{0};
+
+namespace {
+
+// Id given to this thread by the recorder, or -1 before its first span
+thread_local int recordedThread = -1;
+
+QByteArray jsonString(const QString& text)
+{
+    QByteArray out = "\"";
+    for (char ch : text.toUtf8()) {
+        if (ch == '"' || ch == '\\') {
+            out += '\\';
+        }
+        if (static_cast<unsigned char>(ch) >= 0x20) {
+            out += ch;
+        }
+    }
+    return out + "\"";
+}
+
+}
+
+void LatencyHistogram::add(qint64 nanoseconds)
+{
+    const double micros = nanoseconds / 1000.0;
+    int bucket = 0;
+    if (micros >= 1.0) {
+        bucket = qMin(BUCKET_COUNT - 1, 1 + int(std::log2(micros) * BUCKETS_PER_DOUBLING));
+    }
+
+    buckets[bucket]++;
+    total++;
+    sumNs += nanoseconds;
+    maxNs = qMax(maxNs, nanoseconds);
+}
+
+double LatencyHistogram::percentileMs(double fraction) const
+{
+    if (total == 0) {
+        return 0.0;
+    }
+
+    // Upper edge of the bucket holding the requested rank, capped at the largest sample
+    const quint64 rank = quint64(std::ceil(fraction * total));
+    quint64 seen = 0;
+    for (int bucket = 0; bucket < BUCKET_COUNT; ++bucket) {
+        seen += buckets[bucket];
+        if (seen >= rank) {
+            const double upperMicros = std::exp2(double(bucket) / BUCKETS_PER_DOUBLING);
+            return qMin(upperMicros / 1000.0, maxMs());
+        }
+    }
+    return maxMs();
+}
+
+TraceRecorder& TraceRecorder::instance()
+{
+    static TraceRecorder recorder;
+    return recorder;
+}
+
+qint64 TraceRecorder::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void TraceRecorder::markGuiThread()
+{
+    guiThread = true;
+}
+
+void TraceRecorder::enterGuiOperation(const char* name)
+{
+    // Only the GUI thread writes, so plain load-then-store is enough
+    const int depth = guiDepth.load(std::memory_order_relaxed);
+    if (depth < MAX_GUI_DEPTH) {
+        guiStack[depth].store(name, std::memory_order_relaxed);
+    }
+    guiDepth.store(depth + 1, std::memory_order_release);
+}
+
+void TraceRecorder::leaveGuiOperation()
+{
+    guiDepth.store(guiDepth.load(std::memory_order_relaxed) - 1, std::memory_order_release);
+}
+
+QStringList TraceRecorder::guiOperations()
+{
+    // A scope may open or close while this runs; the snapshot is only a sample
+    QStringList operations;
+    const int depth = qMin(guiDepth.load(std::memory_order_acquire), int(MAX_GUI_DEPTH));
+    for (int i = 0; i < depth; ++i) {
+        if (const char* name = guiStack[i].load(std::memory_order_relaxed)) {
+            operations.append(QString::fromLatin1(name));
+        }
+    }
+    return operations;
+}
+
+void TraceRecorder::record(const char* name, qint64 startNs, qint64 durationNs, const AllocationCount& allocated)
+{
+    QMutexLocker lock(&mutex);
+    OperationTotals& totals = histograms[QByteArray::fromRawData(name, qsizetype(std::strlen(name)))];
+    totals.latency.add(durationNs);
+    totals.allocations += allocated.allocations;
+    totals.allocatedBytes += allocated.bytes;
+
+    if (capturing) {
+        if (spans.size() < MAX_CAPTURED_SPANS) {
+            spans.append({name, startNs, durationNs, threadId()});
+        } else {
+            droppedSpans++;
+        }
+    }
+}
+
+int TraceRecorder::threadId()
+{
+    // Called with the mutex held
+    if (recordedThread < 0) {
+        recordedThread = threadNames.size();
+        const QString name = QThread::currentThread()->objectName();
+        threadNames.append(name.isEmpty() ? QString("Thread %1").arg(recordedThread) : name);
+    }
+    return recordedThread;
+}
+
+void TraceRecorder::startCapture()
+{
+    QMutexLocker lock(&mutex);
+    capturing = true;
+    spans.clear();
+    droppedSpans = 0;
+    captureStartNs = now();
+    lock.unlock();
+
+    setEnabled(true);
+}
+
+bool TraceRecorder::writeCapture(const QString& filePath) const
+{
+    QSaveFile output(filePath);
+    if (!output.open(QIODevice::WriteOnly)) {
+        qWarning() << "Unable to write trace:" << filePath;
+        return false;
+    }
+
+    QMutexLocker lock(&mutex);
+    if (droppedSpans > 0) {
+        qWarning() << "Trace capture was full;" << droppedSpans << "spans were not kept";
+    }
+
+    // Complete ("X") events in microseconds, after one name record per thread
+    output.write("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    for (int thread = 0; thread < threadNames.size(); ++thread) {
+        output.write((thread > 0 ? ",\n" : "") + QByteArray("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":")
+                     + QByteArray::number(thread) + ",\"args\":{\"name\":" + jsonString(threadNames[thread]) + "}}");
+    }
+    for (const Span& span : spans) {
+        output.write(",\n{\"name\":\"" + QByteArray(span.name) + "\",\"cat\":\"watertool\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+                     + QByteArray::number(span.thread)
+                     + ",\"ts\":" + QByteArray::number((span.startNs - captureStartNs) / 1000.0, 'f', 3)
+                     + ",\"dur\":" + QByteArray::number(span.durationNs / 1000.0, 'f', 3) + "}");
+    }
+    output.write("\n]}\n");
+    lock.unlock();
+
+    if (!output.commit()) {
+        qWarning() << "Unable to write trace:" << filePath;
+        return false;
+    }
+    return true;
+}
+
+QVector<OperationStats> TraceRecorder::operations() const
+{
+    QVector<OperationStats> result;
+
+    QMutexLocker lock(&mutex);
+    for (auto it = histograms.begin(); it != histograms.end(); ++it) {
+        OperationStats stats;
+        stats.name = QString::fromUtf8(it.key());
+        const OperationTotals& totals = it.value();
+        stats.count = totals.latency.count();
+        stats.p50 = totals.latency.percentileMs(0.50);
+        stats.p95 = totals.latency.percentileMs(0.95);
+        stats.p99 = totals.latency.percentileMs(0.99);
+        stats.max = totals.latency.maxMs();
+        if (stats.count > 0) {
+            stats.allocationsPerCall = double(totals.allocations) / stats.count;
+            stats.bytesPerCall = double(totals.allocatedBytes) / stats.count;
+        }
+        result.append(stats);
+    }
+    lock.unlock();
+
+    std::sort(result.begin(), result.end(), [](const OperationStats& a, const OperationStats& b) {
+        return a.name < b.name;
+    });
+    return result;
+}
+
+void TraceRecorder::reset()
+{
+    QMutexLocker lock(&mutex);
+    histograms.clear();
+}
+
+qint64 processResidentBytes()
+{
+#if defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return qint64(counters.WorkingSetSize);
+    }
+    return -1;
+#elif defined(Q_OS_MACOS)
+    mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) == KERN_SUCCESS) {
+        return qint64(info.resident_size);
+    }
+    return -1;
+#elif defined(Q_OS_UNIX)
+    // Second field of statm is resident pages
+    QFile statm("/proc/self/statm");
+    if (!statm.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+    const QList<QByteArray> fields = statm.readAll().split(' ');
+    bool ok = false;
+    const qint64 pages = fields.size() > 1 ? fields[1].toLongLong(&ok) : 0;
+    return ok ? pages * sysconf(_SC_PAGESIZE) : -1;
+#else
+    return -1;
+#endif
+}
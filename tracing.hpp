@@ -0,0 +1,164 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <atomic>
+#include "allocations.hpp"
+
+// Latency histogram with eight buckets per doubling from 1 µs, so a
+// percentile is reported within about 9% of its true value
+class LatencyHistogram
+{
+public:
+    void add(qint64 nanoseconds);
+
+    quint64 count() const { return total; }
+    double percentileMs(double fraction) const;
+    double meanMs() const { return total > 0 ? sumNs / total / 1e6 : 0.0; }
+    double maxMs() const { return maxNs / 1e6; }
+
+private:
+    static const int BUCKETS_PER_DOUBLING = 8;
+    static const int BUCKET_COUNT = BUCKETS_PER_DOUBLING * 32; // Up to about 70 minutes
+
+    quint64 buckets[BUCKET_COUNT] = {};
+    quint64 total = 0;
+    double sumNs = 0.0;
+    qint64 maxNs = 0;
+};
+
+// Summary of one named operation, for display
+struct OperationStats
+{
+    QString name;
+    quint64 count = 0;
+    double p50 = 0.0;   // Milliseconds
+    double p95 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+    double allocationsPerCall = 0.0;  // Heap allocations on the scope's thread; zero
+    double bytesPerCall = 0.0;        // unless allocation tracking is built in
+};
+
+// Process-wide collector behind TraceScope. Every finished span is folded
+// into its operation's histogram. While a capture is running each span is
+// also kept with its thread, to be written out as a Chrome trace.
+class TraceRecorder
+{
+public:
+    static TraceRecorder& instance();
+
+    // A relaxed load, so disabled scopes cost one branch
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+    static void setEnabled(bool on) { enabled.store(on, std::memory_order_relaxed); }
+
+    // Monotonic clock in nanoseconds
+    static qint64 now();
+
+    // Make the calling thread the one whose open scopes guiOperations()
+    // reports. Open scopes on other threads are not tracked.
+    static void markGuiThread();
+    static bool isGuiThread() { return guiThread; }
+
+    // Scopes open on the GUI thread, outermost first; readable from any thread
+    static QStringList guiOperations();
+    static void enterGuiOperation(const char* name);
+    static void leaveGuiOperation();
+
+    // name must be a string literal; it is used as the key without copying
+    void record(const char* name, qint64 startNs, qint64 durationNs, const AllocationCount& allocated = {});
+
+    QVector<OperationStats> operations() const;
+    void reset();
+
+    // Keep every span from now on, and turn recording on
+    void startCapture();
+
+    // Write the captured spans in Chrome Trace Event format, for
+    // chrome://tracing or Perfetto
+    bool writeCapture(const QString& filePath) const;
+
+private:
+    TraceRecorder() = default;
+
+    struct OperationTotals
+    {
+        LatencyHistogram latency;
+        quint64 allocations = 0;
+        quint64 allocatedBytes = 0;
+    };
+
+    struct Span
+    {
+        const char* name;
+        qint64 startNs;
+        qint64 durationNs;
+        int thread;
+    };
+
+    // Small stable id for the calling thread, named on first use
+    int threadId();
+
+    static std::atomic<bool> enabled;
+
+    // GUI thread scope stack, written by that thread and sampled by others
+    static const int MAX_GUI_DEPTH = 32;
+    static thread_local bool guiThread;
+    static std::atomic<const char*> guiStack[MAX_GUI_DEPTH];
+    static std::atomic<int> guiDepth;
+
+    // Bounds a forgotten capture to a few hundred megabytes
+    static const int MAX_CAPTURED_SPANS = 10000000;
+
+    mutable QMutex mutex;
+    QHash<QByteArray, OperationTotals> histograms;
+    bool capturing = false;
+    QVector<Span> spans;
+    QVector<QString> threadNames;  // Indexed by thread id
+    qint64 captureStartNs = 0;
+    quint64 droppedSpans = 0;
+};
+
+// Times the enclosing block as one span of the named operation
+class TraceScope
+{
+public:
+    explicit TraceScope(const char* name)
+        : name(TraceRecorder::isEnabled() ? name : nullptr), start(this->name ? TraceRecorder::now() : 0)
+    {
+        if (this->name) {
+            allocatedAtStart = threadAllocations();
+            if (TraceRecorder::isGuiThread()) {
+                TraceRecorder::enterGuiOperation(this->name);
+            }
+        }
+    }
+
+    ~TraceScope()
+    {
+        if (name) {
+            if (TraceRecorder::isGuiThread()) {
+                TraceRecorder::leaveGuiOperation();
+            }
+            const AllocationCount allocated = threadAllocations();
+            TraceRecorder::instance().record(name, start, TraceRecorder::now() - start,
+                                             {allocated.allocations - allocatedAtStart.allocations,
+                                              allocated.bytes - allocatedAtStart.bytes});
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name;  // Null when recording was off as the scope opened
+    qint64 start;
+    AllocationCount allocatedAtStart;
+};
+
+// Resident set size of this process in bytes, or -1 where unsupported
+qint64 processResidentBytes();
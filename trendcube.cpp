@@ -0,0 +1,123 @@
+#include "trendcube.hpp"
+#include <algorithm>
+#include <utility>
+
+void TrendBucket::merge(const TrendBucket& other)
+{
+    if (other.valueCount > 0) {
+        if (valueCount == 0) {
+            min = other.min;
+            max = other.max;
+        } else {
+            min = qMin(min, other.min);
+            max = qMax(max, other.max);
+        }
+    }
+    count += other.count;
+    valueCount += other.valueCount;
+    exceedances += other.exceedances;
+    sum += other.sum;
+}
+
+void TrendCube::clear()
+{
+    cells.clear();
+    unsorted.clear();
+}
+
+void TrendCube::add(int determinand, int site, const QDate& day, bool numeric, double value, bool exceedance)
+{
+    TrendBucket sample;
+    sample.start = day;
+    sample.count = 1;
+    sample.exceedances = exceedance ? 1 : 0;
+    if (numeric) {
+        sample.valueCount = 1;
+        sample.sum = value;
+        sample.min = value;
+        sample.max = value;
+    }
+
+    // Rows for one site usually arrive grouped by date, so most samples merge into the last cell
+    const quint64 cell = key(determinand, site);
+    QVector<TrendBucket>& series = cells[cell];
+    if (!series.isEmpty() && series.last().start == day) {
+        series.last().merge(sample);
+    } else {
+        if (!series.isEmpty() && day < series.last().start) {
+            unsorted.insert(cell);
+        }
+        series.append(sample);
+    }
+}
+
+void TrendCube::finalize()
+{
+    for (quint64 cell : std::as_const(unsorted)) {
+        QVector<TrendBucket>& series = cells[cell];
+        std::stable_sort(series.begin(), series.end(), [](const TrendBucket& a, const TrendBucket& b) {
+            return a.start < b.start;
+        });
+
+        // Merge cells for days that arrived out of order
+        int last = 0;
+        for (int i = 1; i < series.size(); ++i) {
+            if (series[i].start == series[last].start) {
+                series[last].merge(series[i]);
+            } else {
+                series[++last] = series[i];
+            }
+        }
+        series.resize(series.isEmpty() ? 0 : last + 1);
+    }
+    unsorted.clear();
+}
+
+void TrendCube::squeeze()
+{
+    for (auto it = cells.begin(); it != cells.end(); ++it) {
+        it.value().squeeze();
+    }
+}
+
+QVector<TrendBucket> TrendCube::series(int determinand, int site, TimeGranularity granularity) const
+{
+    const QVector<TrendBucket> days = cells.value(key(determinand, site));
+    if (granularity == TimeGranularity::Day) {
+        return days;
+    }
+
+    QVector<TrendBucket> rolledUp;
+    for (const TrendBucket& day : days) {
+        const QDate start = bucketStart(day.start, granularity);
+        if (rolledUp.isEmpty() || rolledUp.last().start != start) {
+            TrendBucket bucket;
+            bucket.start = start;
+            rolledUp.append(bucket);
+        }
+        rolledUp.last().merge(day);
+    }
+    return rolledUp;
+}
+
+QDate TrendCube::bucketStart(const QDate& day, TimeGranularity granularity)
+{
+    switch (granularity) {
+    case TimeGranularity::Day:
+        return day;
+    case TimeGranularity::Week:
+        return day.addDays(1 - day.dayOfWeek()); // Weeks start on Monday
+    case TimeGranularity::Month:
+        return QDate(day.year(), day.month(), 1);
+    }
+    return day;
+}
+
+int TrendCube::cellCount() const
+{
+    int total = 0;
+    for (const QVector<TrendBucket>& series : cells) {
+        total += series.size();
+    }
+    return total;
+}
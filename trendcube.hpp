@@ -0,0 +1,63 @@
+#pragma once
+
+#include <QDate>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+
+// Resolution of a trend series
+enum class TimeGranularity {
+    Day,
+    Week,
+    Month
+};
+
+// Statistics for one time bucket of a trend series
+struct TrendBucket
+{
+    QDate start;              // First day covered by the bucket
+    quint32 count = 0;        // Samples in the bucket
+    quint32 valueCount = 0;   // ...with a numeric result
+    quint32 exceedances = 0;  // ...over their category's threshold
+    double sum = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+
+    double mean() const { return valueCount > 0 ? sum / valueCount : 0.0; }
+    void merge(const TrendBucket& other);
+};
+
+// Daily aggregation cube keyed by (determinand, sampling point, day), built
+// once at ingest. Trend charts roll the day cells up to weeks or months on
+// request, so a series costs O(day buckets) instead of a scan of raw rows.
+// Every sample is also added under ALL_SITES for per-determinand totals.
+class TrendCube
+{
+public:
+    static const int ALL_SITES = -1;
+
+    void clear();
+    void add(int determinand, int site, const QDate& day, bool numeric, double value, bool exceedance);
+
+    // Sort and merge the cells given a day out of order since the last
+    // finalize; cells whose days arrived in order are left untouched, so
+    // finalizing after an append costs only the cells it disturbed
+    void finalize();
+
+    // Release spare capacity of every cell, once a build is complete
+    void squeeze();
+
+    QVector<TrendBucket> series(int determinand, int site, TimeGranularity granularity) const;
+    static QDate bucketStart(const QDate& day, TimeGranularity granularity);
+
+    int cellCount() const;
+
+private:
+    static quint64 key(int determinand, int site)
+    {
+        return (quint64(quint32(determinand)) << 32) | quint32(site);
+    }
+
+    QHash<quint64, QVector<TrendBucket>> cells; // Day buckets per (determinand, site)
+    QSet<quint64> unsorted;                     // Cells with a day before their last one
+};
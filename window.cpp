@@ -2,12 +2,41 @@
 #include <stdexcept>
 #include <iostream>
 #include "window.hpp"
+#include "statsdialog.hpp"
+#include "interaction.hpp"
+#include "tracing.hpp"
+#include "decompression.hpp"
 
 static const int MIN_WIDTH = 620;
 
+// Files larger than this are summarised in one streaming pass instead of being loaded
+static const qint64 AGGREGATION_THRESHOLD = 1024LL * 1024 * 1024;
 
-Window::Window(): QMainWindow(), statsDialog(nullptr)
+// Typical shrinkage of a compressed CSV, for judging its size against the threshold
+static const qint64 COMPRESSION_RATIO = 10;
+
+// Quiet time after a change to a followed file before its new rows are read
+static const int FOLLOW_DELAY_MS = 250;
+
+
+Window::Window(): QMainWindow(), statsDialog(nullptr), recorder(nullptr), aggregationMode(false), datasetGeneration(0),
+    popsPage(nullptr), fluorinatedPage(nullptr), pollutantOverviewPage(nullptr),
+    litterIndicatorsPage(nullptr), complianceDashboardPage(nullptr), mapPage(nullptr)
 {
+    stallWatchdog = new StallWatchdog(this);
+    stallWatchdog->start();
+
+    taskScheduler = new TaskScheduler(this);
+    indexScheduler = new IndexScheduler(dataset, *taskScheduler, this);
+    connect(indexScheduler, &IndexScheduler::indexReady, this, &Window::datasetIndexReady);
+
+    fileWatcher = new QFileSystemWatcher(this);
+    followTimer = new QTimer(this);
+    followTimer->setSingleShot(true);
+    followTimer->setInterval(FOLLOW_DELAY_MS);
+    connect(fileWatcher, &QFileSystemWatcher::fileChanged, followTimer, qOverload<>(&QTimer::start));
+    connect(followTimer, &QTimer::timeout, this, &Window::followFile);
+
     createMainWidget();
     createStatusBar();
 
@@ -22,68 +51,418 @@ void Window::createMainWidget()
     // Initialize QStackedWidget
     pages = new QStackedWidget(this);
 
-    // Create and add the Dashboard page
+    // Create and add the Dashboard page; every other page is built lazily
     dashboard = new Dashboard();
 
     // Connect Dashboard buttons to navigate to respective pages
     connect(dashboard, &Dashboard::navigateToPollutantOverview, [this]() {
-        pages->setCurrentIndex(1); // Switch to Pollutant Overview page
+        showPage(PageId::PollutantOverview);
     });
     connect(dashboard, &Dashboard::navigateToPOPs, [this]() {
-        pages->setCurrentIndex(2); // Switch to POPs page
+        showPage(PageId::POPs);
     });
     connect(dashboard, &Dashboard::navigateToEnvironmentalLitter, [this]() {
-        pages->setCurrentIndex(3); // Switch to Environmental Litter Indicators page
+        showPage(PageId::EnvironmentalLitter);
     });
     connect(dashboard, &Dashboard::navigateToFluorinatedPage, [this]() {
-        pages->setCurrentIndex(4); // Switch to Fluorinated Compounds page
+        showPage(PageId::Fluorinated);
     });
     connect(dashboard, &Dashboard::navigateToComplianceDashboard, [this]() {
-        pages->setCurrentIndex(5); // Switch to Compliance Dashboard
+        showPage(PageId::ComplianceDashboard);
     });
+    connect(dashboard, &Dashboard::navigateToSamplingMap, [this]() {
+        showPage(PageId::SamplingMap);
+    });
+    connect(dashboard, &Dashboard::csvFileLoaded, this, &Window::csvFileLoaded);
     pages->addWidget(dashboard);
 
-    // Pollutant Overview page
-    pollutantOverviewPage = new PollutantOverviewPage();
-    connect(pollutantOverviewPage, &PollutantOverviewPage::navigateToDashboard, [this]() {
-        pages->setCurrentIndex(0); // Switch back to Dashboard
-    });
-    connect(dashboard, &Dashboard::csvFileLoaded, pollutantOverviewPage, &PollutantOverviewPage::loadCsvFile);
-    pages->addWidget(pollutantOverviewPage);
+    setCentralWidget(pages);
+}
 
-    // POPs page
-    popsPage = new POPsPage();
-    connect(popsPage, &POPsPage::navigateToDashboard, [this]() {
-        pages->setCurrentIndex(0); // Switch back to Dashboard
-    });
-    connect(dashboard, &Dashboard::csvFileLoaded, popsPage, &POPsPage::loadCsvFile);
-    pages->addWidget(popsPage);
+void Window::openFile(const QString& filePath)
+{
+    csvFileLoaded(filePath);
+    updateStatusBarFile(filePath);
+}
 
-    // Environmental Litter Indicators page
-    litterIndicatorsPage = new EnvironmentalLitterIndicatorsPage();
-    connect(litterIndicatorsPage, &EnvironmentalLitterIndicatorsPage::navigateToDashboard, [this]() {
-        pages->setCurrentIndex(0); // Switch back to Dashboard
-    });
-    connect(dashboard, &Dashboard::csvFileLoaded, litterIndicatorsPage, &EnvironmentalLitterIndicatorsPage::loadCsvFile);
-    pages->addWidget(litterIndicatorsPage);
+bool Window::openPage(const QString& pageKey)
+{
+    if (pageKey == "Dashboard") {
+        showDashboard();
+        return true;
+    }
 
-    // Fluorinated Compounds page
-    fluorinatedPage = new FluorinatedPage();
-    connect(fluorinatedPage, &FluorinatedPage::navigateToDashboard, [this]() {
-        pages->setCurrentIndex(0); // Switch back to Dashboard
-    });
-    connect(dashboard, &Dashboard::csvFileLoaded, fluorinatedPage, &FluorinatedPage::loadCsvFile);
-    pages->addWidget(fluorinatedPage);
+    bool ok = false;
+    const int id = QMetaEnum::fromType<PageId>().keyToValue(pageKey.toLatin1().constData(), &ok);
+    if (ok) {
+        showPage(static_cast<PageId>(id));
+    }
+    return ok;
+}
 
-    // Compliance Dashboard page
-    complianceDashboardPage = new ComplianceDashboardPage();
-    connect(complianceDashboardPage, &ComplianceDashboardPage::navigateToDashboard, [this]() {
-        pages->setCurrentIndex(0); // Switch back to Dashboard
-    });
-    connect(dashboard, &Dashboard::csvFileLoaded, complianceDashboardPage, &ComplianceDashboardPage::loadCsvFile);
-    pages->addWidget(complianceDashboardPage);
+QString Window::currentPageKey() const
+{
+    if (pages->currentWidget() == dashboard) {
+        return "Dashboard";
+    }
+    return pageKey(createdPages.key(pages->currentWidget()));
+}
 
-    setCentralWidget(pages);
+void Window::startRecording()
+{
+    if (recorder) {
+        return;
+    }
+    recorder = new InteractionRecorder(this);
+    for (auto it = createdPages.begin(); it != createdPages.end(); ++it) {
+        recorder->watchPage(it.value(), pageKey(it.key()));
+    }
+}
+
+void Window::showDashboard()
+{
+    pages->setCurrentWidget(dashboard);
+    if (recorder) {
+        recorder->recordNavigate("Dashboard");
+    }
+}
+
+void Window::csvFileLoaded(const QString& filePath)
+{
+    TraceScope trace("Window::csvFileLoaded");
+
+    if (recorder) {
+        recorder->recordLoad(filePath);
+    }
+
+    // Parse the file once; pages pick the new data up when they are next shown
+    const qint64 ratio = compressionOf(filePath) == Compression::None ? 1 : COMPRESSION_RATIO;
+    aggregationMode = QFileInfo(filePath).size() * ratio > AGGREGATION_THRESHOLD;
+    if (aggregationMode) {
+        dataset.clear();
+        aggregates.build(filePath);
+    } else {
+        aggregates.clear();
+        if (dataset.load(filePath, taskScheduler)) {
+            indexScheduler->start();
+        }
+    }
+    // Figures of the previous file are replaced now, even if only by zeros
+    // until the new file's summaries are ready
+    updateDashboardCompliance();
+    updateDashboardSites();
+    datasetGeneration++;
+    if (followButton->isChecked()) {
+        watchFile(filePath);
+    }
+
+    if (pages->currentWidget() != dashboard) {
+        refreshPage(createdPages.key(pages->currentWidget()));
+    }
+}
+
+void Window::toggleFollow(bool follow)
+{
+    if (!follow) {
+        followTimer->stop();
+        watchFile(QString());
+        return;
+    }
+
+    // Rows written since the file was loaded are read straight away
+    const QString filePath = aggregationMode ? aggregates.filePath() : dataset.filePath();
+    watchFile(filePath);
+    if (!filePath.isEmpty()) {
+        followFile();
+    }
+}
+
+void Window::watchFile(const QString& filePath)
+{
+    if (!fileWatcher->files().isEmpty()) {
+        fileWatcher->removePaths(fileWatcher->files());
+    }
+    if (!filePath.isEmpty()) {
+        fileWatcher->addPath(filePath);
+    }
+}
+
+void Window::followFile()
+{
+    TraceScope trace("Window::followFile");
+
+    const QString filePath = aggregationMode ? aggregates.filePath() : dataset.filePath();
+    if (filePath.isEmpty()) {
+        return;
+    }
+    // Writers that save by replacing the file drop it from the watcher
+    if (!fileWatcher->files().contains(filePath) && QFileInfo::exists(filePath)) {
+        fileWatcher->addPath(filePath);
+    }
+
+    // A file that shrank was rewritten rather than appended to, so it is loaded afresh
+    if (aggregationMode) {
+        const qint64 added = aggregates.extend();
+        if (added < 0) {
+            csvFileLoaded(filePath);
+        } else if (added > 0) {
+            // Monthly buckets change in place, so pages showing them reload
+            updateDashboardCompliance();
+            datasetGeneration++;
+            if (pages->currentWidget() != dashboard) {
+                refreshPage(createdPages.key(pages->currentWidget()));
+            }
+        }
+        return;
+    }
+
+    const int firstRow = dataset.records().size();
+    const int added = dataset.appendNewRows(taskScheduler);
+    if (added < 0) {
+        csvFileLoaded(filePath);
+        return;
+    }
+    if (added == 0) {
+        return;
+    }
+
+    // Index builds still running were dropped by the append; start them over every row
+    if (!dataset.hasSummaries()) {
+        indexScheduler->start();
+    } else if (!dataset.hasSpatialIndex()) {
+        indexScheduler->updateSpatial();
+    }
+    updateDashboardCompliance();
+    updateDashboardSites();
+
+    // Pages showing the rows before the append take just the new ones; the
+    // rest reload in full when they are next shown
+    const int previousGeneration = datasetGeneration++;
+    for (auto it = createdPages.begin(); it != createdPages.end(); ++it) {
+        if (pageGenerations.value(it.key()) != previousGeneration) {
+            continue;
+        }
+        switch (it.key()) {
+        case PageId::PollutantOverview:
+            pollutantOverviewPage->appendDataset(dataset, firstRow);
+            break;
+        case PageId::POPs:
+            popsPage->appendDataset(dataset, firstRow);
+            break;
+        case PageId::Fluorinated:
+            fluorinatedPage->appendDataset(dataset, firstRow);
+            break;
+        default:
+            continue;
+        }
+        pageGenerations.insert(it.key(), datasetGeneration);
+    }
+
+    if (pages->currentWidget() != dashboard) {
+        refreshPage(createdPages.key(pages->currentWidget()));
+    }
+}
+
+void Window::showPage(PageId id)
+{
+    QWidget* page = createdPages.value(id);
+    if (!page) {
+        page = createPage(id);
+        createdPages.insert(id, page);
+        pageGenerations.insert(id, 0);
+        pages->addWidget(page);
+        if (recorder) {
+            recorder->watchPage(page, pageKey(id));
+        }
+    }
+
+    refreshPage(id);
+    pages->setCurrentWidget(page);
+    if (recorder) {
+        recorder->recordNavigate(pageKey(id));
+    }
+
+    // No modal notice in headless replays, where nobody could dismiss it
+    if (aggregationMode && QGuiApplication::platformName() != "offscreen"
+        && (id == PageId::PollutantOverview || id == PageId::EnvironmentalLitter || id == PageId::SamplingMap)) {
+        QMessageBox::information(this, "Aggregation Mode",
+            "This file was too large to load in full and has only been summarised by month. "
+            "This page needs individual samples, so it is empty for this file.");
+    }
+}
+
+QWidget* Window::createPage(PageId id)
+{
+    auto backToDashboard = [this]() {
+        showDashboard(); // Switch back to Dashboard
+    };
+
+    switch (id) {
+    case PageId::PollutantOverview:
+        pollutantOverviewPage = new PollutantOverviewPage(taskScheduler);
+        connect(pollutantOverviewPage, &PollutantOverviewPage::navigateToDashboard, backToDashboard);
+        return pollutantOverviewPage;
+    case PageId::POPs:
+        popsPage = new POPsPage(taskScheduler);
+        connect(popsPage, &POPsPage::navigateToDashboard, backToDashboard);
+        return popsPage;
+    case PageId::EnvironmentalLitter:
+        litterIndicatorsPage = new EnvironmentalLitterIndicatorsPage();
+        connect(litterIndicatorsPage, &EnvironmentalLitterIndicatorsPage::navigateToDashboard, backToDashboard);
+        return litterIndicatorsPage;
+    case PageId::Fluorinated:
+        fluorinatedPage = new FluorinatedPage(taskScheduler);
+        connect(fluorinatedPage, &FluorinatedPage::navigateToDashboard, backToDashboard);
+        return fluorinatedPage;
+    case PageId::ComplianceDashboard:
+        complianceDashboardPage = new ComplianceDashboardPage();
+        connect(complianceDashboardPage, &ComplianceDashboardPage::navigateToDashboard, backToDashboard);
+        return complianceDashboardPage;
+    case PageId::SamplingMap:
+        mapPage = new MapPage();
+        connect(mapPage, &MapPage::navigateToDashboard, backToDashboard);
+        return mapPage;
+    }
+
+    return nullptr;
+}
+
+void Window::refreshPage(PageId id)
+{
+    // Only materialise the page's view when it is behind the loaded dataset
+    if (pageGenerations.value(id) == datasetGeneration) {
+        return;
+    }
+    pageGenerations.insert(id, datasetGeneration);
+
+    TraceScope trace("Window::refreshPage");
+    const qint64 residentBefore = processResidentBytes();
+
+    // In aggregation mode the dataset is empty and pages that can use monthly
+    // summaries are fed from those instead
+    switch (id) {
+    case PageId::PollutantOverview:
+        pollutantOverviewPage->loadDataset(dataset);
+        break;
+    case PageId::POPs:
+        if (aggregationMode)
+            popsPage->loadAggregates(aggregates);
+        else
+            popsPage->loadDataset(dataset);
+        break;
+    case PageId::EnvironmentalLitter:
+        litterIndicatorsPage->loadDataset(dataset);
+        break;
+    case PageId::Fluorinated:
+        if (aggregationMode)
+            fluorinatedPage->loadAggregates(aggregates);
+        else
+            fluorinatedPage->loadDataset(dataset);
+        break;
+    case PageId::ComplianceDashboard:
+        if (aggregationMode)
+            complianceDashboardPage->loadAggregates(aggregates);
+        else
+            complianceDashboardPage->loadDataset(dataset);
+        break;
+    case PageId::SamplingMap:
+        mapPage->loadDataset(dataset);
+        break;
+    }
+
+    // Growth in resident memory approximates what the page's model holds
+    const qint64 residentAfter = processResidentBytes();
+    if (residentBefore >= 0 && residentAfter >= 0) {
+        pageMemory.insert(pageTitle(id), qMax<qint64>(0, residentAfter - residentBefore));
+        if (statsDialog) {
+            statsDialog->setPageMemory(pageMemory);
+        }
+    }
+}
+
+QString Window::pageKey(PageId id)
+{
+    return QString::fromLatin1(QMetaEnum::fromType<PageId>().valueToKey(static_cast<int>(id)));
+}
+
+QString Window::pageTitle(PageId id)
+{
+    switch (id) {
+    case PageId::PollutantOverview:
+        return "Pollutant Overview";
+    case PageId::POPs:
+        return "Persistent Organic Pollutants";
+    case PageId::EnvironmentalLitter:
+        return "Environmental Litter Indicators";
+    case PageId::Fluorinated:
+        return "Fluorinated Compounds";
+    case PageId::ComplianceDashboard:
+        return "Compliance Dashboard";
+    case PageId::SamplingMap:
+        return "Sampling Point Map";
+    }
+
+    return QString();
+}
+
+void Window::updateDashboardCompliance()
+{
+    // Card order: Pollutant Overview, POPs, Litter, Fluorinated, Compliance
+    QList<QPair<qint64, qint64>> counts;
+    for (PollutantCategory category : {PollutantCategory::PollutantOverview, PollutantCategory::POPs,
+                                       PollutantCategory::EnvironmentalLitter, PollutantCategory::Fluorinated}) {
+        qint64 compliant = 0;
+        qint64 total = 0;
+        if (aggregationMode) {
+            aggregates.categoryCompliance(category, &compliant, &total);
+        } else {
+            dataset.categoryCompliance(category, &compliant, &total);
+        }
+        counts.append({compliant, total});
+    }
+
+    qint64 compliant = 0;
+    qint64 total = 0;
+    if (aggregationMode) {
+        aggregates.flagCompliance(&compliant, &total);
+    } else {
+        dataset.flagCompliance(&compliant, &total);
+    }
+    counts.append({compliant, total});
+
+    dashboard->setComplianceCounts(counts);
+
+    // Monthly pages of a file that overflowed the aggregation table miss some rows
+    const qint64 dropped = aggregationMode ? aggregates.droppedRows() : 0;
+    droppedInfo->setText(QString("%1 rows not summarised: too many site, determinand and month combinations").arg(dropped));
+    droppedInfo->setVisible(dropped > 0);
+}
+
+void Window::updateDashboardSites()
+{
+    // Sites with no exceedance in any category count as compliant, once
+    // the summaries have counted them
+    qint64 compliant = 0;
+    for (const SamplingPoint& site : dataset.samplingPoints()) {
+        if (dataset.hasSummaries() && site.exceedances == 0) {
+            compliant++;
+        }
+    }
+    dashboard->setSiteCounts(compliant, dataset.samplingPoints().size());
+}
+
+void Window::datasetIndexReady(IndexScheduler::Stage stage)
+{
+    // Pages query the other indexes when they next draw; only the site
+    // counts and an already loaded map are refreshed here
+    if (stage == IndexScheduler::Stage::Summaries) {
+        updateDashboardCompliance();
+        updateDashboardSites();
+    }
+    const bool mapStage = stage == IndexScheduler::Stage::Summaries || stage == IndexScheduler::Stage::Spatial;
+    if (mapStage && mapPage && pageGenerations.value(PageId::SamplingMap) == datasetGeneration) {
+        mapPage->loadDataset(dataset);
+    }
 }
 
 void Window::createStatusBar()
@@ -96,10 +475,48 @@ void Window::createStatusBar()
     QStatusBar* status = statusBar();
     status->addWidget(fileInfo);
 
+    // Shown only when an aggregated file had more buckets than the table holds
+    droppedInfo = new QLabel();
+    droppedInfo->setStyleSheet("color: #B00020;");
+    droppedInfo->hide();
+    status->addWidget(droppedInfo);
+
+    // Timings and memory overlay, built the first time it is opened
+    statsButton = new QPushButton("Performance Stats");
+    statsButton->setCheckable(true);
+    connect(statsButton, &QPushButton::toggled, this, &Window::toggleStats);
+    status->addPermanentWidget(statsButton);
+
+    // Keep reading rows appended to the loaded file, e.g. by a field team's logger
+    followButton = new QPushButton("Follow File");
+    followButton->setCheckable(true);
+    connect(followButton, &QPushButton::toggled, this, &Window::toggleFollow);
+    status->addPermanentWidget(followButton);
+
     // Connect the Dashboard's csvFileLoaded signal to dynamically update the status bar
     connect(dashboard, &Dashboard::csvFileLoaded, this, &Window::updateStatusBarFile);
 }
 
+void Window::toggleStats(bool show)
+{
+    if (!show) {
+        if (statsDialog) {
+            statsDialog->hide();
+        }
+        return;
+    }
+
+    if (!statsDialog) {
+        statsDialog = new StatsDialog(stallWatchdog, this);
+        connect(statsDialog, &QDialog::finished, this, [this]() {
+            statsButton->setChecked(false);
+        });
+    }
+    statsDialog->setPageMemory(pageMemory);
+    statsDialog->show();
+    statsDialog->raise();
+}
+
 void Window::updateStatusBarFile(const QString& filePath)
 {
     currentFileName = filePath; // Update the internal file name
@@ -2,19 +2,29 @@
 
 #include <QMainWindow>
 #include <QStackedWidget>
+#include <QMap>
+#include "dataset.hpp"
+#include "aggregates.hpp"
 #include "dashboard.hpp"
 #include "pops.hpp"
 #include "fluorinated.hpp"
 #include "pollutantOverview.hpp"
 #include "envlitter.hpp"
 #include "compliance.hpp"
+#include "mappage.hpp"
+#include "taskscheduler.hpp"
+#include "indexscheduler.hpp"
+#include "stallwatchdog.hpp"
 
 class QString;
 class QComboBox;
+class QFileSystemWatcher;
 class QLabel;
 class QPushButton;
 class QTableView;
+class QTimer;
 class StatsDialog;
+class InteractionRecorder;
 
 class Window : public QMainWindow
 {
@@ -23,25 +33,79 @@ class Window : public QMainWindow
 public:
     Window();
 
+    // Entry points for scripted runs, matching what the dashboard buttons do.
+    // Page keys are the PageId names, plus "Dashboard".
+    void openFile(const QString& filePath);
+    bool openPage(const QString& pageKey);
+    QWidget* currentPage() const { return pages->currentWidget(); }
+    QString currentPageKey() const;
+
+    // Whether background tasks started by the last action are still running
+    bool isBusy() const { return taskScheduler->pendingTasks() > 0; }
+
+    // Record the user's actions from now on, for saving as a replay script
+    void startRecording();
+    const InteractionRecorder* interactionRecorder() const { return recorder; }
+
 private:
+    // Pages reachable from the dashboard, created on first navigation
+    enum class PageId {
+        PollutantOverview,
+        POPs,
+        EnvironmentalLitter,
+        Fluorinated,
+        ComplianceDashboard,
+        SamplingMap
+    };
+    Q_ENUM(PageId)
+
     void createMainWidget();
     void createStatusBar();
 
     void csvFileLoaded(const QString& filePath);
+    void showPage(PageId id);
+    QWidget* createPage(PageId id);
+    void refreshPage(PageId id);
+    void updateDashboardCompliance();
+    void updateDashboardSites();
+    void datasetIndexReady(IndexScheduler::Stage stage);
+    void toggleStats(bool show);
+    void toggleFollow(bool follow);
+    void watchFile(const QString& filePath);
+    void followFile();
+    void showDashboard();
+    static QString pageTitle(PageId id);
+    static QString pageKey(PageId id);
 
     QString currentFileName;   // Name of the current file
     QPushButton* loadButton;   // Button to load a new CSV file
     QPushButton* statsButton;  // Button to display dataset stats
+    QPushButton* followButton; // Button to keep reading rows appended to the file
+    QFileSystemWatcher* fileWatcher; // Watches the loaded file while following it
+    QTimer* followTimer;       // Gathers a burst of writes into one read
     QTableView* table;         // Table of quake data
     QLabel* fileInfo;          // Status bar info on current file
+    QLabel* droppedInfo;       // Status bar warning of rows the aggregation table had no room for
     StatsDialog* statsDialog;  // Dialog to display stats
+    StallWatchdog* stallWatchdog; // Times the GUI event loop and names what blocked it
+    InteractionRecorder* recorder; // Set while recording a replay script
     QStackedWidget* pages;     // Stacked widget for multiple pages
     Dashboard* dashboard;      // Dashboard page
+    TaskScheduler* taskScheduler; // Worker threads shared by ingest, indexing and charts
+    WaterDataset dataset;      // CSV parsed once and shared by all pages
+    IndexScheduler* indexScheduler; // Builds the dataset's trend and spatial indexes after load
+    AggregationIndex aggregates; // Monthly summaries for files too large to load
+    bool aggregationMode;      // Whether the current file was only aggregated
+    int datasetGeneration;     // Incremented every time a new file is parsed
+    QMap<PageId, QWidget*> createdPages;   // Pages built so far
+    QMap<PageId, int> pageGenerations;     // Dataset generation each page last loaded
+    QMap<QString, qint64> pageMemory;      // Resident memory each page's last load added
     POPsPage* popsPage;        // POPs page
     FluorinatedPage* fluorinatedPage; // Fluorinated Compounds page
     PollutantOverviewPage* pollutantOverviewPage; // Pollutant Overview page
     EnvironmentalLitterIndicatorsPage* litterIndicatorsPage; // Environmental Litter Indicators page
     ComplianceDashboardPage* complianceDashboardPage; // Compliance Dashboard page
+    MapPage* mapPage;          // Sampling Point Map page
 
 private slots:
     void updateStatusBarFile(const QString& filePath);